@@ -90,6 +90,19 @@ void analogWriteFreq(uint32_t freq);
 void analogWriteRange(uint32_t range);
 void analogWriteResolution(int res);
 
+// PSRAM heap (RP2350 boards with PSRAM), return NULL when there is no PSRAM or it is full.
+// pfree() and prealloc() also accept normal heap pointers, so they can release anything
+// bufmalloc() returns.
+void *pmalloc(size_t size);
+void *pcalloc(size_t count, size_t size);
+void *prealloc(void *ptr, size_t size);
+void pfree(void *ptr);
+// Allocation for large, not performance critical buffers.  Placed in PSRAM or SRAM depending
+// on rp2040.setPSRAMPolicy(), always falling back to the normal heap.  Free with pfree().
+// PSRAM can't be accessed while flash is erased or programmed, so buffers that must keep
+// being used by DMA or IRQs during flash writes should not be placed there.
+void *bufmalloc(size_t size);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -128,6 +141,11 @@ extern const String emptyString;
 #include "SerialPIO.h"
 #include "Bootsel.h"
 
+// Lowest overhead GPIO interrupt, called straight from the GPIO IRQ with the pin, the
+// GPIO_IRQ_xxx events that fired, and time_us_32() as of entering the IRQ.
+typedef void (*gpioIRQRawFuncPtr)(pin_size_t pin, uint32_t events, uint32_t us, void *param);
+void attachInterruptRaw(pin_size_t pin, gpioIRQRawFuncPtr callback, PinStatus mode, void *param = nullptr);
+
 // Template which will evaluate at *compile time* to a single 32b number
 // with the specified bits set.
 template <size_t N>
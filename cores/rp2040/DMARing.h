@@ -0,0 +1,88 @@
+/*
+    DMARing - Reader side of a free-running DMA from a FIFO into a ring buffer
+
+    Copyright (c) 2024 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+// The channel is set up by the owner with channel_config_set_ring() over a
+// power-of-2 sized and aligned buffer of 32-bit words, and started for
+// DMARing::COUNT transfers.  No IRQ is used: whenever the reader polls, the
+// hardware transfer count says how far the DMA has got, and a finished run is
+// restarted then (new words wait in the peripheral FIFO meanwhile).
+
+#include <stdint.h>
+#include <hardware/dma.h>
+
+class DMARing {
+public:
+    // RP2350 keeps a mode in the top 4 bits of the DMA count, so stay below it on both chips
+    static const uint32_t COUNT = 0x0fffffff;
+
+    void begin(int dma, uint32_t *buf, uint32_t words) {
+        _dma = dma;
+        _buf = buf;
+        _mask = words - 1;
+        _armed = 0;
+        _rd = 0;
+    }
+
+    // Total words DMA'd into the ring since begin()
+    uint64_t written() {
+        uint32_t left = dma_channel_hw_addr(_dma)->transfer_count & COUNT;
+        if (!left && !dma_channel_is_busy(_dma)) {
+            _armed += COUNT;
+            dma_channel_set_trans_count(_dma, COUNT, true);
+            left = COUNT;
+        }
+        return _armed + (COUNT - left);
+    }
+
+    // Unread words.  If the DMA has lapped the reader, the oldest ones are dropped
+    // leaving half a ring to read, and *lapped is set.
+    uint32_t available(bool *lapped) {
+        uint64_t w = written();
+        *lapped = w - _rd > _mask;
+        if (*lapped) {
+            _rd = w - (_mask + 1) / 2;
+        }
+        return w - _rd;
+    }
+
+    // Only valid when available() is nonzero
+    uint32_t pop() {
+        return _buf[_rd++ & _mask];
+    }
+
+    // Word number n since begin(), valid for the last ring size worth of written()
+    uint32_t at(uint64_t n) const {
+        return _buf[n & _mask];
+    }
+
+    // Words consumed by pop() so far
+    uint64_t consumed() const {
+        return _rd;
+    }
+
+private:
+    int _dma = -1;
+    uint32_t *_buf = nullptr;
+    uint32_t _mask = 0;
+    uint64_t _armed = 0; // Words written by earlier DMA runs
+    uint64_t _rd = 0;
+};
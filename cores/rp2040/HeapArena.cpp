@@ -0,0 +1,214 @@
+/*
+    HeapArena - Coalescing allocator over a caller supplied block of memory
+
+    Copyright (c) 2024 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "HeapArena.h"
+#include <string.h>
+
+// Boundary-tag allocator: each block records its own size and the size of the
+// block before it, so a free can merge with both neighbors in constant time.
+// Free blocks sit in power-of-two size bins.  A request is satisfied from its
+// own bin (first fit) or from the first block of any larger non-empty bin,
+// which is always big enough, found with a single bitmap scan.
+
+void HeapArena::begin(void *mem, size_t size) {
+    // Keep 8-byte alignment for both the start and every block size
+    uintptr_t s = ((uintptr_t)mem + 7) & ~(uintptr_t)7;
+    uintptr_t e = ((uintptr_t)mem + size) & ~(uintptr_t)7;
+    memset(_free, 0, sizeof(_free));
+    _binMap = 0;
+    _used = 0;
+    if ((e <= s) || (e - s < _minBlock) || (e - s > 0x80000000)) {
+        _start = _end = nullptr;
+        return;
+    }
+    _start = (uint8_t *)s;
+    _end = (uint8_t *)e;
+    Block *b = (Block *)_start;
+    b->prevSize = 0;
+    b->size = e - s;
+    _link(b);
+}
+
+void HeapArena::_link(Block *b) {
+    int bin = _bin(_blockSize(b));
+    b->prev = nullptr;
+    b->next = _free[bin];
+    if (b->next) {
+        b->next->prev = b;
+    }
+    _free[bin] = b;
+    _binMap |= 1UL << bin;
+}
+
+void HeapArena::_unlink(Block *b) {
+    int bin = _bin(_blockSize(b));
+    if (b->prev) {
+        b->prev->next = b->next;
+    } else {
+        _free[bin] = b->next;
+    }
+    if (b->next) {
+        b->next->prev = b->prev;
+    }
+    if (!_free[bin]) {
+        _binMap &= ~(1UL << bin);
+    }
+}
+
+// Trim the in-use block b to size, returning any usable tail to the free lists
+void HeapArena::_split(Block *b, uint32_t size) {
+    uint32_t total = _blockSize(b);
+    if (total - size < _minBlock) {
+        return;
+    }
+    b->size = size | _inUseBit;
+    Block *tail = (Block *)((uint8_t *)b + size);
+    tail->prevSize = size;
+    tail->size = total - size;
+    Block *n = _nextPhys(tail);
+    if (n) {
+        n->prevSize = tail->size;
+    }
+    _used -= tail->size;
+    _link(_merge(tail));
+}
+
+// Combine the not-yet-linked free block b with any free neighbors
+HeapArena::Block *HeapArena::_merge(Block *b) {
+    Block *n = _nextPhys(b);
+    if (n && !_inUse(n)) {
+        _unlink(n);
+        b->size += n->size;
+    }
+    Block *p = _prevPhys(b);
+    if (p && !_inUse(p)) {
+        _unlink(p);
+        p->size += b->size;
+        b = p;
+    }
+    n = _nextPhys(b);
+    if (n) {
+        n->prevSize = b->size;
+    }
+    return b;
+}
+
+void *HeapArena::alloc(size_t size) {
+    if (!_start || (size > totalBytes())) {
+        return nullptr;
+    }
+    uint32_t need = ((size + 7) & ~7) + _header;
+    if (need < _minBlock) {
+        need = _minBlock;
+    }
+    int bin = _bin(need);
+    Block *b = nullptr;
+    for (Block *f = _free[bin]; f; f = f->next) {
+        if (_blockSize(f) >= need) {
+            b = f;
+            break;
+        }
+    }
+    if (!b) {
+        uint32_t larger = (bin < _bins - 1) ? _binMap & ~((2UL << bin) - 1) : 0;
+        if (!larger) {
+            return nullptr;
+        }
+        b = _free[__builtin_ctz(larger)];
+    }
+    _unlink(b);
+    b->size |= _inUseBit;
+    _used += _blockSize(b);
+    _split(b, need);
+    return (uint8_t *)b + _header;
+}
+
+void HeapArena::free(void *ptr) {
+    if (!ptr || !owns(ptr)) {
+        return;
+    }
+    Block *b = (Block *)((uint8_t *)ptr - _header);
+    if (!_inUse(b)) {
+        return; // Double free, ignore
+    }
+    b->size &= ~_inUseBit;
+    _used -= b->size;
+    _link(_merge(b));
+}
+
+void *HeapArena::realloc(void *ptr, size_t size) {
+    if (!ptr) {
+        return alloc(size);
+    }
+    if (!size) {
+        free(ptr);
+        return nullptr;
+    }
+    if (!owns(ptr) || (size > totalBytes())) {
+        return nullptr;
+    }
+    Block *b = (Block *)((uint8_t *)ptr - _header);
+    uint32_t need = ((size + 7) & ~7) + _header;
+    if (need < _minBlock) {
+        need = _minBlock;
+    }
+    // Grow into a free successor if possible, else shrink in place
+    Block *n = _nextPhys(b);
+    if ((_blockSize(b) < need) && n && !_inUse(n) && (_blockSize(b) + _blockSize(n) >= need)) {
+        _unlink(n);
+        _used += n->size;
+        b->size += n->size;
+        n = _nextPhys(b);
+        if (n) {
+            n->prevSize = _blockSize(b);
+        }
+    }
+    if (_blockSize(b) >= need) {
+        _split(b, need);
+        return ptr;
+    }
+    void *p = alloc(size);
+    if (p) {
+        memcpy(p, ptr, _blockSize(b) - _header);
+        free(ptr);
+    }
+    return p;
+}
+
+size_t HeapArena::usableSize(const void *ptr) const {
+    if (!owns(ptr)) {
+        return 0;
+    }
+    const Block *b = (const Block *)((const uint8_t *)ptr - _header);
+    return _blockSize(b) - _header;
+}
+
+size_t HeapArena::largestFree() const {
+    if (!_binMap) {
+        return 0;
+    }
+    uint32_t best = 0;
+    for (const Block *f = _free[31 - __builtin_clz(_binMap)]; f; f = f->next) {
+        if (_blockSize(f) > best) {
+            best = _blockSize(f);
+        }
+    }
+    return best - _header;
+}
@@ -0,0 +1,95 @@
+/*
+    HeapArena - Coalescing allocator over a caller supplied block of memory
+
+    Copyright (c) 2024 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+// Only uses the C library so it can be built and exercised on a host PC
+// against a plain malloc()-ed block.  No locking, callers must serialize.
+
+#include <stddef.h>
+#include <stdint.h>
+
+class HeapArena {
+public:
+    HeapArena() { }
+
+    // Takes over [mem, mem + size).  Any previous allocations are forgotten.
+    void begin(void *mem, size_t size);
+
+    void *alloc(size_t size);
+    void *realloc(void *ptr, size_t size);
+    void free(void *ptr);
+
+    bool owns(const void *ptr) const {
+        return _start && ((const uint8_t *)ptr >= _start) && ((const uint8_t *)ptr < _end);
+    }
+    size_t usableSize(const void *ptr) const;
+
+    size_t totalBytes() const {
+        return _end - _start;
+    }
+    size_t usedBytes() const {
+        return _used;
+    }
+    size_t freeBytes() const {
+        return totalBytes() - _used;
+    }
+    size_t largestFree() const;
+
+private:
+    // Every block starts with this header, and free blocks also hold their list links
+    typedef struct Block {
+        uint32_t prevSize; // Size of the physically preceding block, 0 for the first
+        uint32_t size;     // Including this header, bit 0 set when in use
+        struct Block *next;
+        struct Block *prev;
+    } Block;
+    static constexpr uint32_t _inUseBit = 1;
+    static constexpr uint32_t _header = 8; // prevSize + size, the links overlap the payload
+    static constexpr uint32_t _minBlock = sizeof(Block);
+    static constexpr int _bins = 32; // Free lists by floor(log2(block size))
+
+    static uint32_t _blockSize(const Block *b) {
+        return b->size & ~_inUseBit;
+    }
+    static bool _inUse(const Block *b) {
+        return b->size & _inUseBit;
+    }
+    static int _bin(uint32_t size) {
+        return 31 - __builtin_clz(size);
+    }
+    Block *_nextPhys(Block *b) const {
+        uint8_t *n = (uint8_t *)b + _blockSize(b);
+        return (n < _end) ? (Block *)n : nullptr;
+    }
+    Block *_prevPhys(Block *b) const {
+        return b->prevSize ? (Block *)((uint8_t *)b - b->prevSize) : nullptr;
+    }
+    void _link(Block *b);
+    void _unlink(Block *b);
+    void _split(Block *b, uint32_t size);
+    Block *_merge(Block *b);
+
+    uint8_t *_start = nullptr;
+    uint8_t *_end = nullptr;
+    size_t _used = 0;
+    uint32_t _binMap = 0; // Bit n set when _free[n] is not empty
+    Block *_free[_bins] = { };
+};
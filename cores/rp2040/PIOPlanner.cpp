@@ -0,0 +1,151 @@
+/*
+    PIO instruction memory and state machine placement planner
+
+    Copyright (c) 2024 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "PIOPlanner.h"
+
+int PIOPlanner::largestGap(uint32_t used) {
+    int best = 0;
+    int run = 0;
+    for (int i = 0; i < instructions; i++) {
+        if (used & (1u << i)) {
+            run = 0;
+        } else if (++run > best) {
+            best = run;
+        }
+    }
+    return best;
+}
+
+// Size of the free run that would hold [offset, offset+length)
+int PIOPlanner::_gapAround(uint32_t used, int offset, int length) {
+    int lo = offset;
+    while ((lo > 0) && !(used & (1u << (lo - 1)))) {
+        lo--;
+    }
+    int hi = offset + length;
+    while ((hi < instructions) && !(used & (1u << hi))) {
+        hi++;
+    }
+    return hi - lo;
+}
+
+int PIOPlanner::find(const void *pgm, int pio) const {
+    for (const auto &l : _loaded) {
+        if (l.refs && (l.pgm == pgm) && (l.pio == pio)) {
+            return l.offset;
+        }
+    }
+    return -1;
+}
+
+int PIOPlanner::users(const void *pgm, int pio) const {
+    for (const auto &l : _loaded) {
+        if (l.refs && (l.pgm == pgm) && (l.pio == pio)) {
+            return l.refs;
+        }
+    }
+    return 0;
+}
+
+bool PIOPlanner::plan(const void *pgm, int length, int origin, int pios, const uint32_t usedInsn[], const uint8_t freeSM[], Placement *out) const {
+    if ((length <= 0) || (length > instructions) || (pios > maxPIOs)) {
+        return false;
+    }
+
+    // Sharing an already loaded copy costs no instruction memory at all
+    int bestPIO = -1;
+    for (int p = 0; p < pios; p++) {
+        int off = find(pgm, p);
+        if ((off >= 0) && freeSM[p] && ((bestPIO < 0) || (_popcount(freeSM[p]) > _popcount(freeSM[bestPIO])))) {
+            bestPIO = p;
+            out->offset = off;
+        }
+    }
+    if (bestPIO >= 0) {
+        out->pio = bestPIO;
+        out->load = false;
+        return true;
+    }
+
+    // Otherwise best fit: the tightest free run that holds the program, so big
+    // runs stay available for big programs.  Ties go to the PIO with the most
+    // free SMs, then to the highest offset like the SDK does.
+    int bestGap = instructions + 1;
+    int bestSMs = -1;
+    for (int p = 0; p < pios; p++) {
+        if (!freeSM[p]) {
+            continue;
+        }
+        int sms = _popcount(freeSM[p]);
+        for (int off = instructions - length; off >= 0; off--) {
+            if ((origin >= 0) && (off != origin)) {
+                continue;
+            }
+            if (usedInsn[p] & _mask(length, off)) {
+                continue;
+            }
+            int gap = _gapAround(usedInsn[p], off, length);
+            if ((gap < bestGap) || ((gap == bestGap) && (sms > bestSMs))) {
+                bestGap = gap;
+                bestSMs = sms;
+                bestPIO = p;
+                // Hug the top of the run, leaving one contiguous hole below
+                out->offset = off;
+            }
+        }
+    }
+    if (bestPIO < 0) {
+        return false;
+    }
+    out->pio = bestPIO;
+    out->load = true;
+    return true;
+}
+
+bool PIOPlanner::acquire(const void *pgm, int pio, int offset, int length) {
+    Loaded *empty = nullptr;
+    for (auto &l : _loaded) {
+        if (l.refs && (l.pgm == pgm) && (l.pio == pio)) {
+            l.refs++;
+            return true;
+        } else if (!l.refs && !empty) {
+            empty = &l;
+        }
+    }
+    if (!empty) {
+        return false;
+    }
+    empty->pgm = pgm;
+    empty->pio = pio;
+    empty->offset = offset;
+    empty->length = length;
+    empty->refs = 1;
+    return true;
+}
+
+bool PIOPlanner::release(const void *pgm, int pio, int *offset) {
+    for (auto &l : _loaded) {
+        if (l.refs && (l.pgm == pgm) && (l.pio == pio)) {
+            *offset = l.offset;
+            return !--l.refs;
+        }
+    }
+    return false;
+}
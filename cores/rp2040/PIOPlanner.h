@@ -0,0 +1,77 @@
+/*
+    PIO instruction memory and state machine placement planner
+
+    Copyright (c) 2024 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+// Pure bookkeeping with no hardware access, so the placement rules can be
+// exercised on a host PC.  PIOProgram feeds it the live instruction and SM
+// usage from the SDK and applies its decisions.
+
+#include <stdint.h>
+
+class PIOPlanner {
+public:
+    static constexpr int maxPIOs = 3;
+    static constexpr int instructions = 32;
+    static constexpr int stateMachines = 4;
+    static constexpr int maxLoaded = 24;
+
+    // Where a program should run, and whether it must be loaded there first
+    typedef struct {
+        int pio;
+        int offset;
+        bool load;
+    } Placement;
+
+    // usedInsn[p] has bit n set when instruction n of PIO p is taken, by us or
+    // anyone else.  freeSM[p] has bit n set when SM n of PIO p is unclaimed.
+    bool plan(const void *pgm, int length, int origin, int pios, const uint32_t usedInsn[], const uint8_t freeSM[], Placement *out) const;
+
+    // Record a load or another user of an already loaded program
+    bool acquire(const void *pgm, int pio, int offset, int length);
+    // Drop one user.  Returns true, with the offset, when this was the last one
+    // and the instructions can be removed.
+    bool release(const void *pgm, int pio, int *offset);
+
+    // Offset of the program in the given PIO, or -1 if not loaded there
+    int find(const void *pgm, int pio) const;
+    int users(const void *pgm, int pio) const;
+
+    // Largest run of 0 bits in a used-instruction mask
+    static int largestGap(uint32_t used);
+
+private:
+    typedef struct {
+        const void *pgm;
+        int8_t pio;
+        int8_t offset;
+        int8_t length;
+        uint8_t refs;
+    } Loaded;
+    Loaded _loaded[maxLoaded] = { };
+
+    static int _popcount(uint32_t v) {
+        return __builtin_popcount(v);
+    }
+    static uint32_t _mask(int length, int offset) {
+        return ((length >= 32) ? 0xffffffff : ((1u << length) - 1)) << offset;
+    }
+    static int _gapAround(uint32_t used, int offset, int length);
+};
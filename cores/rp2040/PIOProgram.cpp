@@ -20,12 +20,44 @@
 
 #include <Arduino.h>
 #include "PIOProgram.h"
-#include <map>
+#include "PIOPlanner.h"
 #include <hardware/platform_defs.h>
 
-static std::map<const pio_program_t *, int> __pioMap[NUM_PIOS];
+static PIOPlanner _planner;
 auto_init_mutex(_pioMutex);
 
+static PIO _pioN(int n) {
+    PIO pi[NUM_PIOS] = { pio0, pio1
+#if defined(PICO_RP2350)
+    ,pio2
+#endif
+    };
+    return pi[n];
+}
+
+// The SDK doesn't expose its instruction allocation, so probe it one word at a time.
+// This also sees programs loaded directly with the SDK, outside of PIOProgram.
+static uint32_t _usedInsn(PIO pio) {
+    static const uint16_t nop = 0xa042;
+    static const pio_program_t one = { .instructions = &nop, .length = 1, .origin = -1 };
+    uint32_t used = 0;
+    for (int i = 0; i < PIOPlanner::instructions; i++) {
+        if (!pio_can_add_program_at_offset(pio, &one, i)) {
+            used |= 1u << i;
+        }
+    }
+    return used;
+}
+
+static uint8_t _freeSM(PIO pio) {
+    uint8_t avail = 0;
+    for (int i = 0; i < PIOPlanner::stateMachines; i++) {
+        if (!pio_sm_is_claimed(pio, i)) {
+            avail |= 1 << i;
+        }
+    }
+    return avail;
+}
 
 PIOProgram::PIOProgram(const pio_program_t *pgm) {
     _pgm = pgm;
@@ -33,55 +65,90 @@ PIOProgram::PIOProgram(const pio_program_t *pgm) {
     _sm = -1;
 }
 
-// We leave the INSN loaded in INSN RAM
 PIOProgram::~PIOProgram() {
     if (_pio) {
-        pio_sm_unclaim(_pio, _sm);
+        unprepare(_pio, _sm);
     }
 }
 
 // Possibly load into a PIO and allocate a SM
 bool PIOProgram::prepare(PIO *pio, int *sm, int *offset) {
     CoreMutex m(&_pioMutex);
-    PIO pi[NUM_PIOS] = { pio0, pio1
-#if defined(PICO_RP2350)
-    ,pio2
-#endif
-    };
+    uint32_t used[NUM_PIOS];
+    uint8_t avail[NUM_PIOS];
+    for (int o = 0; o < NUM_PIOS; o++) {
+        used[o] = _usedInsn(_pioN(o));
+        avail[o] = _freeSM(_pioN(o));
+    }
+
+    PIOPlanner::Placement p;
+    if (!_planner.plan(_pgm, _pgm->length, _pgm->origin, NUM_PIOS, used, avail, &p)) {
+        // Nope, no room either for SMs or INSNs
+        return false;
+    }
+    PIO pi = _pioN(p.pio);
+    int idx = pio_claim_unused_sm(pi, false);
+    if (idx < 0) {
+        return false;
+    }
+    if (p.load && (pio_add_program_at_offset(pi, _pgm, p.offset) < 0)) {
+        pio_sm_unclaim(pi, idx);
+        return false;
+    }
+    if (!_planner.acquire(_pgm, p.pio, p.offset, _pgm->length)) {
+        if (p.load) {
+            pio_remove_program(pi, _pgm, p.offset);
+        }
+        pio_sm_unclaim(pi, idx);
+        return false;
+    }
+    _pio = pi;
+    _sm = idx;
+    *pio = pi;
+    *sm = idx;
+    *offset = p.offset;
+    return true;
+}
 
-    // If it's already loaded into PIO IRAM, try and allocate in that specific PIO
+void PIOProgram::unprepare(PIO pio, int sm) {
+    CoreMutex m(&_pioMutex);
+    pio_sm_unclaim(pio, sm);
+    int off;
+    if (_planner.release(_pgm, pio_get_index(pio), &off)) {
+        pio_remove_program(pio, _pgm, off);
+    }
+    if ((_pio == pio) && (_sm == sm)) {
+        _pio = nullptr;
+        _sm = -1;
+    }
+}
+
+int PIOProgram::freeStateMachines(int pio) {
+    CoreMutex m(&_pioMutex);
+    int cnt = 0;
     for (int o = 0; o < NUM_PIOS; o++) {
-        auto p = __pioMap[o].find(_pgm);
-        if (p != __pioMap[o].end()) {
-            int idx = pio_claim_unused_sm(pi[o], false);
-            if (idx >= 0) {
-                _pio = pi[o];
-                _sm = idx;
-                *pio = pi[o];
-                *sm = idx;
-                *offset = p->second;
-                return true;
-            }
+        if ((pio < 0) || (pio == o)) {
+            cnt += __builtin_popcount(_freeSM(_pioN(o)));
         }
     }
+    return cnt;
+}
 
-    // Not in any PIO IRAM, so try and add
+int PIOProgram::freeInstructions(int pio) {
+    CoreMutex m(&_pioMutex);
+    int cnt = 0;
     for (int o = 0; o < NUM_PIOS; o++) {
-        if (pio_can_add_program(pi[o], _pgm)) {
-            int idx = pio_claim_unused_sm(pi[o], false);
-            if (idx >= 0) {
-                int off = pio_add_program(pi[o], _pgm);
-                __pioMap[o].insert({_pgm, off});
-                _pio = pi[o];
-                _sm = idx;
-                *pio = pi[o];
-                *sm = idx;
-                *offset = off;
-                return true;
-            }
+        if ((pio < 0) || (pio == o)) {
+            cnt += PIOPlanner::instructions - __builtin_popcount(_usedInsn(_pioN(o)));
         }
     }
+    return cnt;
+}
 
-    // Nope, no room either for SMs or INSNs
-    return false;
+int PIOProgram::largestFreeBlock(int pio) {
+    if ((pio < 0) || (pio >= NUM_PIOS)) {
+        return 0;
+    }
+    CoreMutex m(&_pioMutex);
+    return PIOPlanner::largestGap(_usedInsn(_pioN(pio)));
 }
@@ -22,13 +22,23 @@
 
 #include <hardware/pio.h>
 
-// Wrapper class for PIO programs, abstracting common operations out
+// Wrapper class for PIO programs, abstracting common operations out.  Loaded
+// programs are shared and refcounted across all users, and their instruction
+// memory is freed when the last SM running them is given back with unprepare().
 class PIOProgram {
 public:
     PIOProgram(const pio_program_t *pgm);
     ~PIOProgram();
     // Possibly load into a PIO and allocate a SM
     bool prepare(PIO *pio, int *sm, int *offset);
+    // Unclaim the SM (which should be stopped) and unload the program if no one else uses it
+    void unprepare(PIO pio, int sm);
+
+    // Resource queries, over all PIOs when pio < 0
+    static int freeStateMachines(int pio = -1);
+    static int freeInstructions(int pio = -1);
+    // Largest program which could still be loaded into the given PIO
+    static int largestFreeBlock(int pio);
 
 private:
     const pio_program_t *_pgm;
@@ -20,6 +20,8 @@
 
 #include <Arduino.h>
 #include <hardware/structs/psm.h>
+#include <hardware/flash.h>
+#include <pico/mutex.h>
 
 extern "C" void boot_double_tap_check();
 
@@ -31,3 +33,92 @@ void RP2040::enableDoubleResetBootloader() {
         boot_double_tap_check();
     }
 }
+
+// Called from the multicore FIFO IRQ, which can't see rp2040 from the header
+extern "C" void __not_in_flash_func(__multicoreChannelIRQ)() {
+    rp2040.channel._dispatch();
+}
+
+// Flash operations.  Only one core may drive the flash at a time, and unless the
+// other core has promised to stay out of XIP it needs to be parked in RAM while
+// we do.  Each sector erase is its own critical section, and programs do as many
+// pages as fit in FLASH_PROGRAM_BUDGET_US before letting everything run again.
+#ifndef FLASH_PROGRAM_BUDGET_US
+#define FLASH_PROGRAM_BUDGET_US 1000
+#endif
+static volatile bool __flashSafeCore[2] = { false, false };
+static FlashStats __flashStats;
+auto_init_mutex(__flashMutex);
+
+// Erases one sector, or programs at least one page, and returns the bytes done
+static size_t __flashOp(uint32_t offset, const uint8_t *data, size_t count) {
+    bool park = __isFreeRTOS || !__flashSafeCore[get_core_num() ^ 1];
+    size_t done = 0;
+    uint32_t ops = 0;
+    mutex_enter_blocking(&__flashMutex);
+    uint32_t start = time_us_32();
+    noInterrupts();
+    if (park) {
+        rp2040.idleOtherCore();
+    }
+    if (data) {
+        // flash_range_program() restores XIP before returning, so this loop may run from flash.
+        // Assume the next page takes as long as the last one did.
+        uint32_t now = start;
+        uint32_t page = 0;
+        do {
+            flash_range_program(offset + done, data + done, FLASH_PAGE_SIZE);
+            done += FLASH_PAGE_SIZE;
+            ops++;
+            uint32_t last = now;
+            now = time_us_32();
+            page = now - last;
+        } while ((done < count) && (now - start + page <= FLASH_PROGRAM_BUDGET_US));
+    } else {
+        flash_range_erase(offset, count);
+        done = count;
+        ops = 1;
+    }
+    if (park) {
+        rp2040.resumeOtherCore();
+    }
+    interrupts();
+    uint32_t stall = time_us_32() - start;
+    __flashStats.ops += ops;
+    __flashStats.lastUs = stall;
+    __flashStats.totalUs += stall;
+    if (stall > __flashStats.maxUs) {
+        __flashStats.maxUs = stall;
+    }
+    mutex_exit(&__flashMutex);
+    return done;
+}
+
+void RP2040::flashErase(uint32_t offset, size_t count) {
+    for (size_t i = 0; i < count; i += FLASH_SECTOR_SIZE) {
+        __flashOp(offset + i, nullptr, FLASH_SECTOR_SIZE);
+    }
+}
+
+void RP2040::flashProgram(uint32_t offset, const uint8_t *data, size_t count) {
+    if ((offset % FLASH_PAGE_SIZE) || (count % FLASH_PAGE_SIZE)) {
+        DEBUGCORE("ERROR: flashProgram needs whole pages (offset %lu, count %u)\n", offset, count);
+        return;
+    }
+    while (count) {
+        size_t done = __flashOp(offset, data, count);
+        offset += done;
+        data += done;
+        count -= done;
+    }
+}
+
+void RP2040::setFlashSafeCore(bool safe) {
+    __flashSafeCore[get_core_num()] = safe;
+}
+
+void RP2040::getFlashStats(FlashStats *stats) {
+    mutex_enter_blocking(&__flashMutex);
+    *stats = __flashStats;
+    mutex_exit(&__flashMutex);
+}
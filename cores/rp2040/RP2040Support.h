@@ -40,6 +40,142 @@
 #include "_freertos.h"
 
 extern "C" volatile bool __otherCoreIdled;
+extern "C" void __multicoreChannelIRQ();
+
+// Zero-copy message passing between cores.  Only a pointer and length are
+// queued, through a lock-free single-producer/single-consumer ring for each
+// direction, so the message memory must stay valid until the receiver is done.
+class _MChannel {
+public:
+    _MChannel() { /* noop */ };
+    ~_MChannel() { /* noop */ };
+
+    typedef void (*MessageCB)(void *msg, size_t len);
+
+    void begin(int cores) {
+        // FreeRTOS tasks can move between cores, so get_core_num() can't pick the ring
+        _multicore = (cores > 1) && !__isFreeRTOS;
+        for (int i = 0; i < 2; i++) {
+            _ring[i].head = 0;
+            _ring[i].tail = 0;
+            _cb[i] = nullptr;
+            _pending[i] = false;
+        }
+    }
+
+    bool send_nb(void *msg, size_t len) {
+        if (!_multicore) {
+            return false;
+        }
+        // Send to the other core's ring
+        int dest = get_core_num() ^ 1;
+        Ring *r = &_ring[dest];
+        uint32_t t = r->tail;
+        uint32_t next = (t + 1) & (ENTRIES - 1);
+        if (next == r->head) {
+            return false;
+        }
+        r->msg[t] = msg;
+        r->len[t] = len;
+        __dmb(); // Entry must be visible before the new tail
+        r->tail = next;
+        __dmb();
+        if (_cb[dest] && !_pending[dest]) {
+            // Kick the other core's FIFO IRQ to run its callback
+            _pending[dest] = true;
+            multicore_fifo_push_blocking(MSGREADY);
+        }
+        return true;
+    }
+
+    void send(void *msg, size_t len) {
+        if (!_multicore) {
+            return;
+        }
+        while (!send_nb(msg, len)) { /* noop */ }
+    }
+
+    // Fails while an onReceive() callback is set on this core, since the ring
+    // only supports the one consumer
+    bool receive_nb(void **msg, size_t *len = nullptr) {
+        int core = get_core_num();
+        if (!_multicore || _cb[core]) {
+            return false;
+        }
+        return _pop(core, msg, len);
+    }
+
+    // Returns nullptr immediately if receive_nb() can never succeed
+    void *receive(size_t *len = nullptr) {
+        void *msg;
+        if (!_multicore || _cb[get_core_num()]) {
+            return nullptr;
+        }
+        while (!receive_nb(&msg, len)) { /* noop */ }
+        return msg;
+    }
+
+    int available() {
+        Ring *r = &_ring[get_core_num()];
+        return (r->tail - r->head) & (ENTRIES - 1);
+    }
+
+    // Called from **INTERRUPT CONTEXT** on the core that set it, for every
+    // message sent to this core.  Not available under FreeRTOS.
+    void onReceive(MessageCB cb) {
+        if (__isFreeRTOS) {
+            // FreeRTOS port.c owns the FIFO IRQ
+            return;
+        }
+        _cb[get_core_num()] = cb;
+        __dmb();
+    }
+
+    // Only for use by the multicore FIFO IRQ
+    void _dispatch() {
+        int core = get_core_num();
+        _pending[core] = false;
+        __dmb(); // Any send after this point will kick us again
+        void *msg;
+        size_t len;
+        while (_cb[core] && _pop(core, &msg, &len)) {
+            _cb[core](msg, len);
+        }
+    }
+
+    static constexpr uint32_t MSGREADY = 0xC0DE3E55;
+
+private:
+    bool _pop(int core, void **msg, size_t *len) {
+        // Receive from my own ring
+        Ring *r = &_ring[core];
+        uint32_t h = r->head;
+        if (h == r->tail) {
+            return false;
+        }
+        __dmb(); // Don't read the entry until we've seen the tail
+        *msg = r->msg[h];
+        if (len) {
+            *len = r->len[h];
+        }
+        __dmb(); // Entry must be read before the slot is released
+        r->head = (h + 1) & (ENTRIES - 1);
+        return true;
+    }
+
+    static constexpr uint32_t ENTRIES = 32; // Must be a power of 2
+    typedef struct {
+        void *msg[ENTRIES];
+        size_t len[ENTRIES];
+        volatile uint32_t head; // Only written by the receiving core
+        volatile uint32_t tail; // Only written by the sending core
+    } Ring;
+
+    bool _multicore = false;
+    Ring _ring[2]; // Ring N is read by core N
+    MessageCB volatile _cb[2];
+    volatile bool _pending[2];
+};
 
 class _MFIFO {
 public:
@@ -62,9 +198,9 @@ public:
         if (!__isFreeRTOS) {
             multicore_fifo_clear_irq();
 #if defined(PICO_RP2350)
-            /* TODO: add proper irq handling */
-            //irq_set_exclusive_handler(SIO_IRQ_PROC0 + get_core_num(), _irq);
-            //irq_set_enabled(SIO_IRQ_PROC0 + get_core_num(), true);
+            // Each core has its own FIFO IRQ, at the same number
+            irq_set_exclusive_handler(SIO_IRQ_FIFO, _irq);
+            irq_set_enabled(SIO_IRQ_FIFO, true);
 #elif defined(PICO_RP2040)
             irq_set_exclusive_handler(SIO_IRQ_PROC0 + get_core_num(), _irq);
             irq_set_enabled(SIO_IRQ_PROC0 + get_core_num(), true);
@@ -143,15 +279,18 @@ private:
     static void __no_inline_not_in_flash_func(_irq)() {
         if (!__isFreeRTOS) {
             multicore_fifo_clear_irq();
-            noInterrupts(); // We need total control, can't run anything
             while (multicore_fifo_rvalid()) {
-                if (_GOTOSLEEP == multicore_fifo_pop_blocking()) {
+                uint32_t val = multicore_fifo_pop_blocking();
+                if (_GOTOSLEEP == val) {
+                    noInterrupts(); // We need total control, can't run anything
                     __otherCoreIdled = true;
                     while (__otherCoreIdled) { /* noop */ }
+                    interrupts();
                     break;
+                } else if (_MChannel::MSGREADY == val) {
+                    __multicoreChannelIRQ();
                 }
             }
-            interrupts();
         }
     }
 
@@ -173,6 +312,38 @@ extern "C" bool core1_separate_stack;
 extern "C" uint32_t* core1_separate_stack_address;
 extern "C" size_t _psram_size;
 
+// Small-block pool allocator statistics, per size class (see malloc-lock.cpp)
+typedef struct {
+    uint16_t size;   // Block size of this class
+    uint16_t pages;  // Arena pages assigned to this class
+    int32_t  inUse;  // Blocks currently allocated
+    int32_t  peak;   // Most blocks ever allocated at once
+    uint32_t allocs; // Total allocations served
+} HeapPoolStats;
+extern "C" size_t __malloc_pool_arena_size();
+extern "C" size_t __malloc_pool_used();
+extern "C" int __malloc_pool_stats(HeapPoolStats *stats, int maxClasses);
+extern "C" uint32_t __malloc_pool_fallbacks();
+
+// Where bufmalloc() places its allocations (see psram.cpp)
+typedef enum {
+    PSRAM_POLICY_NEVER,  // Normal heap only (default)
+    PSRAM_POLICY_LARGE,  // PSRAM for requests of at least the threshold size
+    PSRAM_POLICY_ALWAYS  // PSRAM first for everything
+} PSRAMPolicy;
+extern "C" size_t __psram_heap_size();
+extern "C" size_t __psram_heap_used();
+extern "C" size_t __psram_heap_largest();
+extern "C" void __psram_set_policy(PSRAMPolicy policy, size_t threshold);
+
+// Flash program/erase statistics (see RP2040Support.cpp)
+typedef struct {
+    uint32_t ops;     // Program pages and erase sectors written
+    uint32_t lastUs;  // Time the last erase or run of pages held off interrupts and XIP
+    uint32_t maxUs;   // Longest such stall
+    uint64_t totalUs; // Sum of all stalls
+} FlashStats;
+
 class RP2040 {
 public:
     RP2040()  { /* noop */ }
@@ -245,8 +416,19 @@ public:
     }
 
     inline int getUsedHeap() {
+        // The pool arena is one big newlib block, so only count what's actually in use in it
         struct mallinfo m = mallinfo();
-        return m.uordblks;
+        return m.uordblks - __malloc_pool_arena_size() + __malloc_pool_used();
+    }
+
+    // Fills in up to maxClasses entries, returns the number of size classes
+    inline int getHeapPoolStats(HeapPoolStats *stats, int maxClasses) {
+        return __malloc_pool_stats(stats, maxClasses);
+    }
+
+    // Number of small allocations which had to go to the main heap because the pool was full
+    inline uint32_t getHeapPoolFallbacks() {
+        return __malloc_pool_fallbacks();
     }
 
     inline int getTotalHeap() {
@@ -280,6 +462,29 @@ public:
 #endif
     }
 
+    // PSRAM heap usage, all 0 when there is no PSRAM
+    inline size_t getTotalPSRAMHeap() {
+        return __psram_heap_size();
+    }
+
+    inline size_t getUsedPSRAMHeap() {
+        return __psram_heap_used();
+    }
+
+    inline size_t getFreePSRAMHeap() {
+        return getTotalPSRAMHeap() - getUsedPSRAMHeap();
+    }
+
+    // Largest single pmalloc() that can currently succeed
+    inline size_t getMaxFreePSRAMBlock() {
+        return __psram_heap_largest();
+    }
+
+    // Choose where bufmalloc() places buffers, see PSRAMPolicy
+    inline void setPSRAMPolicy(PSRAMPolicy policy, size_t threshold = 4096) {
+        __psram_set_policy(policy, threshold);
+    }
+
     void idleOtherCore() {
         fifo.idleOtherCore();
     }
@@ -288,6 +493,18 @@ public:
         fifo.resumeOtherCore();
     }
 
+    // Erase or program flash (offsets from the start of flash, not XIP_BASE).  The work is
+    // split into sectors or pages, so interrupts and the other core only stall for one piece
+    // at a time.  The other core is not parked at all if it has called setFlashSafeCore(true).
+    void flashErase(uint32_t offset, size_t count);
+    void flashProgram(uint32_t offset, const uint8_t *data, size_t count);
+
+    // Promise that the calling core only runs code and touches data in RAM (including its
+    // IRQ handlers), so it may keep running while the other core writes to flash
+    void setFlashSafeCore(bool safe);
+
+    void getFlashStats(FlashStats *stats);
+
     void restartCore1() {
         multicore_reset_core1();
         fifo.clear();
@@ -333,6 +550,9 @@ public:
     // Multicore comms FIFO
     _MFIFO fifo;
 
+    // Multicore zero-copy message channel
+    _MChannel channel;
+
 
     uint32_t hwrand32() {
         return get_rand_32();
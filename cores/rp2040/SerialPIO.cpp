@@ -21,6 +21,8 @@
 #include "SerialPIO.h"
 #include "CoreMutex.h"
 #include <hardware/gpio.h>
+#include <hardware/dma.h>
+#include <algorithm>
 #include <map>
 #include "pio_uart.pio.h"
 
@@ -69,69 +71,128 @@ static PIOProgram *_getRxProgram(int bits, bool inverted) {
 }
 // ------------------------------------------------------------------------
 
-// TODO - this works, but there must be a faster/better way...
-static int _parity(int bits, int data) {
-    int p = 0;
-    for (int b = 0; b < bits; b++) {
-        p ^= (data & (1 << b)) ? 1 : 0;
-    }
-    return p;
+// Every other RX sample is a bit center, so keep only the even bits and squeeze
+// them together 2, 4, 8 and then 16 bits at a time
+static inline uint32_t _evenBits(uint32_t x) {
+    x = (x | (x >> 1)) & 0x33333333;
+    x = (x | (x >> 2)) & 0x0f0f0f0f;
+    x = (x | (x >> 4)) & 0x00ff00ff;
+    x = (x | (x >> 8)) & 0x0000ffff;
+    return x;
 }
 
-// We need to cache generated SerialPIOs so we can add data to them from
-// the shared handler
-static SerialPIO *_pioSP[2][4];
-static void __not_in_flash_func(_fifoIRQ)() {
-    for (int p = 0; p < 2; p++) {
-        for (int sm = 0; sm < 4; sm++) {
-            SerialPIO *s = _pioSP[p][sm];
-            if (s) {
-                s->_handleIRQ();
-                pio_interrupt_clear((p == 0) ? pio0 : pio1, sm);
-            }
+// Parity of the low 9 bits: fold them into a nibble and look it up in a
+// 16-entry, 1-bit table held in a constant
+static inline uint32_t _parity9(uint32_t x) {
+    x ^= x >> 8;
+    x ^= x >> 4;
+    return (0x6996 >> (x & 0x0f)) & 1;
+}
+
+// Words per half of the TX DMA buffer
+#define SERIALPIO_TX_WORDS 16
+
+// We need to cache generated SerialPIOs so the IRQ handlers can go straight
+// to the port that has data waiting
+static SerialPIO *_pioSP[NUM_PIOS][4];
+
+static __force_inline void _dispatchIRQ(PIO pio, int p) {
+    // Only the SMs with RX data pending, from the masked IRQ status
+    uint32_t pending = pio->ints0 & ((1u << (pis_sm3_rx_fifo_not_empty + 1)) - 1);
+    for (int sm = 0; pending; sm++, pending >>= 1) {
+        if ((pending & 1) && _pioSP[p][sm]) {
+            _pioSP[p][sm]->_handleIRQ();
         }
     }
 }
 
+static void __not_in_flash_func(_fifoIRQ0)() {
+    _dispatchIRQ(pio0, 0);
+}
+
+static void __not_in_flash_func(_fifoIRQ1)() {
+    _dispatchIRQ(pio1, 1);
+}
+
+#if NUM_PIOS > 2
+static void __not_in_flash_func(_fifoIRQ2)() {
+    _dispatchIRQ(pio2, 2);
+}
+#endif
+
+static const irq_handler_t _fifoIRQ[NUM_PIOS] = { _fifoIRQ0, _fifoIRQ1
+#if NUM_PIOS > 2
+                                                  , _fifoIRQ2
+#endif
+                                                };
+
+static int _fifoIRQNum(PIO pio) {
+    return PIO0_IRQ_0 + pio_get_index(pio) * (PIO1_IRQ_0 - PIO0_IRQ_0);
+}
+
+// Returns the received character, or -1 on a parity error
+int __not_in_flash_func(SerialPIO::_decode)(uint32_t raw) {
+    uint32_t val = _evenBits(((raw ^ (_rxInverted ? 0xffffffff : 0)) >> _rxShift) & _rxMask);
+    if ((_parity != UART_PARITY_NONE) && (_parity9(val) != ((_parity == UART_PARITY_ODD) ? 1u : 0u))) {
+        // TODO - parity error
+        return -1;
+    }
+    return val & ((1 << _bits) - 1);
+}
+
 void __not_in_flash_func(SerialPIO::_handleIRQ)() {
     if (_rx == NOPIN) {
         return;
     }
-    while (!pio_sm_is_rx_fifo_empty(_rxPIO, _rxSM)) {
-        uint32_t decode = _rxPIO->rxf[_rxSM] ^ (_rxInverted ? 0xffffffff : 0);
-        decode >>= 33 - _rxBits;
-        uint32_t val = 0;
-        for (int b = 0; b < _bits + 1; b++) {
-            val |= (decode & (1 << (b * 2))) ? 1 << b : 0;
-        }
-        if (_parity == UART_PARITY_EVEN) {
-            int p = ::_parity(_bits, val);
-            int r = (val & (1 << _bits)) ? 1 : 0;
-            if (p != r) {
-                // TODO - parity error
+    // Empty the whole FIFO and only publish the new writer once at the end
+    uint32_t writer = _writer;
+    uint32_t level;
+    while ((level = pio_sm_get_rx_fifo_level(_rxPIO, _rxSM)) != 0) {
+        while (level--) {
+            int c = _decode(_rxPIO->rxf[_rxSM]);
+            if (c < 0) {
                 continue;
             }
-        } else if (_parity == UART_PARITY_ODD) {
-            int p = ::_parity(_bits, val);
-            int r = (val & (1 << _bits)) ? 1 : 0;
-            if (p == r) {
-                // TODO - parity error
-                continue;
+            auto next_writer = writer + 1;
+            if (next_writer == _fifoSize) {
+                next_writer = 0;
+            }
+            if (next_writer != _reader) {
+                _queue[writer] = c;
+                writer = next_writer;
+            } else {
+                _overflow = true;
             }
         }
+    }
+    asm volatile("" ::: "memory"); // Ensure the queue is written before the written count advances
+    _writer = writer;
+}
 
-        auto next_writer = _writer + 1;
+// Decode whatever the RX DMA has added to the ring, called with _mutex held
+void SerialPIO::_pumpRXDMA() {
+    bool lapped;
+    uint32_t n = _rxRing.available(&lapped);
+    if (lapped) {
+        // The DMA has lapped us, so the oldest data was dropped
+        _overflow = true;
+    }
+    uint32_t writer = _writer;
+    while (n--) {
+        auto next_writer = writer + 1;
         if (next_writer == _fifoSize) {
             next_writer = 0;
         }
-        if (next_writer != _reader) {
-            _queue[_writer] = val & ((1 << _bits) -  1);
-            asm volatile("" ::: "memory"); // Ensure the queue is written before the written count advances
-            _writer = next_writer;
-        } else {
-            _overflow = true;
+        if (next_writer == _reader) {
+            break; // Leave the rest in the ring until there's space
+        }
+        int c = _decode(_rxRing.pop());
+        if (c >= 0) {
+            _queue[writer] = c;
+            writer = next_writer;
         }
     }
+    _writer = writer;
 }
 
 SerialPIO::SerialPIO(pin_size_t tx, pin_size_t rx, size_t fifoSize) {
@@ -210,6 +271,20 @@ void SerialPIO::begin(unsigned long baud, uint16_t config) {
         pio_sm_exec(_txPIO, _txSM, pio_encode_pull(false, false));
         pio_sm_exec(_txPIO, _txSM, pio_encode_mov(pio_isr, pio_osr));
 
+        if (_txDMAMode) {
+            _txDMA = dma_claim_unused_channel(false);
+            if (_txDMA != -1) {
+                _txBuf = new uint32_t[2 * SERIALPIO_TX_WORDS];
+                _txHalf = 0;
+                dma_channel_config c = dma_channel_get_default_config(_txDMA);
+                channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+                channel_config_set_read_increment(&c, true);
+                channel_config_set_write_increment(&c, false);
+                channel_config_set_dreq(&c, pio_get_dreq(_txPIO, _txSM, true));
+                dma_channel_configure(_txDMA, &c, &_txPIO->txf[_txSM], _txBuf, 0, false);
+            }
+        }
+
         // Start running!
         pio_sm_set_enabled(_txPIO, _txSM, true);
     }
@@ -218,6 +293,12 @@ void SerialPIO::begin(unsigned long baud, uint16_t config) {
         _reader = 0;
 
         _rxBits = 2 * (_bits + _stop + (_parity != UART_PARITY_NONE ? 1 : 0) + 1) - 1;
+        // The start bit's 2 samples sit below the data once the raw word is right-aligned
+        _rxShift = 33 - _rxBits;
+        _rxMask = 0;
+        for (int b = 0; b < _bits + (_parity != UART_PARITY_NONE ? 1 : 0); b++) {
+            _rxMask |= 1 << (b * 2);
+        }
         _rxPgm = _getRxProgram(_rxBits, _rxInverted);
         int off;
         if (!_rxPgm->prepare(&_rxPIO, &_rxSM, &off)) {
@@ -238,16 +319,36 @@ void SerialPIO::begin(unsigned long baud, uint16_t config) {
         // Join the TX FIFO to the RX one now that we don't need it
         _rxPIO->sm[_rxSM].shiftctrl |= 0x80000000;
 
-        // Enable interrupts on rxfifo
-        switch (_rxSM) {
-        case 0: pio_set_irq0_source_enabled(_rxPIO, pis_sm0_rx_fifo_not_empty, true); break;
-        case 1: pio_set_irq0_source_enabled(_rxPIO, pis_sm1_rx_fifo_not_empty, true); break;
-        case 2: pio_set_irq0_source_enabled(_rxPIO, pis_sm2_rx_fifo_not_empty, true); break;
-        case 3: pio_set_irq0_source_enabled(_rxPIO, pis_sm3_rx_fifo_not_empty, true); break;
+        _rxDMA = _rxDMAMode ? dma_claim_unused_channel(false) : -1;
+        if (_rxDMA != -1) {
+            // DMA ring mode needs a power-of-2 sized and aligned buffer, up to 32KB
+            _rxBufSize = 8;
+            while ((_rxBufSize < 8192) && (_rxBufSize < _fifoSize)) {
+                _rxBufSize <<= 1;
+            }
+            _rxBuf = (uint32_t *)aligned_alloc(_rxBufSize * sizeof(uint32_t), _rxBufSize * sizeof(uint32_t));
+            if (!_rxBuf) {
+                dma_channel_unclaim(_rxDMA);
+                _rxDMA = -1;
+            }
+        }
+        if (_rxDMA != -1) {
+            // The DMA copies the raw words and they're only decoded when read, so no IRQ at all
+            _rxRing.begin(_rxDMA, _rxBuf, _rxBufSize);
+            dma_channel_config c = dma_channel_get_default_config(_rxDMA);
+            channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+            channel_config_set_read_increment(&c, false);
+            channel_config_set_write_increment(&c, true);
+            channel_config_set_ring(&c, true, __builtin_ctz(_rxBufSize * sizeof(uint32_t)));
+            channel_config_set_dreq(&c, pio_get_dreq(_rxPIO, _rxSM, false));
+            dma_channel_configure(_rxDMA, &c, _rxBuf, &_rxPIO->rxf[_rxSM], DMARing::COUNT, true);
+        } else {
+            // Enable interrupts on rxfifo
+            pio_set_irq0_source_enabled(_rxPIO, (enum pio_interrupt_source)(pis_sm0_rx_fifo_not_empty + _rxSM), true);
+            auto irqno = _fifoIRQNum(_rxPIO);
+            irq_set_exclusive_handler(irqno, _fifoIRQ[pio_get_index(_rxPIO)]);
+            irq_set_enabled(irqno, true);
         }
-        auto irqno = pio_get_index(_rxPIO) == 0 ? PIO0_IRQ_0 : PIO1_IRQ_0;
-        irq_set_exclusive_handler(irqno, _fifoIRQ);
-        irq_set_enabled(irqno, true);
 
         pio_sm_set_enabled(_rxPIO, _rxSM, true);
     }
@@ -260,12 +361,28 @@ void SerialPIO::end() {
         return;
     }
     if (_tx != NOPIN) {
+        if (_txDMA != -1) {
+            dma_channel_wait_for_finish_blocking(_txDMA);
+            dma_channel_unclaim(_txDMA);
+            _txDMA = -1;
+            delete[] _txBuf;
+            _txBuf = nullptr;
+        }
         pio_sm_set_enabled(_txPIO, _txSM, false);
-        pio_sm_unclaim(_txPIO, _txSM);
+        _txPgm->unprepare(_txPIO, _txSM);
     }
     if (_rx != NOPIN) {
         pio_sm_set_enabled(_rxPIO, _rxSM, false);
-        pio_sm_unclaim(_rxPIO, _rxSM);
+        if (_rxDMA != -1) {
+            dma_channel_abort(_rxDMA);
+            dma_channel_unclaim(_rxDMA);
+            _rxDMA = -1;
+            free(_rxBuf);
+            _rxBuf = nullptr;
+        } else {
+            pio_set_irq0_source_enabled(_rxPIO, (enum pio_interrupt_source)(pis_sm0_rx_fifo_not_empty + _rxSM), false);
+        }
+        _rxPgm->unprepare(_rxPIO, _rxSM);
         _pioSP[pio_get_index(_rxPIO)][_rxSM] = nullptr;
         // If no more active, disable the IRQ
         auto pioNum = pio_get_index(_rxPIO);
@@ -274,8 +391,7 @@ void SerialPIO::end() {
             used = used || !!_pioSP[pioNum][i];
         }
         if (!used) {
-            auto irqno = pioNum == 0 ? PIO0_IRQ_0 : PIO1_IRQ_0;
-            irq_set_enabled(irqno, false);
+            irq_set_enabled(_fifoIRQNum(_rxPIO), false);
         }
     }
     _running = false;
@@ -286,6 +402,9 @@ int SerialPIO::peek() {
     if (!_running || !m || (_rx == NOPIN)) {
         return -1;
     }
+    if (_rxDMA != -1) {
+        _pumpRXDMA();
+    }
     // If there's something in the FIFO now, just peek at it
     if (_writer != _reader) {
         return _queue[_reader];
@@ -298,6 +417,9 @@ int SerialPIO::read() {
     if (!_running || !m || (_rx == NOPIN)) {
         return -1;
     }
+    if (_rxDMA != -1) {
+        _pumpRXDMA();
+    }
     if (_writer != _reader) {
         auto ret = _queue[_reader];
         asm volatile("" ::: "memory"); // Ensure the value is read before advancing
@@ -314,6 +436,9 @@ bool SerialPIO::overflow() {
     if (!_running || !m || (_rx == NOPIN)) {
         return false;
     }
+    if (_rxDMA != -1) {
+        _pumpRXDMA();
+    }
 
     bool hold = _overflow;
     _overflow = false;
@@ -325,6 +450,9 @@ int SerialPIO::available() {
     if (!_running || !m || (_rx == NOPIN)) {
         return 0;
     }
+    if (_rxDMA != -1) {
+        _pumpRXDMA();
+    }
     return (_writer - _reader) % _fifoSize;
 }
 
@@ -333,6 +461,9 @@ int SerialPIO::availableForWrite() {
     if (!_running || !m || (_tx == NOPIN)) {
         return 0;
     }
+    if ((_txDMA != -1) && dma_channel_is_busy(_txDMA)) {
+        return 0;
+    }
     return 8 - pio_sm_get_tx_fifo_level(_txPIO, _txSM);
 }
 
@@ -341,6 +472,9 @@ void SerialPIO::flush() {
     if (!_running || !m || (_tx == NOPIN)) {
         return;
     }
+    if (_txDMA != -1) {
+        dma_channel_wait_for_finish_blocking(_txDMA);
+    }
     while (!pio_sm_is_tx_fifo_empty(_txPIO, _txSM)) {
         delay(1); // Wait for all FIFO to be read
     }
@@ -353,29 +487,75 @@ void SerialPIO::setInverted(bool invTx, bool invRx) {
     _rxInverted = invRx;
 }
 
-size_t SerialPIO::write(uint8_t c) {
-    CoreMutex m(&_mutex);
-    if (!_running || !m || (_tx == NOPIN)) {
-        return 0;
+bool SerialPIO::setRXDMAMode(bool mode) {
+    if (_running) {
+        return false;
     }
+    _rxDMAMode = mode;
+    return true;
+}
+
+bool SerialPIO::setTXDMAMode(bool mode) {
+    if (_running) {
+        return false;
+    }
+    _txDMAMode = mode;
+    return true;
+}
 
-    uint32_t val = c;
+// The start, data, parity and stop bits in the order the PIO shifts them out
+uint32_t SerialPIO::_encode(uint8_t c) {
+    uint32_t val = c & ((1 << _bits) - 1);
     if (_parity == UART_PARITY_NONE) {
         val |= 7 << _bits; // Set 2 stop bits, the HW will only transmit the required number
-    } else if (_parity == UART_PARITY_EVEN) {
-        val |= ::_parity(_bits, c) << _bits;
-        val |= 7 << (_bits + 1);
     } else {
-        val |= (1 ^ ::_parity(_bits, c)) << _bits;
+        val |= (_parity9(val) ^ ((_parity == UART_PARITY_ODD) ? 1 : 0)) << _bits;
         val |= 7 << (_bits + 1);
     }
     val <<= 1;  // Start bit = low
+    return _txInverted ? ~val : val;
+}
 
-    pio_sm_put_blocking(_txPIO, _txSM, _txInverted ? ~val : val);
-
+size_t SerialPIO::write(uint8_t c) {
+    CoreMutex m(&_mutex);
+    if (!_running || !m || (_tx == NOPIN)) {
+        return 0;
+    }
+    if (_txDMA != -1) {
+        // Keep the order with any block still being sent
+        dma_channel_wait_for_finish_blocking(_txDMA);
+    }
+    pio_sm_put_blocking(_txPIO, _txSM, _encode(c));
     return 1;
 }
 
+size_t SerialPIO::write(const uint8_t *p, size_t len) {
+    CoreMutex m(&_mutex);
+    if (!_running || !m || (_tx == NOPIN)) {
+        return 0;
+    }
+    if (_txDMA == -1) {
+        for (size_t i = 0; i < len; i++) {
+            pio_sm_put_blocking(_txPIO, _txSM, _encode(p[i]));
+        }
+        return len;
+    }
+    // Encode into one half while the DMA is still sending the other
+    size_t left = len;
+    while (left) {
+        size_t cnt = std::min(left, (size_t)SERIALPIO_TX_WORDS);
+        uint32_t *buf = _txBuf + _txHalf * SERIALPIO_TX_WORDS;
+        for (size_t i = 0; i < cnt; i++) {
+            buf[i] = _encode(*p++);
+        }
+        dma_channel_wait_for_finish_blocking(_txDMA);
+        dma_channel_transfer_from_buffer_now(_txDMA, buf, cnt);
+        _txHalf ^= 1;
+        left -= cnt;
+    }
+    return len;
+}
+
 SerialPIO::operator bool() {
     return _running;
 }
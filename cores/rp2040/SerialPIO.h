@@ -26,6 +26,7 @@
 #include <queue>
 #include <hardware/uart.h>
 #include "CoreMutex.h"
+#include "DMARing.h"
 
 extern "C" typedef struct uart_inst uart_inst_t;
 
@@ -42,6 +43,9 @@ public:
     void end() override;
 
     void setInverted(bool invTx = true, bool invRx = true);
+    // Must be called before begin()
+    bool setRXDMAMode(bool mode = true);
+    bool setTXDMAMode(bool mode = true);
 
     virtual int peek() override;
     virtual int read() override;
@@ -49,6 +53,7 @@ public:
     virtual int availableForWrite() override;
     virtual void flush() override;
     virtual size_t write(uint8_t c) override;
+    virtual size_t write(const uint8_t *p, size_t len) override;
     bool overflow();
     using Print::write;
     operator bool() override;
@@ -77,12 +82,31 @@ protected:
     PIO _rxPIO;
     int _rxSM;
     int _rxBits;
+    int _rxShift;      // Drops the start bit samples from a raw RX word
+    uint32_t _rxMask;  // Data and parity bit center samples after the shift
 
     // Lockless, IRQ-handled circular queue
     size_t   _fifoSize;
     uint32_t _writer;
     uint32_t _reader;
     uint8_t  *_queue;
+
+    int _decode(uint32_t raw);
+    uint32_t _encode(uint8_t c);
+
+    // Optional DMA of the raw PIO words into a ring, decoded when the app reads
+    bool      _rxDMAMode = false;
+    int       _rxDMA = -1;
+    uint32_t  *_rxBuf = nullptr;
+    uint32_t  _rxBufSize;   // Words, a power of 2
+    DMARing   _rxRing;
+    void _pumpRXDMA();
+
+    // Optional DMA of encoded words into the TX FIFO, ping-ponging between two halves of _txBuf
+    bool      _txDMAMode = false;
+    int       _txDMA = -1;
+    uint32_t  *_txBuf = nullptr;
+    int       _txHalf;
 };
 
 #ifdef ARDUINO_NANO_RP2040_CONNECT
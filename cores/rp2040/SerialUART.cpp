@@ -22,6 +22,8 @@
 #include "CoreMutex.h"
 #include <hardware/uart.h>
 #include <hardware/gpio.h>
+#include <hardware/dma.h>
+#include <hardware/sync.h>
 
 // SerialEvent functions are weak, so when the user doesn't define them,
 // the linker just sets their address to 0 (which is checked below).
@@ -122,6 +124,14 @@ bool SerialUART::setPollingMode(bool mode) {
     return true;
 }
 
+bool SerialUART::setRXDMAMode(bool mode) {
+    if (_running) {
+        return false;
+    }
+    _rxDMAMode = mode;
+    return true;
+}
+
 bool SerialUART::setFIFOSize(size_t size) {
     if (!size || _running) {
         return false;
@@ -130,6 +140,14 @@ bool SerialUART::setFIFOSize(size_t size) {
     return true;
 }
 
+bool SerialUART::setTXFIFOSize(size_t size) {
+    if (_running) {
+        return false;
+    }
+    _txFifoSize = size ? size + 1 : 0; // Always 1 unused entry
+    return true;
+}
+
 SerialUART::SerialUART(uart_inst_t *uart, pin_size_t tx, pin_size_t rx, pin_size_t rts, pin_size_t cts) {
     _uart = uart;
     _tx = tx;
@@ -138,17 +156,59 @@ SerialUART::SerialUART(uart_inst_t *uart, pin_size_t tx, pin_size_t rx, pin_size
     _cts = cts;
     mutex_init(&_mutex);
     mutex_init(&_fifoMutex);
+    mutex_init(&_txMutex);
 }
 
 static void _uart0IRQ();
 static void _uart1IRQ();
+static void _uartDMAIRQ();
+static int __dmaChannels = 0; // Number of UART DMA channels using the shared DMA IRQ handler
+
+static void _addDMAChannel(int ch) {
+    dma_channel_set_irq1_enabled(ch, true);
+    if (!__dmaChannels++) {
+        irq_add_shared_handler(DMA_IRQ_1, _uartDMAIRQ, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_1, true);
+    }
+}
+
+static void _removeDMAChannel(int ch) {
+    dma_channel_set_irq1_enabled(ch, false);
+    dma_channel_cleanup(ch);
+    dma_channel_unclaim(ch);
+    if (!--__dmaChannels) {
+        irq_remove_handler(DMA_IRQ_1, _uartDMAIRQ);
+    }
+}
 
 void SerialUART::begin(unsigned long baud, uint16_t config) {
     if (_running) {
         end();
     }
     _overflow = false;
-    _queue = new uint8_t[_fifoSize];
+    // DMA needs an IRQ to restart it, so no DMA RX in polling mode
+    _rxDMA = (_rxDMAMode && !_polling) ? dma_claim_unused_channel(false) : -1;
+    int ringBits = 0;
+    _queueSize = _fifoSize;
+    if (_rxDMA != -1) {
+        // DMA ring mode needs a power-of-2 sized and aligned buffer, up to 32KB
+        ringBits = 5;
+        while ((ringBits < 15) && ((1u << ringBits) < _fifoSize)) {
+            ringBits++;
+        }
+        _queueSize = 1u << ringBits;
+        _queue = (uint8_t *)aligned_alloc(_queueSize, _queueSize);
+        if (!_queue) {
+            // No aligned ring, so use the normal IRQ-driven FIFO instead
+            DEBUGCORE("ERROR: Unable to allocate SerialUART DMA ring, using IRQ mode\n");
+            dma_channel_unclaim(_rxDMA);
+            _rxDMA = -1;
+            _queueSize = _fifoSize;
+        }
+    }
+    if (_rxDMA == -1) {
+        _queue = new uint8_t[_queueSize];
+    }
     _baud = baud;
 
     _fcnTx = gpio_get_function(_tx);
@@ -204,6 +264,22 @@ void SerialUART::begin(unsigned long baud, uint16_t config) {
     uart_set_hw_flow(_uart, _cts != UART_PIN_NOT_DEFINED, _rts != UART_PIN_NOT_DEFINED);
     _writer = 0;
     _reader = 0;
+    _rxRead = 0;
+
+    if (_rxDMA != -1) {
+        dma_channel_config c = dma_channel_get_default_config(_rxDMA);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+        channel_config_set_read_increment(&c, false);
+        channel_config_set_write_increment(&c, true);
+        channel_config_set_ring(&c, true, ringBits);
+        channel_config_set_dreq(&c, uart_get_dreq(_uart, false));
+        _rxSeq = 0;
+        _rxBase = 0;
+        // Each run fills the ring exactly once, then the IRQ restarts it
+        dma_channel_configure(_rxDMA, &c, _queue, &uart_get_hw(_uart)->dr, _queueSize, false);
+        _addDMAChannel(_rxDMA);
+        dma_channel_start(_rxDMA);
+    }
 
     if (!_polling) {
         if (_uart == uart0) {
@@ -213,11 +289,33 @@ void SerialUART::begin(unsigned long baud, uint16_t config) {
             irq_set_exclusive_handler(UART1_IRQ, _uart1IRQ);
             irq_set_enabled(UART1_IRQ, true);
         }
-        // Set the IRQ enables and FIFO level to minimum
-        uart_set_irq_enables(_uart, true, false);
+        if (_rxDMA != -1) {
+            // DMA moves the data, only interrupt on line errors
+            uart_get_hw(_uart)->imsc = UART_UARTIMSC_BEIM_BITS | UART_UARTIMSC_OEIM_BITS;
+        } else {
+            // Set the IRQ enables and FIFO level to minimum
+            uart_set_irq_enables(_uart, true, false);
+        }
     } else {
         // Polling mode has no IRQs used
     }
+    _txWriter = 0;
+    _txReader = 0;
+    _txInFlight = 0;
+    // DMA chaining needs the completion IRQ, so no TX queue in polling mode
+    if (_txFifoSize && !_polling) {
+        _txDMA = dma_claim_unused_channel(false);
+        if (_txDMA != -1) {
+            _txQueue = new uint8_t[_txFifoSize];
+            dma_channel_config c = dma_channel_get_default_config(_txDMA);
+            channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+            channel_config_set_read_increment(&c, true);
+            channel_config_set_write_increment(&c, false);
+            channel_config_set_dreq(&c, uart_get_dreq(_uart, true));
+            dma_channel_configure(_txDMA, &c, &uart_get_hw(_uart)->dr, _txQueue, 0, false);
+            _addDMAChannel(_txDMA);
+        }
+    }
     _break = false;
     _running = true;
 }
@@ -226,7 +324,18 @@ void SerialUART::end() {
     if (!_running) {
         return;
     }
+    if (_txQueue) {
+        // Let any queued data go out before shutting down
+        flush();
+    }
     _running = false;
+    if (_txQueue) {
+        _removeDMAChannel(_txDMA);
+        _txDMA = -1;
+    }
+    if (_rxDMA != -1) {
+        _removeDMAChannel(_rxDMA);
+    }
     if (!_polling) {
         if (_uart == uart0) {
             irq_set_enabled(UART0_IRQ, false);
@@ -239,7 +348,14 @@ void SerialUART::end() {
     mutex_enter_blocking(&_mutex);
     mutex_enter_blocking(&_fifoMutex);
     uart_deinit(_uart);
-    delete[] _queue;
+    if (_rxDMA != -1) {
+        free(_queue);
+        _rxDMA = -1;
+    } else {
+        delete[] _queue;
+    }
+    delete[] _txQueue;
+    _txQueue = nullptr;
     // Reset the mutexes once all is off/cleaned up
     mutex_exit(&_fifoMutex);
     mutex_exit(&_mutex);
@@ -298,14 +414,36 @@ int SerialUART::read() {
     if (_writer != _reader) {
         auto ret = _queue[_reader];
         asm volatile("" ::: "memory"); // Ensure the value is read before advancing
-        auto next_reader = (_reader + 1) % _fifoSize;
+        auto next_reader = (_reader + 1) % _queueSize;
         asm volatile("" ::: "memory"); // Ensure the reader value is only written once, correctly
         _reader = next_reader;
+        _rxRead++;
         return ret;
     }
     return -1;
 }
 
+size_t SerialUART::read(uint8_t *p, size_t len) {
+    CoreMutex m(&_mutex);
+    if (!_running || !m) {
+        return 0;
+    }
+    if (_polling) {
+        _handleIRQ(false);
+    } else {
+        _pumpFIFO();
+    }
+    size_t cnt = std::min(len, (size_t)((_queueSize + _writer - _reader) % _queueSize));
+    // At most 2 copies, up to the end of the queue and then from its start
+    size_t first = std::min(cnt, (size_t)(_queueSize - _reader));
+    memcpy(p, _queue + _reader, first);
+    memcpy(p + first, _queue, cnt - first);
+    asm volatile("" ::: "memory"); // Ensure the data is read before advancing
+    _reader = (_reader + cnt) % _queueSize;
+    _rxRead += cnt;
+    return cnt;
+}
+
 bool SerialUART::overflow() {
     if (!_running) {
         return false;
@@ -335,7 +473,7 @@ int SerialUART::available() {
     } else {
         _pumpFIFO();
     }
-    return (_fifoSize + _writer - _reader) % _fifoSize;
+    return (_queueSize + _writer - _reader) % _queueSize;
 }
 
 int SerialUART::availableForWrite() {
@@ -346,9 +484,24 @@ int SerialUART::availableForWrite() {
     if (_polling) {
         _handleIRQ(false);
     }
+    if (_txQueue) {
+        return _txFree();
+    }
     return (uart_is_writable(_uart)) ? 1 : 0;
 }
 
+// True when no IRQ of ours can run on this core: interrupts are off or we're already in a handler
+static bool _irqsBlocked() {
+    uint32_t status = save_and_disable_interrupts();
+    restore_interrupts(status);
+#ifdef __riscv
+    bool off = !(status & 0x8); // mstatus.MIE
+#else
+    bool off = status & 1;      // PRIMASK
+#endif
+    return off || __get_current_exception();
+}
+
 void SerialUART::flush() {
     CoreMutex m(&_mutex);
     if (!_running || !m) {
@@ -357,19 +510,19 @@ void SerialUART::flush() {
     if (_polling) {
         _handleIRQ(false);
     }
+    bool poll = _txQueue && _irqsBlocked();
+    while (_txQueue && (_txReader != _txWriter)) {
+        // Wait for the DMA to drain the queue, retiring each chunk here if its IRQ can't run
+        if (poll && dma_channel_get_irq1_status(_txDMA)) {
+            _finishTXDMA();
+        }
+        tight_loop_contents();
+    }
     uart_tx_wait_blocking(_uart);
 }
 
 size_t SerialUART::write(uint8_t c) {
-    CoreMutex m(&_mutex);
-    if (!_running || !m) {
-        return 0;
-    }
-    if (_polling) {
-        _handleIRQ(false);
-    }
-    uart_putc_raw(_uart, c);
-    return 1;
+    return write(&c, 1);
 }
 
 size_t SerialUART::write(const uint8_t *p, size_t len) {
@@ -380,6 +533,51 @@ size_t SerialUART::write(const uint8_t *p, size_t len) {
     if (_polling) {
         _handleIRQ(false);
     }
+    if (_txQueue) {
+        size_t cnt = len;
+        while (cnt) {
+            size_t space = _txFree();
+            if (!space) {
+                if (_irqsBlocked()) {
+                    // The DMA IRQ will never make room, so drain the queue by polling it and
+                    // send the rest straight to the UART, keeping the bytes in order
+                    while (_txReader != _txWriter) {
+                        if (dma_channel_get_irq1_status(_txDMA)) {
+                            _finishTXDMA();
+                        }
+                    }
+                    while (cnt--) {
+                        uart_putc_raw(_uart, *p++);
+                    }
+                    return len;
+                }
+                // Full, wait for the DMA to send something
+                tight_loop_contents();
+                continue;
+            }
+            // Copy as much as fits before the end of the ring
+            size_t chunk = std::min(std::min(space, cnt), (size_t)(_txFifoSize - _txWriter));
+            memcpy(_txQueue + _txWriter, p, chunk);
+            asm volatile("" ::: "memory"); // Ensure the queue is written before the writer advances
+            auto next_writer = _txWriter + chunk;
+            if (next_writer == _txFifoSize) {
+                next_writer = 0;
+            }
+            _txWriter = next_writer;
+            p += chunk;
+            cnt -= chunk;
+            // Start the DMA if it's idle, otherwise the completion IRQ will chain to the new data.
+            // Masking the channel IRQ stops this core's handler, the mutex the other core's.
+            dma_channel_set_irq1_enabled(_txDMA, false);
+            mutex_enter_blocking(&_txMutex);
+            if (!_txInFlight) {
+                _startTXDMA();
+            }
+            mutex_exit(&_txMutex);
+            dma_channel_set_irq1_enabled(_txDMA, true);
+        }
+        return len;
+    }
     size_t cnt = len;
     while (cnt) {
         uart_putc_raw(_uart, *p);
@@ -389,6 +587,82 @@ size_t SerialUART::write(const uint8_t *p, size_t len) {
     return len;
 }
 
+size_t SerialUART::_txFree() {
+    return (_txFifoSize + _txReader - _txWriter - 1) % _txFifoSize;
+}
+
+// Called from the IRQ or with the channel IRQ disabled, sends the largest contiguous chunk queued
+void __not_in_flash_func(SerialUART::_startTXDMA)() {
+    uint32_t r = _txReader;
+    uint32_t w = _txWriter;
+    if (r == w) {
+        return;
+    }
+    uint32_t cnt = (w > r) ? w - r : _txFifoSize - r;
+    _txInFlight = cnt;
+    dma_channel_transfer_from_buffer_now(_txDMA, _txQueue + r, cnt);
+}
+
+// Figure out how far the RX DMA has got, called with _fifoMutex held
+void SerialUART::_syncRXDMA() {
+    uint32_t seq, base, remain;
+    bool busy;
+    do {
+        seq = _rxSeq;
+        __dmb();
+        base = _rxBase;
+        remain = dma_channel_hw_addr(_rxDMA)->transfer_count;
+        busy = dma_channel_is_busy(_rxDMA);
+        __dmb();
+    } while ((seq & 1) || (seq != _rxSeq)); // Retry if the IRQ restarted the DMA under us
+    // Stopped means it's filled the ring but the IRQ hasn't restarted it yet
+    uint32_t written = base + (busy ? _queueSize - remain : _queueSize);
+    if (written - _rxRead >= _queueSize) {
+        // The DMA has lapped the reader, so drop the oldest data
+        _overflow = true;
+        _rxRead = written - (_queueSize - 1);
+    }
+    _writer = written & (_queueSize - 1);
+    _reader = _rxRead & (_queueSize - 1);
+}
+
+void __not_in_flash_func(SerialUART::_handleDMAIRQ)() {
+    if ((_rxDMA != -1) && dma_channel_get_irq1_status(_rxDMA)) {
+        _rxSeq++;
+        __dmb();
+        dma_channel_acknowledge_irq1(_rxDMA);
+        _rxBase += _queueSize;
+        // Write address has wrapped back to the start of the ring, so just run again
+        dma_channel_set_trans_count(_rxDMA, _queueSize, true);
+        __dmb();
+        _rxSeq++;
+    }
+    if ((_txDMA != -1) && dma_channel_get_irq1_status(_txDMA)) {
+        _finishTXDMA();
+    }
+}
+
+// Retires a completed TX DMA and starts the next chunk.  Called from the DMA IRQ, or
+// polled by write() when that IRQ can't run
+void __not_in_flash_func(SerialUART::_finishTXDMA)() {
+    uint32_t owner;
+    if (!mutex_try_enter(&_txMutex, &owner)) {
+        // Main app on the other core is restarting the DMA, and has masked
+        // this channel's IRQ so we'll be called again once it is done
+        return;
+    }
+    dma_channel_acknowledge_irq1(_txDMA);
+    // Avoid using division or mod because the HW divider could be in use
+    auto next_reader = _txReader + _txInFlight;
+    if (next_reader >= _txFifoSize) {
+        next_reader -= _txFifoSize;
+    }
+    _txReader = next_reader;
+    _txInFlight = 0;
+    _startTXDMA();
+    mutex_exit(&_txMutex);
+}
+
 SerialUART::operator bool() {
     return _running;
 }
@@ -434,6 +708,24 @@ void __not_in_flash_func(SerialUART::_handleIRQ)(bool inIRQ) {
             return;
         }
     }
+    if (_rxDMA != -1) {
+        // Data is moved by DMA so only line errors get reported here.  Note
+        // that bad or break characters can't be dropped and will be received
+        uint32_t mis = uart_get_hw(_uart)->mis;
+        if (mis & UART_UARTMIS_BEMIS_BITS) {
+            _break = true;
+        }
+        if (mis & UART_UARTMIS_OEMIS_BITS) {
+            _overflow = true;
+        }
+        uart_get_hw(_uart)->icr = UART_UARTICR_BEIC_BITS | UART_UARTICR_OEIC_BITS;
+        if (inIRQ) {
+            mutex_exit(&_fifoMutex);
+        } else {
+            _syncRXDMA();
+        }
+        return;
+    }
     // ICR is write-to-clear
     uart_get_hw(_uart)->icr = UART_UARTICR_RTIC_BITS | UART_UARTICR_RXIC_BITS;
     while (uart_is_readable(_uart)) {
@@ -448,7 +740,7 @@ void __not_in_flash_func(SerialUART::_handleIRQ)(bool inIRQ) {
         }
         uint8_t val = raw & 0xff;
         auto next_writer = _writer + 1;
-        if (next_writer == _fifoSize) {
+        if (next_writer == _queueSize) {
             next_writer = 0;
         }
         if (next_writer != _reader) {
@@ -493,6 +785,11 @@ static void __not_in_flash_func(_uart0IRQ)() {
     }
 }
 
+static void __not_in_flash_func(_uartDMAIRQ)() {
+    Serial1._handleDMAIRQ();
+    Serial2._handleDMAIRQ();
+}
+
 static void __not_in_flash_func(_uart1IRQ)() {
     if (__SERIAL2_DEVICE == uart1) {
         Serial2._handleIRQ();
@@ -45,7 +45,9 @@ public:
         return ret;
     }
     bool setFIFOSize(size_t size);
+    bool setTXFIFOSize(size_t size);
     bool setPollingMode(bool mode = true);
+    bool setRXDMAMode(bool mode = true);
 
     void begin(unsigned long baud = 115200) override {
         begin(baud, SERIAL_8N1);
@@ -60,6 +62,7 @@ public:
     virtual void flush() override;
     virtual size_t write(uint8_t c) override;
     virtual size_t write(const uint8_t *p, size_t len) override;
+    size_t read(uint8_t *p, size_t len); // Non-blocking, returns number of bytes actually read
     using Print::write;
     bool overflow();
     operator bool() override;
@@ -71,6 +74,7 @@ public:
 
     // Not to be called by users, only from the IRQ handler.  In public so that the C-language IQR callback can access it
     void _handleIRQ(bool inIRQ = true);
+    void _handleDMAIRQ();
 
     // Allows the user to sleep until a break is received (self-clears the flag
     // on read)
@@ -91,10 +95,33 @@ private:
     // Lockless, IRQ-handled circular queue
     uint32_t _writer;
     uint32_t _reader;
-    size_t   _fifoSize = 32;
+    size_t   _fifoSize = 32; // As requested by setFIFOSize()
+    size_t   _queueSize;     // Allocated, rounded up to a power of 2 for the RX DMA ring
     uint8_t *_queue;
     mutex_t  _fifoMutex; // Only needed when non-IRQ updates _writer
     void _pumpFIFO(); // User space FIFO transfer
+
+    // Optional ring-mode DMA writing directly into _queue.  _writer is then
+    // recalculated from the DMA progress instead of being set by the IRQ
+    bool     _rxDMAMode = false;
+    int      _rxDMA = -1;
+    volatile uint32_t _rxSeq;  // Odd while the DMA IRQ is restarting the channel
+    volatile uint32_t _rxBase; // Total bytes received as of the last restart
+    uint32_t _rxRead;          // Total bytes read by the app
+    void _syncRXDMA();
+
+    // Optional DMA-drained TX circular queue, written by the app and
+    // only advanced by the DMA completion IRQ
+    size_t   _txFifoSize = 0; // 0 = no TX queue, write directly to the UART
+    uint8_t *_txQueue = nullptr;
+    volatile uint32_t _txWriter;
+    volatile uint32_t _txReader;
+    volatile uint32_t _txInFlight; // Bytes handed to the DMA but not completed yet
+    int      _txDMA = -1;
+    mutex_t  _txMutex; // Guards _txInFlight/DMA restarts between the app and the IRQ on the other core
+    size_t _txFree();
+    void _startTXDMA();
+    void _finishTXDMA();
 };
 
 extern SerialUART Serial1; // HW UART 0
@@ -129,7 +129,7 @@ void noTone(uint8_t pin) {
             entry->second->alarm = 0;
         }
         pio_sm_set_enabled(entry->second->pio, entry->second->sm, false);
-        pio_sm_unclaim(entry->second->pio, entry->second->sm);
+        _tone2Pgm.unprepare(entry->second->pio, entry->second->sm);
         delete entry->second;
         _toneMap.erase(entry);
         pinMode(pin, OUTPUT);
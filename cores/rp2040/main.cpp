@@ -133,8 +133,10 @@ extern "C" int main() {
     if (!__isFreeRTOS) {
         if (setup1 || loop1) {
             rp2040.fifo.begin(2);
+            rp2040.channel.begin(2);
         } else {
             rp2040.fifo.begin(1);
+            rp2040.channel.begin(1);
         }
         rp2040.fifo.registerCore();
     }
@@ -156,6 +158,7 @@ extern "C" int main() {
         }
     } else {
         rp2040.fifo.begin(2);
+        rp2040.channel.begin(2);
         startFreeRTOS();
     }
     return 0;
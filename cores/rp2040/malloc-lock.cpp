@@ -19,20 +19,305 @@
 */
 
 #include <Arduino.h>
+#include <hardware/sync.h>
 
 extern "C" void *__real_malloc(size_t size);
 extern "C" void *__real_calloc(size_t count, size_t size);
 extern "C" void *__real_realloc(void *mem, size_t size);
 extern "C" void __real_free(void *mem);
 
+// Small allocations come from a fixed arena split into pages, each page
+// holding blocks of a single size class.  Each core keeps its own free list
+// per class, only touched by that core with its IRQs briefly disabled, so
+// neither the other core nor the newlib malloc lock is involved on the fast
+// path.  A core holding too many free blocks of a class hands them to a
+// shared, spinlock-protected list the other core can refill from.  Anything
+// too large (or when the arena is full) goes to the newlib heap as before.
+#ifndef MALLOC_POOL_ARENA_SIZE
+#define MALLOC_POOL_ARENA_SIZE (16 * 1024) // Set to 0 to disable the pool
+#endif
+
+#if MALLOC_POOL_ARENA_SIZE > 0
+
+static constexpr size_t _poolPageSize = 512;
+static constexpr size_t _poolPages = MALLOC_POOL_ARENA_SIZE / _poolPageSize;
+static constexpr uint16_t _poolClassSize[] = { 8, 16, 24, 32, 48, 64, 96, 128 };
+static constexpr int _poolClasses = sizeof(_poolClassSize) / sizeof(_poolClassSize[0]);
+static constexpr uint16_t _poolMaxLocal = 32; // Free blocks per class a core keeps before sharing
+
+typedef struct PoolBlock {
+    struct PoolBlock *next;
+} PoolBlock;
+
+// Only ever accessed by its own core
+typedef struct {
+    PoolBlock *free[_poolClasses];
+    uint16_t freeCount[_poolClasses];
+    uint32_t allocs[_poolClasses];
+    uint32_t frees[_poolClasses];
+    uint32_t fallbacks;
+} PoolCache;
+static PoolCache _poolCache[2];
+
+// Shared between cores, guarded by _poolLock
+static uint8_t *_poolArena = nullptr;
+static bool _poolArenaFailed = false;
+static size_t _poolNextPage = 0;
+static uint8_t _poolPageClass[_poolPages];
+static PoolBlock *_poolShared[_poolClasses];
+static uint16_t _poolSharedCount[_poolClasses];
+static int32_t _poolPeak[_poolClasses];
+static spin_lock_t *_poolLock = nullptr;
+// Only used once, to publish the arena and _poolLock when the first malloc runs
+#define _poolInitLock spin_lock_instance(PICO_SPINLOCK_ID_STRIPED_LAST)
+
+static inline int _poolClass(size_t size) {
+    if (!size) {
+        return -1;
+    } else if (size <= 32) {
+        return (size - 1) / 8;
+    } else if (size <= 48) {
+        return 4;
+    } else if (size <= 64) {
+        return 5;
+    } else if (size <= 96) {
+        return 6;
+    } else if (size <= 128) {
+        return 7;
+    }
+    return -1;
+}
+
+static inline bool _poolOwns(void *mem) {
+    return _poolArena && ((uint8_t *)mem >= _poolArena) && ((uint8_t *)mem < _poolArena + _poolPages * _poolPageSize);
+}
+
+static inline int _poolBlockClass(void *mem) {
+    return _poolPageClass[((uint8_t *)mem - _poolArena) / _poolPageSize];
+}
+
+static inline size_t _poolBlockSize(void *mem) {
+    return _poolClassSize[_poolBlockClass(mem)];
+}
+
+static int32_t _poolInUse(int cls) {
+    return (int32_t)(_poolCache[0].allocs[cls] + _poolCache[1].allocs[cls] - _poolCache[0].frees[cls] - _poolCache[1].frees[cls]);
+}
+
+static bool _poolInit() {
+    if (_poolArena) {
+        return true;
+    } else if (_poolArenaFailed) {
+        return false;
+    }
+    noInterrupts();
+    uint8_t *arena = (uint8_t *)__real_malloc(_poolPages * _poolPageSize);
+    interrupts();
+    int lock = spin_lock_claim_unused(false);
+    if (lock < 0) {
+        // All taken, so run without the pool rather than share someone else's
+        noInterrupts();
+        __real_free(arena);
+        interrupts();
+        arena = nullptr;
+    }
+    uint32_t irq = spin_lock_blocking(_poolInitLock);
+    if (!_poolArena && !_poolArenaFailed) {
+        if (arena) {
+            _poolLock = spin_lock_init(lock);
+            lock = -1;
+        }
+        __dmb(); // Lock must be visible before the arena that enables its use
+        _poolArena = arena;
+        _poolArenaFailed = !arena;
+        arena = nullptr;
+    }
+    spin_unlock(_poolInitLock, irq);
+    if (arena) {
+        // Other core beat us to it
+        noInterrupts();
+        __real_free(arena);
+        interrupts();
+    }
+    if (lock >= 0) {
+        spin_lock_unclaim(lock);
+    }
+    return _poolArena != nullptr;
+}
+
+// Called with this core's IRQs disabled
+static void _poolRefill(PoolCache *c, int cls) {
+    uint8_t *page = nullptr;
+    spin_lock_unsafe_blocking(_poolLock);
+    if (_poolShared[cls]) {
+        // Take the whole list the other core gave back
+        c->free[cls] = _poolShared[cls];
+        c->freeCount[cls] = _poolSharedCount[cls];
+        _poolShared[cls] = nullptr;
+        _poolSharedCount[cls] = 0;
+    } else if (_poolNextPage < _poolPages) {
+        _poolPageClass[_poolNextPage] = cls;
+        page = _poolArena + _poolNextPage * _poolPageSize;
+        _poolNextPage++;
+    }
+    spin_unlock_unsafe(_poolLock);
+    if (page) {
+        const size_t sz = _poolClassSize[cls];
+        for (size_t off = 0; off + sz <= _poolPageSize; off += sz) {
+            PoolBlock *b = (PoolBlock *)(page + off);
+            b->next = c->free[cls];
+            c->free[cls] = b;
+            c->freeCount[cls]++;
+        }
+    }
+}
+
+static void *_poolAlloc(int cls) {
+    // The core can only be read once IRQs are off, or a FreeRTOS task could
+    // be moved to the other core and use its list
+    uint32_t irq = save_and_disable_interrupts();
+    PoolCache *c = &_poolCache[get_core_num()];
+    if (!c->free[cls]) {
+        _poolRefill(c, cls);
+    }
+    PoolBlock *b = c->free[cls];
+    if (b) {
+        c->free[cls] = b->next;
+        c->freeCount[cls]--;
+        c->allocs[cls]++;
+        int32_t used = _poolInUse(cls);
+        if (used > _poolPeak[cls]) {
+            _poolPeak[cls] = used; // Racy across cores, only used for statistics
+        }
+    } else {
+        c->fallbacks++;
+    }
+    restore_interrupts(irq);
+    return b;
+}
+
+static void _poolFree(void *mem) {
+    int cls = _poolBlockClass(mem);
+    PoolBlock *b = (PoolBlock *)mem;
+    uint32_t irq = save_and_disable_interrupts();
+    PoolCache *c = &_poolCache[get_core_num()];
+    if (c->freeCount[cls] < _poolMaxLocal) {
+        b->next = c->free[cls];
+        c->free[cls] = b;
+        c->freeCount[cls]++;
+    } else {
+        spin_lock_unsafe_blocking(_poolLock);
+        b->next = _poolShared[cls];
+        _poolShared[cls] = b;
+        _poolSharedCount[cls]++;
+        spin_unlock_unsafe(_poolLock);
+    }
+    c->frees[cls]++;
+    restore_interrupts(irq);
+}
+
+static inline void *_poolMalloc(size_t size) {
+    int cls = _poolClass(size);
+    if ((cls < 0) || !_poolInit()) {
+        return nullptr;
+    }
+    return _poolAlloc(cls);
+}
+
+extern "C" size_t __malloc_pool_arena_size() {
+    return _poolArena ? _poolPages * _poolPageSize : 0;
+}
+
+extern "C" size_t __malloc_pool_used() {
+    size_t used = 0;
+    for (int i = 0; i < _poolClasses; i++) {
+        used += _poolInUse(i) * _poolClassSize[i];
+    }
+    return used;
+}
+
+extern "C" int __malloc_pool_stats(HeapPoolStats *stats, int maxClasses) {
+    int cnt = std::min(maxClasses, _poolClasses);
+    for (int i = 0; i < cnt; i++) {
+        stats[i].size = _poolClassSize[i];
+        stats[i].pages = 0;
+        for (size_t p = 0; p < _poolNextPage; p++) {
+            stats[i].pages += (_poolPageClass[p] == i) ? 1 : 0;
+        }
+        stats[i].inUse = _poolInUse(i);
+        stats[i].peak = _poolPeak[i];
+        stats[i].allocs = _poolCache[0].allocs[i] + _poolCache[1].allocs[i];
+    }
+    return cnt;
+}
+
+extern "C" uint32_t __malloc_pool_fallbacks() {
+    return _poolCache[0].fallbacks + _poolCache[1].fallbacks;
+}
+
+#else
+
+static inline bool _poolOwns(void *mem) {
+    (void) mem;
+    return false;
+}
+
+static inline void *_poolMalloc(size_t size) {
+    (void) size;
+    return nullptr;
+}
+
+static inline void _poolFree(void *mem) {
+    (void) mem;
+}
+
+static inline size_t _poolBlockSize(void *mem) {
+    (void) mem;
+    return 0;
+}
+
+extern "C" size_t __malloc_pool_arena_size() {
+    return 0;
+}
+
+extern "C" size_t __malloc_pool_used() {
+    return 0;
+}
+
+extern "C" int __malloc_pool_stats(HeapPoolStats *stats, int maxClasses) {
+    (void) stats;
+    (void) maxClasses;
+    return 0;
+}
+
+extern "C" uint32_t __malloc_pool_fallbacks() {
+    return 0;
+}
+
+#endif
+
+// Anything not served from the pool still needs newlib's heap, which must
+// not be re-entered from an IRQ on this core
 extern "C" void *__wrap_malloc(size_t size) {
+    void *rc = _poolMalloc(size);
+    if (rc) {
+        return rc;
+    }
     noInterrupts();
-    void *rc = __real_malloc(size);
+    rc = __real_malloc(size);
     interrupts();
     return rc;
 }
 
 extern "C" void *__wrap_calloc(size_t count, size_t size) {
+    size_t total;
+    if (!__builtin_mul_overflow(count, size, &total)) {
+        void *rc = _poolMalloc(total);
+        if (rc) {
+            bzero(rc, total);
+            return rc;
+        }
+    }
     noInterrupts();
     void *rc = __real_calloc(count, size);
     interrupts();
@@ -40,6 +325,20 @@ extern "C" void *__wrap_calloc(size_t count, size_t size) {
 }
 
 extern "C" void *__wrap_realloc(void *mem, size_t size) {
+    if (mem && _poolOwns(mem)) {
+        size_t old = _poolBlockSize(mem);
+        if (size && (size <= old)) {
+            return mem;
+        }
+        void *rc = size ? __wrap_malloc(size) : nullptr;
+        if (rc || !size) {
+            if (rc) {
+                memcpy(rc, mem, old);
+            }
+            _poolFree(mem);
+        }
+        return rc;
+    }
     noInterrupts();
     void *rc = __real_realloc(mem, size);
     interrupts();
@@ -47,6 +346,10 @@ extern "C" void *__wrap_realloc(void *mem, size_t size) {
 }
 
 extern "C" void __wrap_free(void *mem) {
+    if (_poolOwns(mem)) {
+        _poolFree(mem);
+        return;
+    }
     noInterrupts();
     __real_free(mem);
     interrupts();
@@ -0,0 +1,157 @@
+/*
+    PSRAM heap and large buffer placement
+
+    Copyright (c) 2024 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include <pico/mutex.h>
+#include "HeapArena.h"
+
+// Whatever PSRAM the PSRAM section attribute did not claim is handed to a
+// HeapArena the first time it is needed.  The heap is only touched from task
+// context, so a plain mutex guards it on both cores and under FreeRTOS.
+
+static PSRAMPolicy _psramPolicy = PSRAM_POLICY_NEVER;
+static size_t _psramThreshold = 4096;
+
+#if defined(PICO_RP2350) && defined(XIP_RAM_CHIP_SELECT_GPIO)
+extern "C" uint8_t __psram_start__;
+extern "C" uint8_t __psram_heap_start__;
+
+static HeapArena _psramHeap;
+static bool _psramHeapInit = false;
+auto_init_mutex(__psramMutex);
+
+// Call with __psramMutex held
+static bool _psramBegin() {
+    if (!_psramHeapInit) {
+        _psramHeapInit = true;
+        uint8_t *end = &__psram_start__ + _psram_size;
+        if (_psram_size && (end > &__psram_heap_start__)) {
+            _psramHeap.begin(&__psram_heap_start__, end - &__psram_heap_start__);
+        }
+    }
+    return _psramHeap.totalBytes() > 0;
+}
+
+extern "C" void *pmalloc(size_t size) {
+    mutex_enter_blocking(&__psramMutex);
+    void *p = _psramBegin() ? _psramHeap.alloc(size) : nullptr;
+    mutex_exit(&__psramMutex);
+    return p;
+}
+
+extern "C" void *prealloc(void *ptr, size_t size) {
+    mutex_enter_blocking(&__psramMutex);
+    bool mine = _psramBegin() && (!ptr || _psramHeap.owns(ptr));
+    void *p = mine ? _psramHeap.realloc(ptr, size) : nullptr;
+    mutex_exit(&__psramMutex);
+    return mine ? p : realloc(ptr, size);
+}
+
+extern "C" void pfree(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    mutex_enter_blocking(&__psramMutex);
+    bool mine = _psramHeap.owns(ptr);
+    if (mine) {
+        _psramHeap.free(ptr);
+    }
+    mutex_exit(&__psramMutex);
+    if (!mine) {
+        free(ptr);
+    }
+}
+
+extern "C" size_t __psram_heap_size() {
+    mutex_enter_blocking(&__psramMutex);
+    _psramBegin();
+    size_t s = _psramHeap.totalBytes();
+    mutex_exit(&__psramMutex);
+    return s;
+}
+
+extern "C" size_t __psram_heap_used() {
+    mutex_enter_blocking(&__psramMutex);
+    size_t s = _psramHeap.usedBytes();
+    mutex_exit(&__psramMutex);
+    return s;
+}
+
+extern "C" size_t __psram_heap_largest() {
+    mutex_enter_blocking(&__psramMutex);
+    _psramBegin();
+    size_t s = _psramHeap.largestFree();
+    mutex_exit(&__psramMutex);
+    return s;
+}
+
+#else
+
+extern "C" void *pmalloc(size_t size) {
+    (void) size;
+    return nullptr;
+}
+
+extern "C" void *prealloc(void *ptr, size_t size) {
+    return ptr ? realloc(ptr, size) : nullptr;
+}
+
+extern "C" void pfree(void *ptr) {
+    free(ptr);
+}
+
+extern "C" size_t __psram_heap_size() {
+    return 0;
+}
+
+extern "C" size_t __psram_heap_used() {
+    return 0;
+}
+
+extern "C" size_t __psram_heap_largest() {
+    return 0;
+}
+
+#endif
+
+extern "C" void *pcalloc(size_t count, size_t size) {
+    size_t total;
+    if (__builtin_mul_overflow(count, size, &total)) {
+        return nullptr;
+    }
+    void *p = pmalloc(total);
+    if (p) {
+        memset(p, 0, total);
+    }
+    return p;
+}
+
+extern "C" void __psram_set_policy(PSRAMPolicy policy, size_t threshold) {
+    _psramPolicy = policy;
+    _psramThreshold = threshold;
+}
+
+extern "C" void *bufmalloc(size_t size) {
+    void *p = nullptr;
+    if ((_psramPolicy == PSRAM_POLICY_ALWAYS) || ((_psramPolicy == PSRAM_POLICY_LARGE) && (size >= _psramThreshold))) {
+        p = pmalloc(size);
+    }
+    return p ? p : malloc(size);
+}
@@ -22,7 +22,7 @@
 #include <CoreMutex.h>
 #include <hardware/gpio.h>
 #include <hardware/sync.h>
-#include <map>
+#include <hardware/timer.h>
 
 // Support nested IRQ disable/re-enable
 #define maxIRQs 15
@@ -49,58 +49,78 @@ extern "C" void noInterrupts() {
 }
 
 // Only 1 GPIO IRQ callback for all pins, so we need to look at the pin it's for and
-// dispatch to the real callback manually
+// dispatch to the real callback manually.  The table is only written with the mutex
+// held and the pin's IRQ disabled, so the IRQ can read it without taking any lock.
+// The other core may still be in the dispatcher, though, so each entry also has a
+// sequence count that is odd while it's being changed (a seqlock).
 auto_init_mutex(_irqMutex);
-class CBInfo {
-public:
-    CBInfo(voidFuncPtr cb) : _cb(cb), _useParam(false), _param(nullptr) { };
-    CBInfo(voidFuncPtrParam cbParam, void *param) : _cbParam(cbParam), _useParam(true), _param(param) { };
-    void callback() {
-        if (_useParam && _cbParam) {
-            _cbParam(_param);
-        } else if (_cb) {
-            _cb();
-        }
-    }
-private:
+
+typedef enum { CB_NONE, CB_PLAIN, CB_PARAM, CB_RAW } CBType;
+typedef struct {
     union {
-        voidFuncPtr _cb;
-        voidFuncPtrParam _cbParam;
+        voidFuncPtr cb;
+        voidFuncPtrParam cbParam;
+        gpioIRQRawFuncPtr cbRaw;
     };
-    bool _useParam;
-    void *_param;
-};
-
+    void *param;
+    uint8_t type;
+    volatile uint32_t seq;
+} CBInfo;
 
-static std::map<pin_size_t, CBInfo> _map;
+static CBInfo _cbInfo[NUM_BANK0_GPIOS];
 
-void _gpioInterruptDispatcher(uint gpio, uint32_t events) {
-    (void) events;
-    // Only need to lock around the std::map check, not the whole IRQ callback
-    CoreMutex m(&_irqMutex);
-    if (m) {
-        auto irq = _map.find(gpio);
-        if (irq != _map.end()) {
-            auto cb = irq->second;
-            cb.callback();
-        }
+void __not_in_flash_func(_gpioInterruptDispatcher)(uint gpio, uint32_t events) {
+    // Grab the time first so raw callbacks see as little dispatch overhead as possible
+    uint32_t now = time_us_32();
+    if (gpio >= NUM_BANK0_GPIOS) {
+        return;
+    }
+    // Take a consistent copy so the type always matches the callback and param called.
+    // If it changed meanwhile this event raced an attach or detach, so just drop it.
+    CBInfo *irq = &_cbInfo[gpio];
+    uint32_t seq = irq->seq;
+    __dmb();
+    CBInfo cb = *irq;
+    __dmb();
+    if ((seq & 1) || (seq != irq->seq)) {
+        return;
+    }
+    switch (cb.type) {
+    case CB_PLAIN: cb.cb(); break;
+    case CB_PARAM: cb.cbParam(cb.param); break;
+    case CB_RAW:   cb.cbRaw(gpio, events, now, cb.param); break;
+    default:       break;
     }
 }
 
 // To be called when appropriately protected w/IRQ and mutex protects
 static void _detachInterruptInternal(pin_size_t pin) {
-    auto irq = _map.find(pin);
-    if (irq != _map.end()) {
+    CBInfo *irq = &_cbInfo[pin];
+    if (irq->type != CB_NONE) {
         gpio_set_irq_enabled(pin, 0x0f /* all */, false);
-        _map.erase(pin);
+        irq->seq = irq->seq + 1;
+        __dmb();
+        irq->type = CB_NONE;
+        __dmb();
+        irq->seq = irq->seq + 1;
     }
 }
 
-extern "C" void attachInterrupt(pin_size_t pin, voidFuncPtr callback, PinStatus mode) {
+static void _attachInterruptInternal(pin_size_t pin, const CBInfo &cb, PinStatus mode) {
+    if (pin >= NUM_BANK0_GPIOS) {
+        return;
+    }
     CoreMutex m(&_irqMutex);
     if (!m) {
         return;
     }
+    if (!cb.cb) {
+        // attachInterrupt(pin, nullptr, mode) is a detach, not a no-op keeping the old one
+        noInterrupts();
+        _detachInterruptInternal(pin);
+        interrupts();
+        return;
+    }
 
     uint32_t events;
     switch (mode) {
@@ -113,36 +133,46 @@ extern "C" void attachInterrupt(pin_size_t pin, voidFuncPtr callback, PinStatus
     }
     noInterrupts();
     _detachInterruptInternal(pin);
-    CBInfo cb(callback);
-    _map.insert({pin, cb});
+    CBInfo *irq = &_cbInfo[pin];
+    irq->seq = irq->seq + 1;
+    __dmb();
+    irq->cbRaw = cb.cbRaw; // Union, copies whichever one is set
+    irq->param = cb.param;
+    irq->type = cb.type;
+    __dmb(); // Callback must be visible before the count says the entry is stable
+    irq->seq = irq->seq + 1;
     gpio_set_irq_enabled_with_callback(pin, events, true, _gpioInterruptDispatcher);
     interrupts();
 }
 
+extern "C" void attachInterrupt(pin_size_t pin, voidFuncPtr callback, PinStatus mode) {
+    CBInfo cb;
+    cb.cb = callback;
+    cb.param = nullptr;
+    cb.type = CB_PLAIN;
+    _attachInterruptInternal(pin, cb, mode);
+}
+
 void attachInterruptParam(pin_size_t pin, voidFuncPtrParam callback, PinStatus mode, void *param) {
-    CoreMutex m(&_irqMutex);
-    if (!m) {
-        return;
-    }
+    CBInfo cb;
+    cb.cbParam = callback;
+    cb.param = param;
+    cb.type = CB_PARAM;
+    _attachInterruptInternal(pin, cb, mode);
+}
 
-    uint32_t events;
-    switch (mode) {
-    case LOW:     events = 1; break;
-    case HIGH:    events = 2; break;
-    case FALLING: events = 4; break;
-    case RISING:  events = 8; break;
-    case CHANGE:  events = 4 | 8; break;
-    default:      return;  // ERROR
-    }
-    noInterrupts();
-    _detachInterruptInternal(pin);
-    CBInfo cb(callback, param);
-    _map.insert({pin, cb});
-    gpio_set_irq_enabled_with_callback(pin, events, true, _gpioInterruptDispatcher);
-    interrupts();
+void attachInterruptRaw(pin_size_t pin, gpioIRQRawFuncPtr callback, PinStatus mode, void *param) {
+    CBInfo cb;
+    cb.cbRaw = callback;
+    cb.param = param;
+    cb.type = CB_RAW;
+    _attachInterruptInternal(pin, cb, mode);
 }
 
 extern "C" void detachInterrupt(pin_size_t pin) {
+    if (pin >= NUM_BANK0_GPIOS) {
+        return;
+    }
     CoreMutex m(&_irqMutex);
     if (!m) {
         return;
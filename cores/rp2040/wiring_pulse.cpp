@@ -26,7 +26,7 @@ extern "C" unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeo
     uint64_t start = time_us_64();
     uint64_t abort = start + timeout;
 
-    if (pin > 29) {
+    if (pin >= NUM_BANK0_GPIOS) {
         DEBUGCORE("ERROR: Illegal pin in pulseIn (%d)\n", pin);
         return 0;
     }
@@ -0,0 +1,50 @@
+/*
+   Vibration snapshot from a 3-axis analog accelerometer on A0, A1 and A2,
+   plus the chip temperature, once a second.  Each snapshot is a DMA-timed
+   burst of 512 samples per axis at 4kHz, so no CPU time is spent collecting
+   it.  The RMS of each axis is printed once the burst completes.
+   Released to the Public Domain by Earle F. Philhower, III
+*/
+
+#include <ADCInput.h>
+
+#define SAMPLES 512
+
+ADCInput accel(A0, A1, A2);
+
+void setup() {
+  Serial.begin(115200);
+  accel.setTemperature(true);    // 4th channel
+  accel.setBlocks(2, SAMPLES);   // 2 blocks of SAMPLES per channel
+  accel.setOversampling(4);      // Average 4 conversions per sample
+  accel.setFrequency(4000);
+}
+
+void loop() {
+  static uint32_t last = 0;
+  if (millis() - last >= 1000) {
+    last = millis();
+    accel.burst();
+  }
+
+  const uint16_t *block = accel.getBlock();
+  if (block) {
+    for (int c = 0; c < 3; c++) {
+      const uint16_t *s = block + c * SAMPLES;
+      float mean = 0;
+      for (int i = 0; i < SAMPLES; i++) {
+        mean += s[i];
+      }
+      mean /= SAMPLES;
+      float sq = 0;
+      for (int i = 0; i < SAMPLES; i++) {
+        sq += (s[i] - mean) * (s[i] - mean);
+      }
+      Serial.printf("%c: %7.2f  ", 'X' + c, sqrtf(sq / SAMPLES));
+    }
+    // Channel 3 is the temperature sensor, see analogReadTemp() for the conversion
+    float t = 27.0f - ((block[3 * SAMPLES] * 3.3f / 4096.0f) - 0.706f) / 0.001721f;
+    Serial.printf("T: %.1fC\n", t);
+    accel.releaseBlock();
+  }
+}
@@ -23,15 +23,23 @@
 #include <Arduino.h>
 #include "ADCInput.h"
 #include <hardware/adc.h>
+#include <hardware/dma.h>
+#include <hardware/irq.h>
+
+#define TEMP_MASK 0x10 // Round robin bit for the temperature sensor, ADC input 4
+
+ADCInput *ADCInput::_active = nullptr;
 
 ADCInput::ADCInput(pin_size_t p0, pin_size_t p1, pin_size_t p2, pin_size_t p3) {
     _running = false;
+    _pinMask = 0;
     setPins(p0, p1, p2, p3);
     _freq = 48000;
     _arb = nullptr;
     _cb = nullptr;
     _buffers = 8;
     _bufferWords = 0;
+    _hasPeeked = false;
 }
 
 ADCInput::~ADCInput() {
@@ -58,63 +66,156 @@ int ADCInput::_mask(pin_size_t p) {
 }
 
 bool ADCInput::setPins(pin_size_t pin0, pin_size_t pin1, pin_size_t pin2, pin_size_t pin3) {
-    if (_running) {
+    if (_running || _bursting) {
+        return false;
+    }
+    _pinMask = _mask(pin0) | _mask(pin1) | _mask(pin2) | _mask(pin3) | (_pinMask & TEMP_MASK);
+    _freeBlocks();
+    return true;
+}
+
+bool ADCInput::setTemperature(bool enable) {
+    if (_running || _bursting) {
         return false;
     }
-    _pinMask = _mask(pin0) | _mask(pin1) | _mask(pin2) | _mask(pin3);
+    _pinMask = enable ? (_pinMask | TEMP_MASK) : (_pinMask & ~TEMP_MASK);
+    _freeBlocks();
     return true;
 }
 
 bool ADCInput::setFrequency(int newFreq) {
-    _freq = newFreq * __builtin_popcount(_pinMask); // Want to sample all channels at given frequency
-    adc_set_clkdiv(48000000.0f / _freq - 1.0f);
+    _freq = newFreq;
+    _applyFrequency();
     return true;
 }
 
+void ADCInput::_applyFrequency() {
+    // Want to sample all channels, and every oversampled conversion, at the given frequency
+    int conversions = channels() * (_blockSamples ? _oversample : 1);
+    if (!conversions) {
+        return;
+    }
+    float div = 48000000.0f / ((float)_freq * conversions) - 1.0f;
+    adc_set_clkdiv((div < 0) ? 0 : div);
+}
+
 void ADCInput::onReceive(void(*fn)(void)) {
     _cb = fn;
-    if (_running) {
+    if (_running && !_blockSamples) {
         _arb->setCallback(_cb);
     }
 }
 
-bool ADCInput::begin() {
-    if (_running) {
+void ADCInput::onBlock(void (*fn)(const uint16_t *, size_t, void *), void *param) {
+    _blockCBParam = param;
+    _blockCB = fn;
+}
+
+bool ADCInput::setBlocks(size_t blocks, size_t blockSamples) {
+    if (_running || _bursting || (blocks < 2) || !blockSamples) {
         return false;
     }
+    _freeBlocks();
+    _blockCount = blocks;
+    _blockSamples = blockSamples;
+    return true;
+}
 
-    _running = true;
+bool ADCInput::setOversampling(int n) {
+    if (_running || _bursting || (n < 1) || (n > 16)) {
+        return false;
+    }
+    _freeBlocks();
+    _oversample = n;
+    return true;
+}
 
-    _isHolding = 0;
+void ADCInput::_freeBlocks() {
+    free(_blockBuf);
+    _blockBuf = nullptr;
+    free(_burstBuf);
+    _burstBuf = nullptr;
+}
 
-    if (!_bufferWords) {
-        _bufferWords = 16;
+bool ADCInput::_allocBlocks() {
+    if (!_blockBuf) {
+        _blockBuf = (uint16_t *)malloc(_blockCount * channels() * _blockSamples * sizeof(uint16_t));
+        if (!_blockBuf) {
+            return false;
+        }
+        _blockHead = 0;
+        _blockTail = 0;
+        _overruns = 0;
     }
+    // Always start on a fresh block with the first channel
+    _chan = 0;
+    _os = 0;
+    _pos = 0;
+    memset(_acc, 0, sizeof(_acc));
+    return true;
+}
 
+void ADCInput::_setupADC() {
     // Set up the GPIOs to go to ADC
     adc_init();
-    int cnt = 0;
+    int first = -1;
     for (int mask = 1, pin = 26; pin <= 29; mask <<= 1, pin++) {
         if (_pinMask & mask) {
-            if (!cnt) {
-                adc_select_input(pin - 26);
+            if (first < 0) {
+                first = pin - 26;
             }
-            cnt++;
             adc_gpio_init(pin);
         }
     }
+    if (_pinMask & TEMP_MASK) {
+        adc_set_temp_sensor_enabled(true);
+        if (first < 0) {
+            first = 4;
+        }
+        delay(1); // Allow things to settle, like analogReadTemp()
+    }
+    _first = first;
+    adc_select_input(first);
     adc_set_round_robin(_pinMask);
     adc_fifo_setup(true, true, 1, false, false);
 
-    setFrequency(_freq);
+    _applyFrequency();
+}
+
+bool ADCInput::begin() {
+    if (_running || _bursting || !channels()) {
+        return false;
+    }
+
+    if (_blockSamples && !_allocBlocks()) {
+        return false;
+    }
+
+    _running = true;
+
+    _isHolding = 0;
+    _hasPeeked = false;
+
+    if (!_bufferWords) {
+        _bufferWords = 16;
+    }
+
+    _setupADC();
 
     _arb = new AudioBufferManager(_buffers, _bufferWords, 0, INPUT, DMA_SIZE_16);
     if (!_arb->begin(DREQ_ADC, (volatile void*)&adc_hw->fifo)) {
         delete _arb;
         _arb = nullptr;
+        _running = false;
         return false;
     }
-    _arb->setCallback(_cb);
+    if (_blockSamples) {
+        // The IRQ splits every filled DMA buffer into the channel blocks
+        _active = this;
+        _arb->setCallback(_blockIRQ);
+    } else {
+        _arb->setCallback(_cb);
+    }
 
     adc_fifo_drain();
 
@@ -129,12 +230,154 @@ void ADCInput::end() {
         delete _arb;
         _arb = nullptr;
     }
+    if (_burstDMA >= 0) {
+        dma_channel_set_irq0_enabled(_burstDMA, false);
+        dma_channel_abort(_burstDMA);
+        dma_channel_unclaim(_burstDMA);
+        irq_remove_handler(DMA_IRQ_0, _burstIRQ);
+        _burstDMA = -1;
+        _bursting = false;
+    }
     adc_run(false);
     adc_fifo_drain();
+    if (_pinMask & TEMP_MASK) {
+        adc_set_temp_sensor_enabled(false);
+    }
+    if (_active == this) {
+        _active = nullptr;
+    }
+    _freeBlocks();
+}
+
+int ADCInput::availableBlocks() {
+    return _blockHead - _blockTail;
+}
+
+const uint16_t *ADCInput::getBlock() {
+    if (!_blockBuf || (_blockHead == _blockTail)) {
+        return nullptr;
+    }
+    __dmb(); // Block contents must be read after the head that published them
+    return _blockBuf + (_blockTail % _blockCount) * channels() * _blockSamples;
+}
+
+void ADCInput::releaseBlock() {
+    if (_blockHead != _blockTail) {
+        __dmb(); // Done reading before the IRQ can reuse the block
+        _blockTail++;
+    }
+}
+
+// Called once the block being written is complete
+void __not_in_flash_func(ADCInput::_blockDone)() {
+    if (_blockCB) {
+        _blockCB(_blockBuf + (_blockHead % _blockCount) * channels() * _blockSamples, _blockSamples, _blockCBParam);
+    } else if (_blockHead + 1 - _blockTail < _blockCount) {
+        __dmb(); // Contents must be visible before the new head
+        _blockHead++;
+    } else {
+        // No free block, so drop this one and write over it
+        _overruns++;
+    }
+}
+
+// Sorts count round-robin conversions into the channel blocks
+void __not_in_flash_func(ADCInput::_demux)(const uint16_t *s, size_t count) {
+    int chans = channels();
+    while (count--) {
+        _acc[_chan] += *s++ & 0x0fff;
+        if (++_chan == chans) {
+            _chan = 0;
+            if (++_os == _oversample) {
+                _os = 0;
+                uint16_t *blk = _blockBuf + (_blockHead % _blockCount) * chans * _blockSamples;
+                for (int c = 0; c < chans; c++) {
+                    blk[c * _blockSamples + _pos] = (_acc[c] + _oversample / 2) / _oversample;
+                    _acc[c] = 0;
+                }
+                if (++_pos == _blockSamples) {
+                    _pos = 0;
+                    _blockDone();
+                }
+            }
+        }
+    }
+}
+
+void __not_in_flash_func(ADCInput::_blockIRQ)() {
+    ADCInput *a = _active;
+    if (!a || !a->_arb) {
+        return;
+    }
+    size_t words;
+    const uint32_t *w;
+    // Same context as the DMA IRQ that fills them, so no need to sync
+    while ((w = a->_arb->getReadBuffer(&words, false)) != nullptr) {
+        a->_demux((const uint16_t *)w, words * 2);
+        a->_arb->commitReadBuffer(words);
+    }
+    if (a->_cb) {
+        a->_cb();
+    }
+}
+
+bool ADCInput::burst() {
+    if (_running || _bursting || !_blockSamples || !channels()) {
+        return false;
+    }
+    if (!_allocBlocks()) {
+        return false;
+    }
+    size_t conversions = channels() * _blockSamples * _oversample;
+    if (!_burstBuf) {
+        // First burst with these settings
+        _burstBuf = (uint16_t *)malloc(conversions * sizeof(uint16_t));
+        if (!_burstBuf) {
+            return false;
+        }
+        _setupADC();
+    }
+    if (_burstDMA < 0) {
+        _burstDMA = dma_claim_unused_channel(false);
+        if (_burstDMA < 0) {
+            return false;
+        }
+        dma_channel_set_irq0_enabled(_burstDMA, true);
+        irq_add_shared_handler(DMA_IRQ_0, _burstIRQ, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+    }
+    _active = this;
+
+    // Start the round robin from the first channel with an empty FIFO
+    adc_run(false);
+    adc_select_input(_first);
+    adc_fifo_drain();
+
+    dma_channel_config c = dma_channel_get_default_config(_burstDMA);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, DREQ_ADC);
+    _bursting = true;
+    dma_channel_configure(_burstDMA, &c, _burstBuf, &adc_hw->fifo, conversions, true);
+    // From here on the ADC clock paces the conversions and the DMA counts them
+    adc_run(true);
+    return true;
+}
+
+void __not_in_flash_func(ADCInput::_burstIRQ)() {
+    ADCInput *a = _active;
+    if (!a || (a->_burstDMA < 0) || !dma_channel_get_irq0_status(a->_burstDMA)) {
+        return;
+    }
+    dma_channel_acknowledge_irq0(a->_burstDMA);
+    adc_run(false);
+    a->_demux(a->_burstBuf, a->channels() * a->_blockSamples * a->_oversample);
+    a->_bursting = false;
 }
 
 int ADCInput::available() {
-    if (!_running) {
+    if (!_running || _blockSamples) {
         return 0;
     } else {
         return _arb->available();
@@ -142,7 +385,7 @@ int ADCInput::available() {
 }
 
 int ADCInput::read() {
-    if (!_running) {
+    if (!_running || _blockSamples) {
         return -1;
     }
 
@@ -162,8 +405,39 @@ int ADCInput::read() {
     return ret;
 }
 
+size_t ADCInput::read(uint16_t *buffer, size_t samples) {
+    if (!_running || _blockSamples || !samples) {
+        return 0;
+    }
+
+    size_t cnt = 0;
+    // Drain any sample already pulled out of the DMA buffers first
+    while ((_hasPeeked || _isHolding > 0) && (cnt < samples)) {
+        buffer[cnt++] = read();
+    }
+    // Then copy out of the DMA buffers directly, 2 samples per word
+    while (cnt + 1 < samples) {
+        size_t words;
+        auto src = _arb->getReadBuffer(&words, false);
+        if (!src) {
+            break;
+        }
+        words = std::min(words, (samples - cnt) / 2);
+        for (size_t i = 0; i < words; i++) {
+            buffer[cnt++] = src[i] & 0x0fff;
+            buffer[cnt++] = (src[i] >> 16) & 0x0fff;
+        }
+        _arb->commitReadBuffer(words);
+    }
+    // Odd trailing sample needs to split a word
+    if ((cnt < samples) && _arb->available()) {
+        buffer[cnt++] = read();
+    }
+    return cnt;
+}
+
 int ADCInput::peek() {
-    if (!_running) {
+    if (!_running || _blockSamples) {
         return -1;
     }
     if (!_hasPeeked) {
@@ -47,6 +47,9 @@ public:
     virtual int peek() override;
     virtual void flush() override;
 
+    // Read up to samples readings without blocking, returns the number actually read
+    size_t read(uint16_t *buffer, size_t samples);
+
     // from Print, not supported
     virtual size_t write(const uint8_t *buffer, size_t size) override {
         (void) buffer;
@@ -65,6 +68,39 @@ public:
     // should be in RAM, not FLASH, and should be quick to execute.
     void onReceive(void(*)(void));
 
+    // Block mode: instead of interleaved read()s, each channel's samples are
+    // collected into its own array of blockSamples, in IRQ context.  Blocks
+    // come in through onBlock() or getBlock().  Call before begin().
+    bool setBlocks(size_t blocks, size_t blockSamples);
+    // Each block sample averages n (1...16) conversions, the ADC runs n times faster
+    bool setOversampling(int n);
+    // Adds the internal temperature sensor as the last channel
+    bool setTemperature(bool enable);
+
+    // Channel c of a block is at block[c * blockSamples], in pin order
+    int channels() {
+        return __builtin_popcount(_pinMask);
+    }
+    int availableBlocks();
+    // Zero-copy access to the oldest complete block, or nullptr if none.
+    // Call releaseBlock() when done with it.
+    const uint16_t *getBlock();
+    void releaseBlock();
+    // Called in IRQ context with each completed block, which is only valid
+    // until it returns.  Blocks given to the callback never reach getBlock().
+    void onBlock(void (*fn)(const uint16_t *block, size_t blockSamples, void *param), void *param = nullptr);
+    // Blocks lost because getBlock() fell behind
+    uint32_t overruns() {
+        return _overruns;
+    }
+
+    // Captures a single block using DMA and then stops the ADC.  Returns
+    // immediately, the block arrives like any other.  Not with begin().
+    bool burst();
+    bool bursting() {
+        return _bursting;
+    }
+
 private:
     uint32_t _pinMask;
 
@@ -82,6 +118,39 @@ private:
     int _isHolding = 0;
 
     int _mask(pin_size_t pin);
+    void _setupADC();
+    void _applyFrequency();
+    int _first = 0;  // ADC input the round robin starts on
 
     AudioBufferManager *_arb;
+
+    // Block mode
+    size_t _blockCount = 0;
+    size_t _blockSamples = 0;
+    int _oversample = 1;
+    uint16_t *_blockBuf = nullptr;
+    volatile uint32_t _blockHead = 0;  // Blocks completed, written in IRQ only
+    volatile uint32_t _blockTail = 0;  // Blocks released, written by the app only
+    uint32_t _overruns = 0;
+    void (*_blockCB)(const uint16_t *, size_t, void *) = nullptr;
+    void *_blockCBParam = nullptr;
+    // Demultiplexer position
+    int _chan = 0;
+    int _os = 0;
+    size_t _pos = 0;
+    uint32_t _acc[5];
+
+    bool _allocBlocks();
+    void _freeBlocks();
+    void _demux(const uint16_t *s, size_t count);
+    void _blockDone();
+    static void _blockIRQ();
+
+    // Single shot bursts
+    int _burstDMA = -1;
+    uint16_t *_burstBuf = nullptr;
+    volatile bool _bursting = false;
+    static void _burstIRQ();
+
+    static ADCInput *_active;
 };
@@ -25,7 +25,7 @@
 #include "AudioBufferManager.h"
 
 static int                 __channelCount = 0;     // # of channels left.  When we hit 0, then remove our handler
-static AudioBufferManager* __channelMap[12];       // Lets the IRQ handler figure out where to dispatch to
+static AudioBufferManager* __channelMap[NUM_DMA_CHANNELS]; // Lets the IRQ handler figure out where to dispatch to
 static bool                __irqInstalled = false; // Have we put in our IRQ handler yet?
 
 AudioBufferManager::AudioBufferManager(size_t bufferCount, size_t bufferWords, int32_t silenceSample, PinMode direction, enum dma_channel_transfer_size dmaSize) {
@@ -44,25 +44,25 @@ AudioBufferManager::AudioBufferManager(size_t bufferCount, size_t bufferWords, i
     _callback = nullptr;
     _userOff = 0;
 
+    _buffers = new AudioBuffer[bufferCount + 1];
+
     // Create the silence buffer, fill with appropriate value
-    _silence = new AudioBuffer;
-    _silence->next = nullptr;
-    _silence->buff = new uint32_t[_wordsPerBuffer];
+    _silence = bufferCount;
+    // Sample buffers may go to PSRAM, depending on rp2040.setPSRAMPolicy()
+    _buffers[_silence].buff = (uint32_t *)bufmalloc(_wordsPerBuffer * sizeof(uint32_t));
     for (uint32_t x = 0; x < _wordsPerBuffer; x++) {
-        _silence->buff[x] = silenceSample;
+        _buffers[_silence].buff[x] = silenceSample;
     }
 
-    // No filled buffers yet
-    _filled = nullptr;
+    // No filled buffers yet, but need to be able to hold all of them
+    _filled.init(bufferCount);
 
-    // Create all buffers on the empty chain
-    _empty = nullptr;
+    // Create all buffers on the empty ring
+    _empty.init(bufferCount);
     for (size_t i = 0; i < bufferCount; i++) {
-        auto ab = new AudioBuffer;
-        ab->buff = new uint32_t[_wordsPerBuffer];
-        bzero(ab->buff, _wordsPerBuffer * 4);
-        ab->next = nullptr;
-        _addToList(&_empty, ab);
+        _buffers[i].buff = (uint32_t *)bufmalloc(_wordsPerBuffer * sizeof(uint32_t));
+        bzero(_buffers[i].buff, _wordsPerBuffer * 4);
+        _empty.push(i);
     }
 
     _active[0] = _silence;
@@ -81,22 +81,11 @@ AudioBufferManager::~AudioBufferManager() {
         }
     }
     interrupts();
-    for (int i = 0; i < 2; i++) {
-        if (_active[i] != _silence) {
-            _deleteAudioBuffer(_active[i]);
-        }
-    }
-    while (_filled) {
-        auto x = _filled->next;
-        _deleteAudioBuffer(_filled);
-        _filled = x;
-    }
-    while (_empty) {
-        auto x = _empty->next;
-        _deleteAudioBuffer(_empty);
-        _empty = x;
+    // Every buffer, wherever it ended up, is owned by the array
+    for (size_t i = 0; i <= _bufferCount; i++) {
+        pfree(_buffers[i].buff);
     }
-    _deleteAudioBuffer(_silence);
+    delete[] _buffers;
 }
 
 void AudioBufferManager::setCallback(void (*fn)()) {
@@ -133,10 +122,12 @@ bool AudioBufferManager::begin(int dreq, volatile void *pioFIFOAddr) {
         channel_config_set_irq_quiet(&c, false); // Need IRQs
 
         if (_isOutput) {
-            dma_channel_configure(_channelDMA[i], &c, pioFIFOAddr, _silence->buff, _wordsPerBuffer * (_dmaSize == DMA_SIZE_16 ? 2 : 1), false);
+            dma_channel_configure(_channelDMA[i], &c, pioFIFOAddr, _buffers[_silence].buff, _wordsPerBuffer * (_dmaSize == DMA_SIZE_16 ? 2 : 1), false);
         } else {
-            _active[i] = _takeFromList(&_empty);
-            dma_channel_configure(_channelDMA[i], &c, _active[i]->buff, pioFIFOAddr, _wordsPerBuffer * (_dmaSize == DMA_SIZE_16 ? 2 : 1), false);
+            uint16_t idx;
+            _empty.pop(&idx);
+            _active[i] = idx;
+            dma_channel_configure(_channelDMA[i], &c, _buffers[idx].buff, pioFIFOAddr, _wordsPerBuffer * (_dmaSize == DMA_SIZE_16 ? 2 : 1), false);
         }
         dma_channel_set_irq0_enabled(_channelDMA[i], true);
         __channelMap[_channelDMA[i]] = this;
@@ -152,30 +143,39 @@ bool AudioBufferManager::begin(int dreq, volatile void *pioFIFOAddr) {
     return true;
 }
 
-// Following 2 routines use volatile because the IRQ may update the "this"
-// pointer and change the list head while we are waiting.  Volatile will
-// cause GCC to keep re-reading from memory and not use cached value read
-// on the first pass.
+// The ring head/tail are volatile because the IRQ may add buffers while we
+// are waiting, so the busy loops below will keep re-reading from memory.
+
+int AudioBufferManager::_waitForBuffer(BufferRing *ring, bool sync) {
+    int idx = ring->peek();
+    if ((idx < 0) && sync) {
+        while ((idx = ring->peek()) < 0) {
+            /* noop busy wait */
+        }
+    }
+    return idx;
+}
+
+void AudioBufferManager::_advance(BufferRing *from, BufferRing *to, size_t words) {
+    _userOff += words;
+    if (_userOff >= _wordsPerBuffer) {
+        uint16_t idx;
+        from->pop(&idx);
+        to->push(idx);
+        _userOff = 0;
+    }
+}
 
 bool AudioBufferManager::write(uint32_t v, bool sync) {
     if (!_running || !_isOutput) {
         return false;
     }
-    AudioBuffer ** volatile p = (AudioBuffer ** volatile)&_empty;
-    if (!*p) {
-        if (!sync) {
-            return false;
-        } else {
-            while (!*p) {
-                /* noop busy wait */
-            }
-        }
-    }
-    (*p)->buff[_userOff++] = v;
-    if (_userOff == _wordsPerBuffer) {
-        _addToList(&_filled, _takeFromList(p));
-        _userOff = 0;
+    int idx = _waitForBuffer(&_empty, sync);
+    if (idx < 0) {
+        return false;
     }
+    _buffers[idx].buff[_userOff] = v;
+    _advance(&_empty, &_filled, 1);
     return true;
 }
 
@@ -183,24 +183,85 @@ bool AudioBufferManager::read(uint32_t *v, bool sync) {
     if (!_running || _isOutput) {
         return false;
     }
+    int idx = _waitForBuffer(&_filled, sync);
+    if (idx < 0) {
+        return false;
+    }
+    *v = _buffers[idx].buff[_userOff];
+    _advance(&_filled, &_empty, 1);
+    return true;
+}
 
-    AudioBuffer ** volatile p = (AudioBuffer ** volatile)&_filled;
-    if (!*p) {
-        if (!sync) {
-            return false;
-        } else {
-            while (!*p) {
-                /* noop busy wait */
-            }
+uint32_t *AudioBufferManager::getWriteBuffer(size_t *words, bool sync) {
+    *words = 0;
+    if (!_running || !_isOutput) {
+        return nullptr;
+    }
+    int idx = _waitForBuffer(&_empty, sync);
+    if (idx < 0) {
+        return nullptr;
+    }
+    *words = _wordsPerBuffer - _userOff;
+    return _buffers[idx].buff + _userOff;
+}
+
+void AudioBufferManager::commitWriteBuffer(size_t words) {
+    if (!_running || !_isOutput || !_empty.count()) {
+        return;
+    }
+    _advance(&_empty, &_filled, words);
+}
+
+const uint32_t *AudioBufferManager::getReadBuffer(size_t *words, bool sync) {
+    *words = 0;
+    if (!_running || _isOutput) {
+        return nullptr;
+    }
+    int idx = _waitForBuffer(&_filled, sync);
+    if (idx < 0) {
+        return nullptr;
+    }
+    *words = _wordsPerBuffer - _userOff;
+    return _buffers[idx].buff + _userOff;
+}
+
+void AudioBufferManager::commitReadBuffer(size_t words) {
+    if (!_running || _isOutput || !_filled.count()) {
+        return;
+    }
+    _advance(&_filled, &_empty, words);
+}
+
+size_t AudioBufferManager::write(const uint32_t *v, size_t words, bool sync) {
+    size_t written = 0;
+    while (written < words) {
+        size_t avail;
+        uint32_t *dest = getWriteBuffer(&avail, sync);
+        if (!dest) {
+            break;
         }
+        size_t cnt = std::min(avail, words - written);
+        memcpy(dest, v + written, cnt * sizeof(uint32_t));
+        commitWriteBuffer(cnt);
+        written += cnt;
     }
-    auto ret = (*p)->buff[_userOff++];
-    if (_userOff == _wordsPerBuffer) {
-        _addToList(&_empty, _takeFromList(p));
-        _userOff = 0;
+    return written;
+}
+
+size_t AudioBufferManager::read(uint32_t *v, size_t words, bool sync) {
+    size_t readCnt = 0;
+    while (readCnt < words) {
+        size_t avail;
+        const uint32_t *src = getReadBuffer(&avail, sync);
+        if (!src) {
+            break;
+        }
+        size_t cnt = std::min(avail, words - readCnt);
+        memcpy(v + readCnt, src, cnt * sizeof(uint32_t));
+        commitReadBuffer(cnt);
+        readCnt += cnt;
     }
-    *v = ret;
-    return true;
+    return readCnt;
 }
 
 bool AudioBufferManager::getOverUnderflow() {
@@ -210,29 +271,22 @@ bool AudioBufferManager::getOverUnderflow() {
 }
 
 int AudioBufferManager::available() {
-    AudioBuffer *p = _isOutput ? _empty : _filled;
+    if (!_running) {
+        return 0;
+    }
 
-    if (!_running || !p) {
+    size_t cnt = _isOutput ? _empty.count() : _filled.count();
+    if (!cnt) {
         // No buffers available...
         return 0;
     }
 
-    int avail = _wordsPerBuffer - _userOff; // Currently available in this buffer
-
-    // Each add'l buffer has wpb spaces...
-    auto x = p->next;
-    while (x) {
-        avail += _wordsPerBuffer;
-        x = x->next;
-    }
-    return avail;
+    // Each buffer has wpb spaces, less what's been used in the current one
+    return cnt * _wordsPerBuffer - _userOff;
 }
 
 void AudioBufferManager::flush() {
-    AudioBuffer ** volatile a = (AudioBuffer ** volatile)&_active[0];
-    AudioBuffer ** volatile b = (AudioBuffer ** volatile)&_active[1];
-    AudioBuffer ** volatile c = (AudioBuffer ** volatile)&_filled;
-    while (*c && (*b != (AudioBuffer * volatile)_silence) && (*a != (AudioBuffer * volatile)_silence)) {
+    while (_filled.count() && (_active[1] != _silence) && (_active[0] != _silence)) {
         // busy wait until all user written data enroute
     }
 }
@@ -243,25 +297,26 @@ void __not_in_flash_func(AudioBufferManager::_dmaIRQ)(int channel) {
     }
     if (_isOutput) {
         if (_active[0] != _silence) {
-            _addToList(&_empty, _active[0]);
+            _empty.push(_active[0]);
         }
         _active[0] = _active[1];
-        if (!_filled) {
-            _active[1] = _silence;
-        } else {
-            _active[1] = _takeFromList(&_filled);
+        uint16_t idx;
+        if (!_filled.pop(&idx)) {
+            idx = _silence;
+            _overunderflow = true;
         }
-        _overunderflow = _overunderflow | (_active[1] == _silence);
-        dma_channel_set_read_addr(channel, _active[1]->buff, false);
+        _active[1] = idx;
+        dma_channel_set_read_addr(channel, _buffers[idx].buff, false);
     } else {
-        if (_empty) {
-            _addToList(&_filled, _active[0]);
+        uint16_t idx;
+        if (_empty.pop(&idx)) {
+            _filled.push(_active[0]);
             _active[0] = _active[1];
-            _active[1] = _takeFromList(&_empty);
+            _active[1] = idx;
         } else {
             _overunderflow = true;
         }
-        dma_channel_set_write_addr(channel, _active[1]->buff, false);
+        dma_channel_set_write_addr(channel, _buffers[_active[1]].buff, false);
     }
     dma_channel_set_trans_count(channel, _wordsPerBuffer * (_dmaSize == DMA_SIZE_16 ? 2 : 1), false);
     dma_channel_acknowledge_irq0(channel);
@@ -271,7 +326,7 @@ void __not_in_flash_func(AudioBufferManager::_dmaIRQ)(int channel) {
 }
 
 void __not_in_flash_func(AudioBufferManager::_irq)() {
-    for (size_t i = 0; i < sizeof(__channelMap); i++) {
+    for (size_t i = 0; i < NUM_DMA_CHANNELS; i++) {
         if (dma_channel_get_irq0_status(i) && __channelMap[i]) {
             __channelMap[i]->_dmaIRQ(i);
         }
@@ -22,6 +22,8 @@
 #pragma once
 #include <Arduino.h>
 #include <hardware/dma.h>
+#include <hardware/sync.h>
+#include "AudioBufferRing.h"
 
 class AudioBufferManager {
 public:
@@ -36,6 +38,19 @@ public:
     bool read(uint32_t *v, bool sync = true);
     void flush();
 
+    // Bulk copies, return the number of words actually transferred
+    size_t write(const uint32_t *v, size_t words, bool sync = true);
+    size_t read(uint32_t *v, size_t words, bool sync = true);
+
+    // Zero-copy access to the current user buffer.  get*Buffer() returns a
+    // pointer to the remaining span of the buffer (and its size in words),
+    // or nullptr if none is ready.  After filling/consuming some or all of
+    // it, call commit*Buffer() with the number of words processed.
+    uint32_t *getWriteBuffer(size_t *words, bool sync = true);
+    void commitWriteBuffer(size_t words);
+    const uint32_t *getReadBuffer(size_t *words, bool sync = true);
+    void commitReadBuffer(size_t words);
+
     bool getOverUnderflow();
     int available();
 
@@ -44,47 +59,25 @@ private:
     static void _irq();
 
     typedef struct AudioBuffer {
-        struct AudioBuffer *next;
         uint32_t *buff;
     } AudioBuffer;
 
+    // Each ring is only ever pushed by one of the DMA IRQ or the user app and
+    // popped by the other, so no interrupt masking or locking is needed.
+    typedef AudioBufferRing BufferRing;
+
     bool _running = false;
 
-    AudioBuffer *_silence = nullptr; // A single silence buffer to be looped on underflow
-    AudioBuffer *_filled = nullptr;  // List of buffers ready to be played
-    AudioBuffer *_empty = nullptr;   // List of buffers waiting to be filled. *_empty = currently writing
-    AudioBuffer *_active[2] = { nullptr, nullptr }; // The 2 buffers currently in use for DMA
-
-    // Can't use std::list because we need to put in RAM for IRQ use, so roll our own
-    void __not_in_flash_func(_addToList)(AudioBuffer **list, AudioBuffer *element) {
-        noInterrupts();
-        // Find end of list, if any
-        while ((*list) && ((*list)->next != nullptr)) {
-            list = &(*list)->next;
-        }
-        if (*list) {
-            (*list)->next = element;
-        } else {
-            *list = element;
-        }
-        element->next = nullptr; // Belt and braces
-        interrupts();
-    }
-
-    AudioBuffer *__not_in_flash_func(_takeFromList)(AudioBuffer **list) {
-        noInterrupts();
-        auto ret = *list;
-        if (ret) {
-            *list = ret->next;
-        }
-        interrupts();
-        return ret;
-    }
-
-    void _deleteAudioBuffer(AudioBuffer *ab) {
-        delete[] ab->buff;
-        delete ab;
-    }
+    AudioBuffer *_buffers = nullptr; // All buffers, with the last one being a silence buffer to be looped on underflow
+    uint16_t _silence;               // Index of the silence buffer
+    BufferRing _filled;              // Buffers ready to be played
+    BufferRing _empty;               // Buffers waiting to be filled. Head of _empty = currently writing
+    volatile uint16_t _active[2];    // The 2 buffers currently in use for DMA
+
+    // Wait (if sync) for a buffer at the head of the ring, -1 if none
+    int _waitForBuffer(BufferRing *ring, bool sync);
+    // Consume words of the head buffer, moving it to the other ring once finished
+    void _advance(BufferRing *from, BufferRing *to, size_t words);
 
     int _bitsPerSample;
     size_t _wordsPerBuffer;
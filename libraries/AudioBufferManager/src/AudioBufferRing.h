@@ -0,0 +1,97 @@
+/*
+    AudioBufferRing - SPSC index ring used by AudioBufferManager
+
+    Copyright (c) 2024 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#ifdef ARDUINO_ARCH_RP2040
+#include <pico.h>
+#include <hardware/sync.h>
+#else
+// Allow building under tests/host
+#define __not_in_flash_func(x) x
+static inline void __dmb() {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+#endif
+
+// Fixed-capacity single-producer/single-consumer ring of buffer indices.
+// Each ring is only ever pushed by one of the DMA IRQ or the user app and
+// popped by the other, so no interrupt masking or locking is needed.
+// Needs to live in RAM for IRQ use, so no std:: containers.
+class AudioBufferRing {
+public:
+    ~AudioBufferRing() {
+        delete[] _idx;
+    }
+
+    void init(size_t count) {
+        delete[] _idx;
+        _size = count + 1; // One slot always left open to tell full from empty
+        _idx = new uint16_t[_size];
+        _head = 0;
+        _tail = 0;
+    }
+
+    bool __not_in_flash_func(push)(uint16_t i) {
+        size_t t = _tail;
+        size_t n = (t + 1 == _size) ? 0 : t + 1;
+        if (n == _head) {
+            return false;
+        }
+        _idx[t] = i;
+        __dmb(); // Entry must be visible before the new tail
+        _tail = n;
+        return true;
+    }
+
+    bool __not_in_flash_func(pop)(uint16_t *i) {
+        size_t h = _head;
+        if (h == _tail) {
+            return false;
+        }
+        *i = _idx[h];
+        __dmb(); // Entry must be read before the slot is released
+        _head = (h + 1 == _size) ? 0 : h + 1;
+        return true;
+    }
+
+    // Returns the index at the head without removing it, or -1 if empty
+    int __not_in_flash_func(peek)() {
+        size_t h = _head;
+        if (h == _tail) {
+            return -1;
+        }
+        __dmb();
+        return _idx[h];
+    }
+
+    size_t __not_in_flash_func(count)() {
+        size_t h = _head;
+        size_t t = _tail;
+        return (t >= h) ? t - h : _size - h + t;
+    }
+
+private:
+    uint16_t *_idx = nullptr;
+    size_t _size = 0;
+    volatile size_t _head = 0; // Only written by the consumer
+    volatile size_t _tail = 0; // Only written by the producer
+};
@@ -118,12 +118,8 @@ bool EEPROMClass::commit() {
         return false;
     }
 
-    noInterrupts();
-    rp2040.idleOtherCore();
-    flash_range_erase((intptr_t)_sector - (intptr_t)XIP_BASE, 4096);
-    flash_range_program((intptr_t)_sector - (intptr_t)XIP_BASE, _data, _size);
-    rp2040.resumeOtherCore();
-    interrupts();
+    rp2040.flashErase((intptr_t)_sector - (intptr_t)XIP_BASE, 4096);
+    rp2040.flashProgram((intptr_t)_sector - (intptr_t)XIP_BASE, _data, _size);
     _dirty = false;
 
     return true;
@@ -221,25 +221,28 @@ DSTATUS disk_initialize(BYTE p) {
 
 DRESULT disk_read(BYTE p, BYTE *buff, LBA_t sect, UINT count) {
     (void) p;
+    if (!_ftl) {
+        // Raw flash is memory mapped, so any run of sectors is one copy
+        memcpy(buff, &_FS_start + sect * _sectorSize, count * _sectorSize);
+        return RES_OK;
+    }
     for (unsigned int i = 0; i < count; i++) {
-        if (_ftl) {
-            _ftl->read(sect + i, buff + i * _sectorSize);
-        } else {
-            _fi->read(sect + i, 0, buff, _sectorSize);
-        }
+        _ftl->read(sect + i, buff + i * _sectorSize);
     }
     return RES_OK;
 }
 
 DRESULT disk_write(BYTE pdrv, const BYTE* buff, LBA_t sector, UINT count) {
     (void) pdrv;
+    if (!_ftl) {
+        // Erase and program the whole run at once instead of sector by sector
+        uint32_t addr = (intptr_t)(&_FS_start + sector * _sectorSize) - (intptr_t)XIP_BASE;
+        rp2040.flashErase(addr, count * _sectorSize);
+        rp2040.flashProgram(addr, buff, count * _sectorSize);
+        return RES_OK;
+    }
     for (unsigned int i = 0; i < count; i++) {
-        if (_ftl) {
-            _ftl->write(sector + i, buff + i * _sectorSize);
-        } else {
-            _fi->eraseBlock(sector + i);
-            _fi->program(sector + i, 0, buff + i * _sectorSize, _sectorSize);
-        }
+        _ftl->write(sector + i, buff + i * _sectorSize);
     }
     return RES_OK;
 }
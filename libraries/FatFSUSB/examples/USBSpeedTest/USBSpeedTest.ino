@@ -0,0 +1,68 @@
+// Measures FatFSUSB READ10/WRITE10 throughput by calling the handlers exactly
+// as the TinyUSB mass storage class does, without needing a host PC
+// Released to the public domain
+//
+// WARNING:  This overwrites the FatFS drive contents and reformats it at the end!
+
+#include <FatFS.h>
+#include <FatFSUSB.h>
+
+#define TESTKB 256
+
+uint8_t buff[4096];
+
+// Transfer TESTKB through read10 or write10 in "chunk" byte pieces, like the MSC class does
+void run(bool write, uint32_t chunk) {
+  uint32_t count;
+  uint16_t size;
+  FatFSUSB.capacity(&count, &size);
+  uint32_t sects = std::min((uint32_t)(TESTKB * 1024 / size), count);
+  uint32_t start = micros();
+  for (uint32_t lba = 0; lba < sects;) {
+    // TinyUSB passes the LBA the transfer started at plus the byte offset reached so far
+    uint32_t xfer = std::min((uint32_t)(16 * size), (sects - lba) * size);
+    for (uint32_t off = 0; off < xfer; off += chunk) {
+      if (write) {
+        FatFSUSB.write10(lba, off, buff, chunk);
+      } else {
+        FatFSUSB.read10(lba, off, buff, chunk);
+      }
+    }
+    lba += xfer / size;
+  }
+  uint32_t us = micros() - start;
+  Serial.printf("%-5s %4lu byte chunks: %lu KB in %lu ms = %0.2f MB/s\n", write ? "WRITE" : "READ", chunk,
+                sects * size / 1024, us / 1000, (float)(sects * size) / us);
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    delay(1);
+  }
+  delay(5000);
+
+  if (!FatFS.begin()) {
+    Serial.println("FatFS initialization failed!");
+    while (1) {
+      delay(1);
+    }
+  }
+  FatFS.end();
+  FatFSUSB.begin();
+
+  memset(buff, 0xa5, sizeof(buff));
+  // 64 bytes is the MSC endpoint buffer size the core is built with
+  run(true, 64);
+  run(false, 64);
+  // Larger endpoint buffers can move whole sectors at once
+  run(true, 4096);
+  run(false, 4096);
+
+  FatFSUSB.end();
+  FatFS.format();
+  Serial.println("Done, drive reformatted");
+}
+
+void loop() {
+}
@@ -20,6 +20,7 @@
 #include "FatFSUSB.h"
 #include <FatFS.h>
 #include <class/msc/msc.h>
+#include <algorithm>
 
 FatFSUSBClass FatFSUSB;
 
@@ -59,14 +60,19 @@ bool FatFSUSBClass::begin() {
     fatfs::WORD ss;
     fatfs::disk_ioctl(0, GET_SECTOR_SIZE, &ss);
     _sectSize = ss;
+    fatfs::LBA_t p;
+    fatfs::disk_ioctl(0, GET_SECTOR_COUNT, &p);
+    _sectCount = p;
     _sectBuff = new uint8_t[_sectSize];
     _sectNum = -1;
+    _sectDirty = false;
     return true;
 }
 
 void FatFSUSBClass::end() {
     if (_started) {
         _started = false;
+        _flushSect();
         delete[] _sectBuff;
     }
 }
@@ -110,12 +116,33 @@ extern "C" bool tud_msc_test_unit_ready_cb(uint8_t lun) {
 // Application update block count and block size
 extern "C" void tud_msc_capacity_cb(uint8_t lun, uint32_t* block_count, uint16_t* block_size) {
     (void) lun;
-    fatfs::LBA_t p;
-    fatfs::disk_ioctl(0, GET_SECTOR_COUNT, &p);
-    *block_count = p;
-    fatfs::WORD ss;
-    fatfs::disk_ioctl(0, GET_SECTOR_SIZE, &ss);
-    *block_size  = ss;
+    FatFSUSB.capacity(block_count, block_size);
+}
+
+void FatFSUSBClass::capacity(uint32_t *count, uint16_t *size) {
+    *count = _sectCount;
+    *size = _sectSize;
+}
+
+// Write out any partial sector the host left in _sectBuff
+void FatFSUSBClass::_flushSect() {
+    if (_sectDirty) {
+        fatfs::disk_write(0, _sectBuff, _sectNum, 1);
+        _sectDirty = false;
+    }
+}
+
+// Make _sectBuff hold sector lba, so the host's sub-sector transfers only hit flash once per sector
+bool FatFSUSBClass::_loadSect(uint32_t lba) {
+    if ((int32_t)lba != _sectNum) {
+        _flushSect();
+        if (fatfs::disk_read(0, _sectBuff, lba, 1) != fatfs::RES_OK) {
+            _sectNum = -1;
+            return false;
+        }
+        _sectNum = lba;
+    }
+    return true;
 }
 
 
@@ -127,23 +154,41 @@ extern "C" int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset,
 }
 
 int32_t FatFSUSBClass::read10(uint32_t lba, uint32_t offset, void* buffer, uint32_t bufsize) {
-    fatfs::LBA_t _hddsects;
-    fatfs::disk_ioctl(0, GET_SECTOR_COUNT, &_hddsects);
-
-    if (!_started || (lba >= _hddsects)) {
+    if (!_started) {
         return -1;
     }
 
-    assert(offset + bufsize <= _sectSize);
-
-    if (_sectNum >= 0) {
-        // Flush the temp data out, we need to use the space
-        fatfs::disk_write(0, _sectBuff, _sectNum, 1);
-        _sectNum = -1;
+    uint8_t *dst = (uint8_t *)buffer;
+    uint32_t done = 0;
+    lba += offset / _sectSize;
+    offset %= _sectSize;
+    while (done < bufsize) {
+        if (lba >= _sectCount) {
+            return done ? (int32_t)done : -1;
+        }
+        uint32_t sects = std::min((bufsize - done) / _sectSize, _sectCount - lba);
+        if (!offset && sects) {
+            // Whole sectors go straight into the USB buffer
+            if ((_sectNum >= (int32_t)lba) && (_sectNum < (int32_t)(lba + sects))) {
+                _flushSect();
+            }
+            if (fatfs::disk_read(0, dst + done, lba, sects) != fatfs::RES_OK) {
+                return -1;
+            }
+            done += sects * _sectSize;
+            lba += sects;
+            continue;
+        }
+        if (!_loadSect(lba)) {
+            return -1;
+        }
+        uint32_t len = std::min(bufsize - done, _sectSize - offset);
+        memcpy(dst + done, _sectBuff + offset, len);
+        done += len;
+        lba++;
+        offset = 0;
     }
-    fatfs::disk_read(0, _sectBuff, lba, 1);
-    memcpy(buffer, _sectBuff + offset, bufsize);
-    return bufsize;
+    return done;
 }
 
 extern "C" bool tud_msc_is_writable_cb(uint8_t lun) {
@@ -160,38 +205,46 @@ extern "C" int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset
 }
 
 int32_t FatFSUSBClass::write10(uint32_t lba, uint32_t offset, uint8_t* buffer, uint32_t bufsize) {
-    fatfs::LBA_t _hddsects;
-    fatfs::disk_ioctl(0, GET_SECTOR_COUNT, &_hddsects);
-
-    if (!_started || (lba >= _hddsects)) {
+    if (!_started) {
         return -1;
     }
 
-    assert(offset + bufsize <= _sectSize);
-
-    if ((offset == 0) && (bufsize == _sectSize)) {
-        fatfs::disk_write(0, buffer, lba, 1);
-        return _sectSize;
-    }
-
-    if ((int)_sectNum == (int)lba) {
-        memcpy(_sectBuff + offset, buffer, bufsize);
-    } else {
-        if (_sectNum >= 0) {
-            // Need to flush old sector out
-            fatfs::disk_write(0, _sectBuff, _sectNum, 1);
+    uint32_t done = 0;
+    lba += offset / _sectSize;
+    offset %= _sectSize;
+    while (done < bufsize) {
+        if (lba >= _sectCount) {
+            return done ? (int32_t)done : -1;
         }
-        fatfs::disk_read(0, _sectBuff, lba, 1);
-        memcpy(_sectBuff + offset, buffer, bufsize);
-        _sectNum = lba;
-    }
-
-    if (offset + bufsize >= _sectSize) {
-        // We've filled up a sector, write it out!
-        fatfs::disk_write(0, _sectBuff, lba, 1);
-        _sectNum = -1;
+        uint32_t sects = std::min((bufsize - done) / _sectSize, _sectCount - lba);
+        if (!offset && sects) {
+            // Whole sectors go straight from the USB buffer to the disk
+            if ((_sectNum >= (int32_t)lba) && (_sectNum < (int32_t)(lba + sects))) {
+                _sectNum = -1; // About to be completely overwritten
+                _sectDirty = false;
+            }
+            if (fatfs::disk_write(0, buffer + done, lba, sects) != fatfs::RES_OK) {
+                return -1;
+            }
+            done += sects * _sectSize;
+            lba += sects;
+            continue;
+        }
+        if (!_loadSect(lba)) {
+            return -1;
+        }
+        uint32_t len = std::min(bufsize - done, _sectSize - offset);
+        memcpy(_sectBuff + offset, buffer + done, len);
+        _sectDirty = true;
+        if (offset + len == _sectSize) {
+            // We've filled up a sector, write it out!
+            _flushSect();
+        }
+        done += len;
+        lba++;
+        offset = 0;
     }
-    return bufsize;
+    return done;
 }
 
 extern "C" bool tud_msc_set_sense(uint8_t lun, uint8_t sense_key, uint8_t add_sense_code, uint8_t add_sense_qualifier);
@@ -252,18 +305,18 @@ extern "C" int32_t tud_msc_scsi_cb(uint8_t lun, uint8_t const scsi_cmd[16], void
 }
 
 void FatFSUSBClass::plug() {
-    if (_started && _cbPlug) {
-        _cbPlug(_cbPlugData);
+    if (_started) {
+        _sectNum = -1; // The Pico may have changed the disk since we last looked
+        if (_cbPlug) {
+            _cbPlug(_cbPlugData);
+        }
     }
 }
 
 void FatFSUSBClass::unplug() {
     if (_started) {
-        if (_sectNum >= 0) {
-            // Flush the temp data out
-            fatfs::disk_write(0, _sectBuff, _sectNum, 1);
-            _sectNum = -1;
-        }
+        _flushSect();
+        _sectNum = -1;
         fatfs::disk_ioctl(0, CTRL_SYNC, nullptr);
         if (_cbUnplug) {
             _cbUnplug(_cbUnplugData);
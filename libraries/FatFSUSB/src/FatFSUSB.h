@@ -39,13 +39,21 @@ public:
     int32_t write10(uint32_t lba, uint32_t offset, uint8_t* buffer, uint32_t bufsize);
     void plug();;
     void unplug();
+    void capacity(uint32_t *count, uint16_t *size);
 
 private:
+    void _flushSect();
+    bool _loadSect(uint32_t lba);
+
     bool _started = false;
 
+    // _sectBuff holds sector _sectNum (or -1 if none), and _sectDirty is set when it has
+    // partial writes from the host which have not been written to flash yet
     int32_t _sectNum = -1;
+    bool _sectDirty = false;
     uint8_t *_sectBuff = nullptr;
     uint16_t _sectSize = 0;
+    uint32_t _sectCount = 0;
 
     void (*_cbPlug)(uint32_t) = nullptr;
     uint32_t _cbPlugData = 0;
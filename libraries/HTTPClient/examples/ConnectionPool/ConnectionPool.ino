@@ -0,0 +1,57 @@
+// Shows how an HTTPConnectionPool lets HTTPClient objects share keep-alive
+// connections, skipping new TCP connections and TLS handshakes
+//
+// Released to the public domain
+
+#include <WiFi.h>
+#include <HTTPClient.h>
+
+#ifndef STASSID
+#define STASSID "your-ssid"
+#define STAPSK "your-password"
+#endif
+
+const char *urls[] = {
+  "https://jigsaw.w3.org/HTTP/connection.html",
+  "https://www.w3.org/robots.txt",
+  "https://jigsaw.w3.org/HTTP/ChunkedScript",
+  "https://www.w3.org/robots.txt",
+};
+
+HTTPConnectionPool pool;
+
+void setup() {
+  Serial.begin(115200);
+  delay(5000);
+
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(STASSID, STAPSK);
+  while (WiFi.status() != WL_CONNECTED) {
+    Serial.print(".");
+    delay(500);
+  }
+  Serial.println(" connected to WiFi");
+
+  for (int pass = 0; pass < 3; pass++) {
+    for (auto url : urls) {
+      // A new HTTPClient each time, the connection lives on in the pool
+      HTTPClient https;
+      https.setInsecure();
+      https.setConnectionPool(&pool);
+      https.begin(url);
+      uint32_t start = millis();
+      int code = https.GET();
+      if (code > 0) {
+        int len = https.getString().length();
+        Serial.printf("%s: %d, %d bytes in %lu ms\n", url, code, len, millis() - start);
+      } else {
+        Serial.printf("%s: %s\n", url, https.errorToString(code).c_str());
+      }
+      https.end();
+    }
+  }
+  Serial.printf("Connections reused: %lu, created: %lu\n", pool.reused(), pool.created());
+}
+
+void loop() {
+}
@@ -161,6 +161,7 @@ bool HTTPClient::begin(String url) {
 bool HTTPClient::begin(String host, uint16_t port, String uri, bool https) {
     // Disconnect when reusing HTTPClient to talk to a different host
     if (_host != host) {
+        releaseToPool(false);
         _canReuse = false;
         disconnect(true);
     }
@@ -208,6 +209,7 @@ bool HTTPClient::begin(WiFiClient &client, const String& url) {
 
     _port = (protocol == "https" ? 443 : 80);
     _secure = (protocol == "https");
+    releaseToPool(true); // Our own client is going away
     _clientIn = client.clone();
     _clientGiven = true;
     if (_clientMade) {
@@ -230,6 +232,8 @@ bool HTTPClient::begin(WiFiClient &client, const String& url) {
     @return success bool
 */
 bool HTTPClient::begin(WiFiClient &client, const String& host, uint16_t port, const String& uri, bool https) {
+    releaseToPool(true); // Our own client is going away
+
     // Disconnect when reusing HTTPClient to talk to a different host
     if ((_host != "") && (_host != host)) {
         _canReuse = false;
@@ -312,6 +316,7 @@ bool HTTPClient::beginInternal(const String& __url, const char* expectedProtocol
 
     // Disconnect when reusing HTTPClient to talk to a different host
     if (oldHost != "" && _host != oldHost) {
+        releaseToPool(false);
         _canReuse = false;
         disconnect(true);
     }
@@ -332,8 +337,11 @@ bool HTTPClient::beginInternal(const String& __url, const char* expectedProtocol
     called after the payload is handled
 */
 void HTTPClient::end(void) {
+    releaseToPool(true);
     disconnect(false);
     clear();
+    delete _clientPooled;
+    _clientPooled = nullptr;
     if (_clientMade) {
         delete _clientMade;
         _clientMade = nullptr;
@@ -362,6 +370,8 @@ void HTTPClient::disconnect(bool preserveClient) {
                 _client()->stop();
                 if (!preserveClient) {
                     _clientIn = nullptr;
+                    delete _clientPooled;
+                    _clientPooled = nullptr;
                     if (_clientMade) {
                         delete _clientMade;
                         _clientMade = nullptr;
@@ -373,6 +383,8 @@ void HTTPClient::disconnect(bool preserveClient) {
     } else {
         if (!preserveClient && _client()) { // Also destroy _client if not connected()
             _clientIn = nullptr;
+            delete _clientPooled;
+            _clientPooled = nullptr;
             if (_clientMade) {
                 delete _clientMade;
                 _clientMade = nullptr;
@@ -404,6 +416,45 @@ void HTTPClient::setReuse(bool reuse) {
     _reuse = reuse;
 }
 
+/**
+    park keep-alive connections in a pool on end() or host change, and take
+    matching ones from it instead of connecting again
+    @param pool HTTPConnectionPool *, nullptr to stop using a pool
+*/
+void HTTPClient::setConnectionPool(HTTPConnectionPool *pool) {
+    _pool = pool;
+}
+
+/**
+    hand the current connection to the pool if it can be reused
+    @param all bool  also give away the client this object made itself.  For
+                     TLS that client holds the trust settings, so only do so
+                     when it is about to be deleted anyway.
+*/
+void HTTPClient::releaseToPool(bool all) {
+    bool reusable = _pool && !_clientGiven && _reuse && _canReuse && connected();
+    if (_clientPooled) {
+        if (reusable) {
+            _pool->park(_connHost, _connPort, _pooledTLS, _clientPooled);
+        } else {
+            _clientPooled->stop();
+            delete _clientPooled;
+        }
+        _clientPooled = nullptr;
+    } else if (reusable && _clientMade && (all || !_clientTLS)) {
+        _pool->park(_connHost, _connPort, _clientTLS, _clientMade);
+        if (all) {
+            _clientMade = nullptr;
+            _clientTLS = false;
+        } else {
+            _clientMade = new WiFiClient();
+        }
+    } else {
+        return;
+    }
+    _canReuse = false;
+}
+
 /**
     set User Agent
     @param userAgent const char
@@ -473,6 +524,7 @@ bool HTTPClient::setURL(const String& url) {
         return false;
     }
     // disconnect but preserve _client (clear _canReuse so disconnect will close the connection)
+    releaseToPool(false);
     _canReuse = false;
     disconnect(true);
     return beginInternal(url, nullptr);
@@ -813,17 +865,10 @@ int HTTPClient::writeToPrint(Print * print) {
             if (!connected()) {
                 return returnError(HTTPC_ERROR_CONNECTION_LOST);
             }
-            String chunkHeader = _client()->readStringUntil('\n');
-
-            if (chunkHeader.length() <= 0) {
+            len = readChunkSize();
+            if (len < 0) {
                 return returnError(HTTPC_ERROR_READ_TIMEOUT);
             }
-
-            chunkHeader.trim(); // remove \r
-            DEBUG_HTTPCLIENT("[HTTP-Client] chunk header: '%s'\n", chunkHeader.c_str());
-
-            // read size of chunk
-            len = (uint32_t) strtol((const char *) chunkHeader.c_str(), nullptr, 16);
             size += len;
             DEBUG_HTTPCLIENT("[HTTP-Client] read chunk len: %d\n", len);
 
@@ -841,6 +886,15 @@ int HTTPClient::writeToPrint(Print * print) {
                 ret += r;
             } else {
 
+                // skip any trailer headers up to the final empty line
+                int trailer;
+                while ((trailer = skipLine()) > 0) {
+                    /* Nothing */
+                }
+                if (trailer < 0) {
+                    return returnError(HTTPC_ERROR_READ_TIMEOUT);
+                }
+
                 // if no length Header use global chunk size
                 if (_size <= 0) {
                     _size = size;
@@ -868,6 +922,60 @@ int HTTPClient::writeToPrint(Print * print) {
     return ret;
 }
 
+/**
+    read a chunk-size line ("1a2b;ext=x\r\n") without building a String
+    @return chunk length, or -1 on timeout or a malformed line
+*/
+int HTTPClient::readChunkSize() {
+    int len = 0;
+    int digits = 0;
+    bool ext = false;
+    while (true) {
+        char c;
+        if (_client()->readBytes(&c, 1) != 1) {
+            return -1;
+        }
+        if (c == '\n') {
+            break;
+        } else if (ext || (c == '\r')) {
+            continue;
+        }
+        int v;
+        if ((c >= '0') && (c <= '9')) {
+            v = c - '0';
+        } else if (((c | 0x20) >= 'a') && ((c | 0x20) <= 'f')) {
+            v = (c | 0x20) - 'a' + 10;
+        } else {
+            ext = true; // ';' chunk extension or padding, ignored
+            continue;
+        }
+        if (++digits > 7) {
+            return -1; // Would overflow, and far larger than we could ever handle
+        }
+        len = (len << 4) | v;
+    }
+    return digits ? len : -1;
+}
+
+/**
+    discard one line from the server
+    @return number of characters before the \r\n, or -1 on timeout
+*/
+int HTTPClient::skipLine() {
+    int len = 0;
+    while (true) {
+        char c;
+        if (_client()->readBytes(&c, 1) != 1) {
+            return -1;
+        }
+        if (c == '\n') {
+            return len;
+        } else if (c != '\r') {
+            len++;
+        }
+    }
+}
+
 /**
     return all payload as String (may need lot of ram or trigger out of memory!)
     @return String
@@ -1016,9 +1124,31 @@ bool HTTPClient::connect(void) {
         while (_client()->available()) {
             _client()->read();
         }
+        if (_pool) {
+            _pool->_reused++;
+        }
         return true;
     }
 
+    // A pooled connection that went stale is not ours to reconnect, go back to our own client
+    if (_clientPooled) {
+        _clientPooled->stop();
+        delete _clientPooled;
+        _clientPooled = nullptr;
+    }
+
+    if (_pool && !_clientGiven && _clientMade) {
+        _clientPooled = _pool->acquire(_host, _port, _clientTLS);
+        if (_clientPooled) {
+            DEBUG_HTTPCLIENT("[HTTP-Client] connect: reusing pooled connection to %s:%u\n", _host.c_str(), _port);
+            _pooledTLS = _clientTLS;
+            _connHost = _host;
+            _connPort = _port;
+            _clientPooled->setTimeout(_tcpTimeout);
+            return true;
+        }
+    }
+
     if (!_client()) {
         DEBUG_HTTPCLIENT("[HTTP-Client] connect: HTTPClient::begin was not called or returned error\n");
         return false;
@@ -1033,6 +1163,11 @@ bool HTTPClient::connect(void) {
 
     DEBUG_HTTPCLIENT("[HTTP-Client] connected to %s:%u\n", _host.c_str(), _port);
     _client()->setNoDelay(true);
+    _connHost = _host;
+    _connPort = _port;
+    if (_pool && !_clientGiven) {
+        _pool->_created++;
+    }
     return connected();
 }
 
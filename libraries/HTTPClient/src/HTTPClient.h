@@ -31,6 +31,7 @@
 #include <StreamString.h>
 #include <WiFiClient.h>
 #include <WiFiClientSecure.h>
+#include "HTTPConnectionPool.h"
 
 #include <memory>
 #include <vector>
@@ -180,6 +181,8 @@ class HTTPClient {
 public:
     HTTPClient() = default;
     ~HTTPClient() {
+        releaseToPool(true);
+        delete _clientPooled;
         if (_clientMade) {
             delete _clientMade;
         }
@@ -209,6 +212,7 @@ public:
     bool connected(void);
 
     void setReuse(bool reuse); /// keep-alive
+    void setConnectionPool(HTTPConnectionPool *pool); /// share keep-alive connections, nullptr to disable
     void setUserAgent(const String& userAgent);
     void setAuthorization(const char * user, const char * password);
     void setAuthorization(const char * auth);
@@ -358,6 +362,9 @@ protected:
     bool sendHeader(const char * type);
     int handleHeaderResponse();
     int writeToStreamDataBlock(Stream * stream, int len);
+    int readChunkSize();
+    int skipLine();
+    void releaseToPool(bool all);
 
     // Cookie jar support
     void setCookie(String date, String headerValue);
@@ -369,9 +376,18 @@ protected:
     std::unique_ptr<WiFiClient> _clientIn;
     bool _clientGiven = false;
 
+    // Connection taken from _pool, used in place of _clientMade until given back
+    HTTPConnectionPool *_pool = nullptr;
+    WiFiClient *_clientPooled = nullptr;
+    bool _pooledTLS = false;
+    String _connHost; // Where the current connection goes, for parking it in _pool
+    uint16_t _connPort = 0;
+
     WiFiClient *_client() {
         if (_clientGiven) {
             return _clientIn.get();
+        } else if (_clientPooled) {
+            return _clientPooled;
         } else {
             return _clientMade;
         }
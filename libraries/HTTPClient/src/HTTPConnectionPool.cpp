@@ -0,0 +1,83 @@
+/*
+    HTTPConnectionPool - Idle keep-alive connections shared between HTTPClients
+
+    Copyright (c) 2024 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "HTTPConnectionPool.h"
+
+HTTPConnectionPool &HTTPConnectionPool::shared() {
+    static HTTPConnectionPool pool;
+    return pool;
+}
+
+void HTTPConnectionPool::_close(size_t i) {
+    _idle[i].client->stop();
+    delete _idle[i].client;
+    _idle.erase(_idle.begin() + i);
+}
+
+void HTTPConnectionPool::expire() {
+    uint32_t now = millis();
+    size_t i = 0;
+    while (i < _idle.size()) {
+        const Entry &e = _idle[i];
+        if (((now - e.since) > _idleTimeout) || !e.client->connected()) {
+            _close(i);
+        } else {
+            i++;
+        }
+    }
+    while (_idle.size() > _maxIdle) {
+        _close(0);
+    }
+}
+
+void HTTPConnectionPool::clear() {
+    while (!_idle.empty()) {
+        _close(0);
+    }
+}
+
+WiFiClient *HTTPConnectionPool::acquire(const String &host, uint16_t port, bool tls) {
+    expire();
+    // Newest first, it is the least likely to have been dropped by the server
+    for (size_t i = _idle.size(); i > 0; i--) {
+        Entry &e = _idle[i - 1];
+        if ((e.port == port) && (e.tls == tls) && e.host.equalsIgnoreCase(host)) {
+            WiFiClient *c = e.client;
+            _idle.erase(_idle.begin() + (i - 1));
+            // Anything unread belongs to the last response, drop it
+            while (c->available() > 0) {
+                c->read();
+            }
+            _reused++;
+            return c;
+        }
+    }
+    return nullptr;
+}
+
+void HTTPConnectionPool::park(const String &host, uint16_t port, bool tls, WiFiClient *client) {
+    if (!_maxIdle) {
+        client->stop();
+        delete client;
+        return;
+    }
+    _idle.push_back({host, port, tls, client, millis()});
+    expire();
+}
@@ -0,0 +1,103 @@
+/*
+    HTTPConnectionPool - Idle keep-alive connections shared between HTTPClients
+
+    Copyright (c) 2024 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+#include <vector>
+
+#define HTTPCLIENT_POOL_DEFAULT_IDLE_TIMEOUT (10000)
+#define HTTPCLIENT_POOL_DEFAULT_MAX_IDLE     (4)
+
+/**
+    Holds connected WiFiClient/WiFiClientSecure objects between requests, keyed
+    by host, port, and TLS.  An HTTPClient with a pool attached will park its
+    keep-alive connection here on end() or when it moves to another host, and
+    will pick up a parked one instead of opening a new TCP connection (and TLS
+    handshake) when one matches.
+
+    A TLS connection keeps the trust settings of the client that opened it, so
+    only share a pool between HTTPClients that use the same certificate setup.
+*/
+class HTTPConnectionPool {
+public:
+    HTTPConnectionPool(size_t maxIdle = HTTPCLIENT_POOL_DEFAULT_MAX_IDLE, uint32_t idleTimeout = HTTPCLIENT_POOL_DEFAULT_IDLE_TIMEOUT) : _maxIdle(maxIdle), _idleTimeout(idleTimeout) { }
+    ~HTTPConnectionPool() {
+        clear();
+    }
+    HTTPConnectionPool(const HTTPConnectionPool&) = delete;
+    HTTPConnectionPool& operator=(const HTTPConnectionPool&) = delete;
+
+    void setMaxIdle(size_t maxIdle) {
+        _maxIdle = maxIdle;
+        expire();
+    }
+    void setIdleTimeout(uint32_t idleTimeout) {
+        _idleTimeout = idleTimeout;
+        expire();
+    }
+
+    // Closes parked connections that timed out, were closed by the server, or exceed maxIdle
+    void expire();
+    // Closes all parked connections
+    void clear();
+
+    size_t idle() const {
+        return _idle.size();
+    }
+    uint32_t reused() const {
+        return _reused;
+    }
+    uint32_t created() const {
+        return _created;
+    }
+    void resetStats() {
+        _reused = 0;
+        _created = 0;
+    }
+
+    // Shared default pool, for sketches that do not need more than one
+    static HTTPConnectionPool &shared();
+
+protected:
+    friend class HTTPClient;
+
+    // Returns a connected client now owned by the caller, or nullptr
+    WiFiClient *acquire(const String &host, uint16_t port, bool tls);
+    // Takes ownership of a connected client
+    void park(const String &host, uint16_t port, bool tls, WiFiClient *client);
+
+    typedef struct {
+        String host;
+        uint16_t port;
+        bool tls;
+        WiFiClient *client;
+        uint32_t since;
+    } Entry;
+    std::vector<Entry> _idle; // Oldest first
+
+    size_t _maxIdle;
+    uint32_t _idleTimeout;
+    uint32_t _reused = 0;
+    uint32_t _created = 0;
+
+    void _close(size_t i);
+};
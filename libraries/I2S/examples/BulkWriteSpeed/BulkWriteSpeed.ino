@@ -0,0 +1,87 @@
+// Measures how many samples per second the CPU can feed to I2S, comparing one
+// write() call per sample against bulk write() calls that copy whole buffers.
+// Released to the public domain by Earle F. Philhower, III
+//
+// Only the cycles spent inside successful write() calls are counted, so the
+// result is independent of the actual I2S sample rate.  An amp or DAC on the
+// pins is optional, it will play a quiet tone.
+
+#include <I2S.h>
+
+#define pBCLK 20
+#define pWS (pBCLK+1)
+#define pDOUT 22
+
+#define BLOCK 256   // Stereo samples per bulk write
+
+I2S i2s(OUTPUT);
+uint32_t wave[BLOCK];
+
+void report(const char *name, uint64_t cycles, uint32_t samples) {
+  float cps = (float)cycles / samples;
+  Serial.printf("%-22s %6.1f cycles/sample, %8.0f samples/sec max\n", name, cps, (float)rp2040.f_cpu() / cps);
+}
+
+void perSample() {
+  uint64_t cycles = 0;
+  uint32_t samples = 0;
+  uint32_t stop = millis() + 2000;
+  int i = 0;
+  while (millis() < stop) {
+    uint32_t start = rp2040.getCycleCount();
+    size_t ok = i2s.write((int32_t)wave[i], false);
+    uint32_t end = rp2040.getCycleCount();
+    if (ok) {
+      cycles += end - start;
+      samples++;
+      i = (i + 1) % BLOCK;
+    }
+  }
+  report("write(sample):", cycles, samples);
+}
+
+void bulk(size_t words) {
+  uint64_t cycles = 0;
+  uint32_t samples = 0;
+  uint32_t stop = millis() + 2000;
+  while (millis() < stop) {
+    uint32_t start = rp2040.getCycleCount();
+    size_t ok = i2s.write((const uint8_t *)wave, words * 4);
+    uint32_t end = rp2040.getCycleCount();
+    if (ok) {
+      cycles += end - start;
+      samples += ok / 4;
+    }
+  }
+  char name[32];
+  sprintf(name, "write(buffer, %u):", (unsigned)(words * 4));
+  report(name, cycles, samples);
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(5000);
+
+  for (int i = 0; i < BLOCK; i++) {
+    int16_t s = 500 * sinf(2 * M_PI * i / BLOCK);
+    wave[i] = (s << 16) | (s & 0xffff);
+  }
+
+  i2s.setBCLK(pBCLK);
+  i2s.setDATA(pDOUT);
+  i2s.setBitsPerSample(16);
+  i2s.setBuffers(8, BLOCK);
+  if (!i2s.begin(48000)) {
+    Serial.println("Failed to start I2S");
+    return;
+  }
+
+  Serial.printf("I2S feed speed at %d MHz\n", rp2040.f_cpu() / 1000000);
+  perSample();
+  bulk(16);
+  bulk(64);
+  bulk(BLOCK);
+}
+
+void loop() {
+}
@@ -476,19 +476,16 @@ size_t I2S::write(const uint8_t *buffer, size_t size) {
         return 0;
     }
 
-    size_t writtenSize = 0;
-    uint32_t *p = (uint32_t *)buffer;
-    while (size) {
-        if (!_arb->write(*p, false)) {
-            // Blocked, stop write here
-            return writtenSize;
-        } else {
-            p++;
-            size -= 4;
-            writtenSize += 4;
-        }
+    // Copies whole spans into the DMA buffers, stopping when blocked
+    return _arb->write((const uint32_t *)buffer, size / 4, false) * 4;
+}
+
+size_t I2S::read(uint8_t *buffer, size_t size) {
+    // We can only read 32-bit chunks here
+    if (size & 0x3 || !_running || _isOutput || _hasPeeked || _isHolding) {
+        return 0;
     }
-    return writtenSize;
+    return _arb->read((uint32_t *)buffer, size / 4, false) * 4;
 }
 
 int I2S::availableForWrite() {
@@ -101,6 +101,9 @@ public:
     // Read 32 bit value to port, user responsible for packing/alignment, etc.
     size_t read(int32_t *val, bool sync);
 
+    // Read as many 32-bit words as are available, without blocking, user responsible for unpacking
+    size_t read(uint8_t *buffer, size_t size);
+
     // Read samples from I2S port, will block until data available
     bool read8(int8_t *l, int8_t *r);
     bool read16(int16_t *l, int16_t *r);
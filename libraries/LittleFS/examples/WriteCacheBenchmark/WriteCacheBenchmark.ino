@@ -0,0 +1,77 @@
+// Compares LittleFS small-file and append-log performance with and without the write cache
+// Released to the public domain by Earle F. Philhower, III
+//
+// WARNING:  The filesystem will be formatted at the start of each run!
+
+#include <LittleFS.h>
+
+#define SMALLFILES 64   // Number of small files to create
+#define SMALLSIZE 200   // Bytes per small file
+#define LOGRECORDS 512  // Records to append to the log
+#define LOGSIZE 48      // Bytes per log record
+
+void report(const char *name, unsigned long us, int ops, unsigned long bytes) {
+  float s = us / 1000000.0;
+  Serial.printf("  %-12s %6d ops in %7lu ms: %8.1f ops/s, %8.1f bytes/s\n", name, ops, us / 1000, ops / s, bytes / s);
+}
+
+void run(uint8_t cacheBlocks) {
+  LittleFSConfig cfg;
+  cfg.setWriteCache(cacheBlocks);
+  cfg.setPreErase(8);
+  LittleFS.end();
+  LittleFS.setConfig(cfg);
+  LittleFS.format();
+  if (!LittleFS.begin()) {
+    Serial.printf("Unable to begin(), aborting\n");
+    return;
+  }
+  Serial.printf("Write cache %d blocks:\n", cacheBlocks);
+
+  char buff[SMALLSIZE];
+  memset(buff, 'x', sizeof(buff));
+
+  unsigned long start = micros();
+  for (int i = 0; i < SMALLFILES; i++) {
+    char name[32];
+    sprintf(name, "/small/%d.txt", i);
+    File f = LittleFS.open(name, "w");
+    f.write(buff, SMALLSIZE);
+    f.close();
+  }
+  report("small files", micros() - start, SMALLFILES, SMALLFILES * SMALLSIZE);
+
+  start = micros();
+  File log = LittleFS.open("/log.txt", "a");
+  for (int i = 0; i < LOGRECORDS; i++) {
+    log.write(buff, LOGSIZE);
+    log.flush(); // Each record must be durable, as in a real log
+  }
+  log.close();
+  report("append log", micros() - start, LOGRECORDS, LOGRECORDS * LOGSIZE);
+
+  // Now give gc() idle time to pre-erase the freed blocks, and repeat the log
+  LittleFS.remove("/log.txt");
+  for (int i = 0; i < 16; i++) {
+    LittleFS.gc();
+  }
+  start = micros();
+  log = LittleFS.open("/log.txt", "a");
+  for (int i = 0; i < LOGRECORDS; i++) {
+    log.write(buff, LOGSIZE);
+    log.flush();
+  }
+  log.close();
+  report("after gc()", micros() - start, LOGRECORDS, LOGRECORDS * LOGSIZE);
+  LittleFS.end();
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(5000);
+  run(0);
+  run(4);
+}
+
+void loop() {
+}
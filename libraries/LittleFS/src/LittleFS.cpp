@@ -173,6 +173,13 @@ DirImplPtr LittleFSImpl::openDir(const char *path) {
 int LittleFSImpl::lfs_flash_read(const struct lfs_config *c,
                                  lfs_block_t block, lfs_off_t off, void *dst, lfs_size_t size) {
     LittleFSImpl *me = reinterpret_cast<LittleFSImpl*>(c->context);
+    if (me->_cache) {
+        CacheSlot *s = me->_cacheFind(block);
+        if (s) {
+            memcpy(dst, s->data + off, size);
+            return 0;
+        }
+    }
     //    Serial.printf(" READ: %p, %d\n", me->_start + (block * me->_blockSize) + off, size);
     memcpy(dst, me->_start + (block * me->_blockSize) + off, size);
     return 0;
@@ -181,34 +188,227 @@ int LittleFSImpl::lfs_flash_read(const struct lfs_config *c,
 int LittleFSImpl::lfs_flash_prog(const struct lfs_config *c,
                                  lfs_block_t block, lfs_off_t off, const void *buffer, lfs_size_t size) {
     LittleFSImpl *me = reinterpret_cast<LittleFSImpl*>(c->context);
+    if (me->_cache) {
+        CacheSlot *s = me->_cacheClaim(block, true);
+        if (!s->dirty && !s->erase) {
+            s->order = ++me->_cacheSeq;
+        }
+        memcpy(s->data + off, buffer, size);
+        for (uint32_t p = off / me->_pageSize; p <= (off + size - 1) / me->_pageSize; p++) {
+            s->dirty |= 1u << p;
+        }
+        return 0;
+    }
     uint8_t *addr = me->_start + (block * me->_blockSize) + off;
-    noInterrupts();
-    rp2040.idleOtherCore();
     //    Serial.printf("WRITE: %p, $d\n", (intptr_t)addr - (intptr_t)XIP_BASE, size);
-    flash_range_program((intptr_t)addr - (intptr_t)XIP_BASE, (const uint8_t *)buffer, size);
-    rp2040.resumeOtherCore();
-    interrupts();
+    me->_setErased(block, false);
+    rp2040.flashProgram((intptr_t)addr - (intptr_t)XIP_BASE, (const uint8_t *)buffer, size);
     return 0;
 }
 
 int LittleFSImpl::lfs_flash_erase(const struct lfs_config *c, lfs_block_t block) {
     LittleFSImpl *me = reinterpret_cast<LittleFSImpl*>(c->context);
-    uint8_t *addr = me->_start + (block * me->_blockSize);
-    //    Serial.printf("ERASE: %p, %d\n", (intptr_t)addr - (intptr_t)XIP_BASE, me->_blockSize);
-    noInterrupts();
-    rp2040.idleOtherCore();
-    flash_range_erase((intptr_t)addr - (intptr_t)XIP_BASE, me->_blockSize);
-    rp2040.resumeOtherCore();
-    interrupts();
+    if (me->_cache) {
+        CacheSlot *s = me->_cacheClaim(block, false);
+        if (!s->dirty && !s->erase) {
+            s->order = ++me->_cacheSeq;
+        }
+        memset(s->data, 0xff, me->_blockSize);
+        s->dirty = 0;
+        s->erase = !me->_isErased(block);
+        return 0;
+    }
+    if (me->_isErased(block)) {
+        return 0; // Already blanked by gc()
+    }
+    //    Serial.printf("ERASE: %p, %d\n", me->_flashOffset(block), me->_blockSize);
+    rp2040.flashErase(me->_flashOffset(block), me->_blockSize);
     return 0;
 }
 
 int LittleFSImpl::lfs_flash_sync(const struct lfs_config *c) {
-    /* NOOP */
-    (void) c;
+    LittleFSImpl *me = reinterpret_cast<LittleFSImpl*>(c->context);
+    if (me->_cache) {
+        me->_cacheFlush();
+    }
+    return 0;
+}
+
+uint32_t LittleFSImpl::_flashOffset(lfs_block_t block) {
+    return (intptr_t)(_start + block * _blockSize) - (intptr_t)XIP_BASE;
+}
+
+void LittleFSImpl::_cacheBegin() {
+    if (_cache || !_cfg._cacheBlocks) {
+        return;
+    }
+    if (_blockSize / _pageSize > 32) {
+        DEBUGV("LittleFS write cache needs <= 32 pages per block\n");
+        return;
+    }
+    _cache = (CacheSlot *)calloc(_cfg._cacheBlocks, sizeof(CacheSlot));
+    if (!_cache) {
+        return;
+    }
+    for (_cacheSlots = 0; _cacheSlots < _cfg._cacheBlocks; _cacheSlots++) {
+        _cache[_cacheSlots].data = (uint8_t *)malloc(_blockSize);
+        if (!_cache[_cacheSlots].data) {
+            break; // Run with whatever fit
+        }
+    }
+    if (!_cacheSlots) {
+        free(_cache);
+        _cache = nullptr;
+    }
+}
+
+void LittleFSImpl::_cacheEnd() {
+    if (_cache) {
+        _cacheFlush();
+        for (int i = 0; i < _cacheSlots; i++) {
+            free(_cache[i].data);
+        }
+        free(_cache);
+        _cache = nullptr;
+        _cacheSlots = 0;
+    }
+    free(_erased);
+    _erased = nullptr;
+}
+
+LittleFSImpl::CacheSlot *LittleFSImpl::_cacheFind(lfs_block_t block) {
+    for (int i = 0; i < _cacheSlots; i++) {
+        if (_cache[i].valid && (_cache[i].block == block)) {
+            return &_cache[i];
+        }
+    }
+    return nullptr;
+}
+
+LittleFSImpl::CacheSlot *LittleFSImpl::_cacheClaim(lfs_block_t block, bool load) {
+    CacheSlot *s = _cacheFind(block);
+    if (!s) {
+        // Take an empty slot, else the least recently used one
+        for (int i = 0; i < _cacheSlots; i++) {
+            if (!_cache[i].valid) {
+                s = &_cache[i];
+                break;
+            }
+            if (!s || (_cache[i].used < s->used)) {
+                s = &_cache[i];
+            }
+        }
+        if (s->dirty || s->erase) {
+            // Anything written before the victim must hit flash first to keep the write order
+            _cacheFlush(s->order);
+        }
+        s->block = block;
+        s->valid = true;
+        s->dirty = 0;
+        s->erase = false;
+        if (load) {
+            memcpy(s->data, _start + block * _blockSize, _blockSize);
+        }
+    }
+    s->used = ++_cacheSeq;
+    return s;
+}
+
+void LittleFSImpl::_cacheFlush(uint32_t upTo) {
+    while (true) {
+        CacheSlot *next = nullptr;
+        for (int i = 0; i < _cacheSlots; i++) {
+            CacheSlot *s = &_cache[i];
+            if ((s->dirty || s->erase) && (s->order <= upTo) && (!next || (s->order < next->order))) {
+                next = s;
+            }
+        }
+        if (!next) {
+            return;
+        }
+        _cacheFlushSlot(next);
+    }
+}
+
+void LittleFSImpl::_cacheFlushSlot(CacheSlot *s) {
+    uint32_t addr = _flashOffset(s->block);
+    if (s->erase) {
+        rp2040.flashErase(addr, _blockSize);
+    }
+    // Program each run of consecutive dirty pages with a single call
+    uint32_t pages = _blockSize / _pageSize;
+    for (uint32_t p = 0; p < pages;) {
+        if (!(s->dirty & (1u << p))) {
+            p++;
+            continue;
+        }
+        uint32_t e = p;
+        while ((e < pages) && (s->dirty & (1u << e))) {
+            e++;
+        }
+        rp2040.flashProgram(addr + p * _pageSize, s->data + p * _pageSize, (e - p) * _pageSize);
+        p = e;
+    }
+    _setErased(s->block, !s->dirty && (s->erase || _isErased(s->block)));
+    s->dirty = 0;
+    s->erase = false;
+}
+
+typedef struct {
+    uint8_t     *map;
+    lfs_block_t  count;
+} UsedBlocks;
+
+int LittleFSImpl::_markUsed(void *data, lfs_block_t block) {
+    UsedBlocks *u = (UsedBlocks *)data;
+    if (block < u->count) {
+        u->map[block / 8] |= 1u << (block % 8);
+    }
     return 0;
 }
 
+bool LittleFSImpl::gc() {
+    if (!_mounted || !_cfg._preEraseBlocks) {
+        return false;
+    }
+    lfs_block_t blocks = _lfs_cfg.block_count;
+    if (!_erased) {
+        _erased = (uint8_t *)calloc((blocks + 7) / 8, 1);
+        if (!_erased) {
+            return false;
+        }
+    }
+    UsedBlocks u = { (uint8_t *)calloc((blocks + 7) / 8, 1), blocks };
+    if (!u.map) {
+        return false;
+    }
+    if (lfs_fs_traverse(&_lfs, _markUsed, &u) < 0) {
+        free(u.map);
+        return false;
+    }
+    // Blank a few free blocks so that littlefs' later erase of them costs nothing
+    uint32_t erased = 0;
+    for (lfs_block_t i = 0; (i < blocks) && (erased < _cfg._preEraseBlocks); i++) {
+        lfs_block_t b = (_preEraseNext + i) % blocks;
+        if ((u.map[b / 8] & (1u << (b % 8))) || _isErased(b) || _cacheFind(b)) {
+            continue;
+        }
+        const uint32_t *w = (const uint32_t *)(_start + b * _blockSize);
+        bool blank = true;
+        for (uint32_t j = 0; blank && (j < _blockSize / 4); j++) {
+            blank = w[j] == 0xffffffff;
+        }
+        if (!blank) {
+            rp2040.flashErase(_flashOffset(b), _blockSize);
+            erased++;
+        }
+        _setErased(b, true);
+        _preEraseNext = b + 1;
+    }
+    free(u.map);
+    return true;
+}
+
 
 }; // namespace
 
@@ -42,14 +42,31 @@ class LittleFSDirImpl;
 class LittleFSConfig : public FSConfig {
 public:
     static constexpr uint32_t FSId = 0x4c495454;
-    LittleFSConfig(bool autoFormat = true) : FSConfig(FSId, autoFormat) { }
+    LittleFSConfig(bool autoFormat = true) : FSConfig(FSId, autoFormat), _cacheBlocks(0), _preEraseBlocks(1) { }
+
+    // Number of 4K blocks of RAM to use as a write-behind cache (0 = write straight through)
+    LittleFSConfig setWriteCache(uint8_t blocks) {
+        _cacheBlocks = blocks;
+        return *this;
+    }
+    // Maximum number of free blocks to erase ahead of time per gc() call (0 = never).
+    // Defaults to 1 because each erase stalls interrupts and the other core for tens of
+    // ms, so a single gc() in loop() stays short.  Raise it when gc() runs rarely.
+    LittleFSConfig setPreErase(uint16_t blocks) {
+        _preEraseBlocks = blocks;
+        return *this;
+    }
+
+    // Inherit _type and _autoFormat
+    uint8_t  _cacheBlocks;
+    uint16_t _preEraseBlocks;
 };
 
 class LittleFSImpl : public FSImpl {
 public:
     LittleFSImpl(uint8_t *start, uint32_t size, uint32_t pageSize, uint32_t blockSize, uint32_t maxOpenFds)
         : _start(start), _size(size), _pageSize(pageSize), _blockSize(blockSize), _maxOpenFds(maxOpenFds),
-          _mounted(false) {
+          _mounted(false), _cache(nullptr), _cacheSlots(0), _cacheSeq(0), _erased(nullptr), _preEraseNext(0) {
         memset(&_lfs, 0, sizeof(_lfs));
         memset(&_lfs_cfg, 0, sizeof(_lfs_cfg));
         _lfs_cfg.context = (void*) this;
@@ -74,8 +91,9 @@ public:
 
     ~LittleFSImpl() {
         if (_mounted) {
-            lfs_unmount(&_lfs);
+            _unmount();
         }
+        _cacheEnd();
     }
 
     FileImplPtr open(const char* path, OpenMode openMode, AccessMode accessMode) override;
@@ -201,10 +219,13 @@ public:
         if (!_mounted) {
             return;
         }
-        lfs_unmount(&_lfs);
-        _mounted = false;
+        _unmount();
+        _cacheEnd();
     }
 
+    // Erases up to LittleFSConfig::setPreErase() (default 1) free blocks
+    bool gc() override;
+
     bool format() override {
         if (_size == 0) {
             DEBUGV("lfs size is zero\n");
@@ -213,12 +234,12 @@ public:
 
         bool wasMounted = _mounted;
         if (_mounted) {
-            lfs_unmount(&_lfs);
-            _mounted = false;
+            _unmount();
         }
 
         memset(&_lfs, 0, sizeof(_lfs));
         int rc = lfs_format(&_lfs, &_lfs_cfg);
+        _cacheFlush();
         if (rc != 0) {
             DEBUGV("lfs_format: rc=%d\n", rc);
             return false;
@@ -240,8 +261,7 @@ public:
                 return false;
             }
 
-            lfs_unmount(&_lfs);
-            _mounted = false;
+            _unmount();
         }
 
         if (wasMounted) {
@@ -275,9 +295,9 @@ protected:
 
     bool _tryMount() {
         if (_mounted) {
-            lfs_unmount(&_lfs);
-            _mounted = false;
+            _unmount();
         }
+        _cacheBegin();
         memset(&_lfs, 0, sizeof(_lfs));
         int rc = lfs_mount(&_lfs, &_lfs_cfg);
         if (rc == 0) {
@@ -286,6 +306,12 @@ protected:
         return _mounted;
     }
 
+    void _unmount() {
+        lfs_unmount(&_lfs);
+        _cacheFlush();
+        _mounted = false;
+    }
+
     int _getUsedBlocks() {
         if (!_mounted) {
             return 0;
@@ -341,6 +367,39 @@ protected:
     static int lfs_flash_erase(const struct lfs_config *c, lfs_block_t block);
     static int lfs_flash_sync(const struct lfs_config *c);
 
+    // Write-behind block cache.  Erases and programs land in RAM and only reach flash
+    // (one sector erase plus coalesced page programs per block) on sync or eviction.
+    typedef struct {
+        uint8_t     *data;
+        lfs_block_t  block;
+        uint32_t     dirty; // Bitmap of pages programmed since the last flush
+        uint32_t     used;  // LRU stamp
+        uint32_t     order; // Stamp of the first write since the last flush, for flush ordering
+        bool         valid;
+        bool         erase; // Sector erase deferred until flush
+    } CacheSlot;
+
+    void _cacheBegin();
+    void _cacheEnd();
+    void _cacheFlush(uint32_t upTo = 0xffffffff);
+    void _cacheFlushSlot(CacheSlot *s);
+    CacheSlot *_cacheFind(lfs_block_t block);
+    CacheSlot *_cacheClaim(lfs_block_t block, bool load);
+    uint32_t _flashOffset(lfs_block_t block);
+    bool _isErased(lfs_block_t block) {
+        return _erased && (_erased[block / 8] & (1u << (block % 8)));
+    }
+    void _setErased(lfs_block_t block, bool erased) {
+        if (_erased) {
+            if (erased) {
+                _erased[block / 8] |= 1u << (block % 8);
+            } else {
+                _erased[block / 8] &= ~(1u << (block % 8));
+            }
+        }
+    }
+    static int _markUsed(void *data, lfs_block_t block);
+
     lfs_t       _lfs;
     lfs_config  _lfs_cfg;
 
@@ -353,6 +412,12 @@ protected:
     uint32_t _maxOpenFds;
 
     bool     _mounted;
+
+    CacheSlot *_cache;
+    uint8_t    _cacheSlots;
+    uint32_t   _cacheSeq;
+    uint8_t   *_erased; // Bitmap of blocks known to be all 0xFF in flash
+    uint32_t   _preEraseNext;
 };
 
 
@@ -0,0 +1,105 @@
+// Checks the PDM decimator output against the classic OpenPDMFilter, bit for bit,
+// and reports the CPU cycles each one needs per output sample.
+// Released to the public domain by Earle F. Philhower, III
+//
+// No microphone needed, the PDM input is a sine from a software sigma-delta.
+
+#include <PDM.h>
+#include <utility/PDMDecimator.h>
+#include <rp2040/OpenPDMFilter.h>
+
+#define FRAMES 32   // Output samples per block, like PDM.begin() uses at 128x
+#define BLOCKS 32   // Blocks per run
+#define WORDS (BLOCKS * FRAMES * 128 / 32) // Enough for decimation 128
+
+uint32_t words[WORDS];
+uint8_t bytes[WORDS * 4];
+int16_t ref[BLOCKS * FRAMES];
+int16_t out[BLOCKS * FRAMES * 4];
+
+void makePDM() {
+  float acc = 0;
+  for (int i = 0; i < WORDS * 32; i++) {
+    float x = 0.03 * sinf(2 * M_PI * i / 3000.0);
+    bool y = acc >= 0;
+    acc += x - (y ? 1 : -1);
+    if (y) {
+      words[i / 32] |= 0x80000000 >> (i & 31);
+    } else {
+      words[i / 32] &= ~(0x80000000 >> (i & 31));
+    }
+  }
+  // OpenPDMFilter takes bytes in the order received, the PIO pushes MSB first
+  for (int i = 0; i < WORDS; i++) {
+    bytes[i * 4 + 0] = words[i] >> 24;
+    bytes[i * 4 + 1] = words[i] >> 16;
+    bytes[i * 4 + 2] = words[i] >> 8;
+    bytes[i * 4 + 3] = words[i];
+  }
+}
+
+void compare(int decimation) {
+  TPDMFilter_InitStruct f = { };
+  f.Fs = 16000;
+  f.MaxVolume = 1;
+  f.nSamples = FRAMES;
+  f.LP_HZ = 8000;
+  f.HP_HZ = 10;
+  f.In_MicChannels = 1;
+  f.Out_MicChannels = 1;
+  f.Decimation = decimation;
+  f.filterGain = 16;
+  Open_PDM_Filter_Init(&f);
+
+  int blocks = BLOCKS;
+  uint32_t start = rp2040.getCycleCount();
+  for (int b = 0; b < blocks; b++) {
+    if (decimation == 128) {
+      Open_PDM_Filter_128(bytes + b * FRAMES * 128 / 8, ref + b * FRAMES, 1, &f);
+    } else {
+      Open_PDM_Filter_64(bytes + b * FRAMES * 64 / 8, ref + b * FRAMES, 1, &f);
+    }
+  }
+  uint32_t classic = rp2040.getCycleCount() - start;
+
+  PDMDecimator d;
+  d.begin(decimation, 1, 1, 16000, 16);
+  size_t per = d.wordsPerFrames(FRAMES);
+  start = rp2040.getCycleCount();
+  for (int b = 0; b < blocks; b++) {
+    d.process(words + b * per, per, out + b * FRAMES);
+  }
+  uint32_t cic = rp2040.getCycleCount() - start;
+
+  int bad = 0;
+  for (int i = 0; i < blocks * FRAMES; i++) {
+    bad += (ref[i] != out[i]) ? 1 : 0;
+  }
+  Serial.printf("Mono, decimation %3d: OpenPDMFilter %6.1f cycles/sample, PDMDecimator %6.1f cycles/sample, %d mismatches\n",
+                decimation, (float)classic / (blocks * FRAMES), (float)cic / (blocks * FRAMES), bad);
+}
+
+void multi(int decimation, int mics) {
+  // Same bits, read as interleaved mics.  Only the speed matters here.
+  PDMDecimator d;
+  d.begin(decimation, mics, mics, 16000, 16);
+  int frames = WORDS * 32 / (decimation * mics);
+  uint32_t start = rp2040.getCycleCount();
+  d.process(words, d.wordsPerFrames(frames), out);
+  uint32_t cic = rp2040.getCycleCount() - start;
+  Serial.printf("%d mics, decimation %3d: PDMDecimator %6.1f cycles/sample\n", mics, decimation, (float)cic / (frames * mics));
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(5000);
+  makePDM();
+  compare(64);
+  compare(128);
+  multi(64, 2);
+  multi(32, 4);
+  multi(64, 4);
+}
+
+void loop() {
+}
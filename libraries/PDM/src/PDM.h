@@ -20,6 +20,7 @@
 
 #include <Arduino.h>
 //#include <pinDefinitions.h>
+#include <pico/mutex.h>
 
 #include "utility/PDMDoubleBuffer.h"
 
@@ -45,6 +46,15 @@ public:
     void setBufferSize(int bufferSize);
     size_t getBufferSize();
 
+    // Flatten the CIC's high frequency droop, at the cost of no longer
+    // matching the classic OpenPDMFilter output bit for bit
+    void setCompensation(bool enable);
+
+    // Convert PDM to PCM in process() instead of the DMA IRQ.  available() and
+    // read() call it, or call it from loop1() to use the other core.
+    void setDeferred(bool deferred);
+    void process();
+
     // private:
     void IrqHandler(bool halftranfer);
 
@@ -59,6 +69,8 @@ private:
     int _init;
 
     int _cutSamples;
+    bool _deferred;
+    mutex_t _mutex;
 
     // Hardware peripherals used
     uint _dmaChannel;
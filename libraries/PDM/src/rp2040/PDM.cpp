@@ -2,7 +2,7 @@
 
 #include "Arduino.h"
 #include "PDM.h"
-#include "OpenPDMFilter.h"
+#include "utility/PDMDecimator.h"
 
 extern "C" {
 #include <hardware/pio.h>
@@ -12,22 +12,22 @@ extern "C" {
 #include <hardware/sync.h>
 #include "pdm.pio.h"
 static PIOProgram _pdmPgm(&pdm_pio_program);
-
-// raw buffers contain PDM data
-#define RAW_BUFFER_SIZE 512 // should be a multiple of (decimation / 8)
-uint8_t rawBuffer0[RAW_BUFFER_SIZE];
-uint8_t rawBuffer1[RAW_BUFFER_SIZE];
-uint8_t* rawBuffer[2] = {rawBuffer0, rawBuffer1};
-volatile int rawBufferIndex = 0;
-
-int decimation = 128;
-
-// final buffer is the one to be filled with PCM data
-int16_t* volatile finalBuffer;
-
-// OpenPDM filter used to convert PDM into PCM
+static PIOProgram _pdmStereoPgm(&pdm_stereo_program);
+static PIOProgram _pdmQuadPgm(&pdm_quad_program);
+static PIOProgram *_activePgm = nullptr;
+
+// raw buffers contain PDM data, as 32-bit words straight from the PIO.  The DMA
+// fills them round-robin and process() converts them, oldest first.
+#define RAW_BUFFERS 4
+#define RAW_BUFFER_WORDS 128
+uint32_t rawBuffer[RAW_BUFFERS][RAW_BUFFER_WORDS];
+volatile uint32_t rawHead = 0; // Blocks completed by the DMA
+volatile uint32_t rawTail = 0; // Blocks converted or dropped
+int rawBufferWords = RAW_BUFFER_WORDS;
+
+// CIC decimator used to convert PDM into PCM, bit-exact with OpenPDMFilter
 #define FILTER_GAIN     16
-TPDMFilter_InitStruct filter;
+PDMDecimator decimator;
 
 extern "C" {
     __attribute__((__used__)) void dmaHandler(void) {
@@ -45,10 +45,12 @@ PDMClass::PDMClass(int dinPin, int clkPin) :
     _samplerate(-1),
     _init(-1),
     _cutSamples(100),
+    _deferred(false),
     _dmaChannel(0),
     _pio(nullptr),
     _smIdx(-1),
     _pgmOffset(-1) {
+    mutex_init(&_mutex);
 }
 
 PDMClass::~PDMClass() {
@@ -74,19 +76,29 @@ int PDMClass::begin(int channels, int sampleRate) {
         return 0;
     }
 
-    //_channels = channels; // only one channel available
+    // 1 or 2 mics share DIN, 3 or 4 use DIN and DIN+1
+    if ((channels < 1) || (channels > 4)) {
+        return 0;
+    }
+    int captured = (channels == 3) ? 4 : channels;
+    _channels = channels;
+    _samplerate = sampleRate;
 
     // clear the final buffers
     _doubleBuffer.reset();
-    finalBuffer = (int16_t*)_doubleBuffer.data();
-    int finalBufferLength = _doubleBuffer.availableForWrite() / sizeof(int16_t);
+    int finalBufferFrames = _doubleBuffer.availableForWrite() / (sizeof(int16_t) * channels);
     _doubleBuffer.swap(0);
 
     // The mic accepts an input clock from 1.2 to 3.25 Mhz
-    // Setup the decimation factor accordingly
+    // Setup the decimation factor accordingly, preferring the 128 or 64 used
+    // historically and otherwise the largest multiple of 8 that fits
+    int decimation = 128;
     if ((sampleRate * decimation * 2) > 3250000) {
         decimation = 64;
     }
+    while ((decimation > 16) && ((sampleRate * decimation * 2) > 3250000)) {
+        decimation -= 8;
+    }
 
     // Sanity check, abort if still over 3.25Mhz
     if ((sampleRate * decimation * 2) > 3250000) {
@@ -94,46 +106,53 @@ int PDMClass::begin(int channels, int sampleRate) {
         return -1;
     }
 
-    int rawBufferLength = RAW_BUFFER_SIZE / (decimation / 8);
-    // Saturate number of samples. Remaining bytes are dropped.
-    if (rawBufferLength > finalBufferLength) {
-        rawBufferLength = finalBufferLength;
-    }
-
-    /* Initialize Open PDM library */
-    filter.Fs = sampleRate;
-    filter.MaxVolume = 1;
-    filter.nSamples = rawBufferLength;
-    filter.LP_HZ = sampleRate / 2;
-    filter.HP_HZ = 10;
-    filter.In_MicChannels = 1;
-    filter.Out_MicChannels = 1;
-    filter.Decimation = decimation;
     if (_gain == -1) {
         _gain = FILTER_GAIN;
     }
-    filter.filterGain = _gain;
-    Open_PDM_Filter_Init(&filter);
+    if (!decimator.begin(decimation, captured, channels, sampleRate, _gain)) {
+        return 0;
+    }
+
+    // Whole output frames per raw block, saturated to what the final buffer holds
+    int frames = RAW_BUFFER_WORDS * 32 / (decimation * captured);
+    if (frames > finalBufferFrames) {
+        frames = finalBufferFrames;
+    }
+    frames -= frames % decimator.frameStep();
+    if (frames <= 0) {
+        //ERROR: buffer too small
+        return 0;
+    }
+    rawBufferWords = decimator.wordsPerFrames(frames);
 
     // Configure PIO state machine
     float clkDiv = (float)clock_get_hz(clk_sys) / sampleRate / decimation / 2;
 
-    if (!_pdmPgm.prepare(&_pio, &_smIdx, &_pgmOffset)) {
+    _activePgm = (captured == 1) ? &_pdmPgm : ((captured == 2) ? &_pdmStereoPgm : &_pdmQuadPgm);
+    if (!_activePgm->prepare(&_pio, &_smIdx, &_pgmOffset)) {
         // ERROR, no free slots
         return 0;
     }
-    pdm_pio_program_init(_pio, _smIdx, _pgmOffset, _clkPin, _dinPin, clkDiv);
+    if (captured == 1) {
+        pdm_pio_program_init(_pio, _smIdx, _pgmOffset, _clkPin, _dinPin, clkDiv);
+    } else if (captured == 2) {
+        pdm_stereo_program_init(_pio, _smIdx, _pgmOffset, _clkPin, _dinPin, clkDiv);
+    } else {
+        pdm_quad_program_init(_pio, _smIdx, _pgmOffset, _clkPin, _dinPin, clkDiv);
+    }
 
     // Wait for microphone
     delay(100);
 
     // Configure DMA for transferring PIO rx buffer to raw buffers
+    rawHead = 0;
+    rawTail = 0;
     _dmaChannel = dma_claim_unused_channel(false);
     dma_channel_config c = dma_channel_get_default_config(_dmaChannel);
     channel_config_set_read_increment(&c, false);
     channel_config_set_write_increment(&c, true);
     channel_config_set_dreq(&c, pio_get_dreq(_pio, _smIdx, false));
-    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
 
     // Clear DMA interrupts
     dma_hw->ints0 = 1u << _dmaChannel;
@@ -144,9 +163,9 @@ int PDMClass::begin(int channels, int sampleRate) {
     irq_set_enabled(DMA_IRQ_0, true);
 
     dma_channel_configure(_dmaChannel, &c,
-                          rawBuffer[rawBufferIndex],        // Destinatinon pointer
+                          rawBuffer[0],        // Destinatinon pointer
                           &_pio->rxf[_smIdx],      // Source pointer
-                          RAW_BUFFER_SIZE, // Number of transfers
+                          rawBufferWords, // Number of transfers
                           true                // Start immediately
                          );
 
@@ -167,28 +186,35 @@ void PDMClass::end() {
     dma_channel_abort(_dmaChannel);
     dma_channel_unclaim(_dmaChannel);
     irq_remove_handler(DMA_IRQ_0, dmaHandler);
-    pio_sm_unclaim(_pio, _smIdx);
+    pio_sm_set_enabled(_pio, _smIdx, false);
+    _activePgm->unprepare(_pio, _smIdx);
     pinMode(_clkPin, INPUT);
-    rawBufferIndex = 0;
     _pgmOffset = -1;
 
     _init = 0;
 }
 
 int PDMClass::available() {
-    //NVIC_DisableIRQ(DMA_IRQ_0n);
-    //uint32_t interrupts = save_and_disable_interrupts();
+    if (_deferred) {
+        process();
+    }
+    // The IRQ mask keeps this core's DMA handler out, the mutex the other core
     irq_set_enabled(DMA_IRQ_0, false);
+    mutex_enter_blocking(&_mutex);
     size_t avail = _doubleBuffer.available();
+    mutex_exit(&_mutex);
     irq_set_enabled(DMA_IRQ_0, true);
-    //restore_interrupts(interrupts);
-    //NVIC_EnableIRQ(DMA_IRQ_0n);
     return avail;
 }
 
 int PDMClass::read(void* buffer, size_t size) {
+    if (_deferred) {
+        process();
+    }
     irq_set_enabled(DMA_IRQ_0, false);
+    mutex_enter_blocking(&_mutex);
     int read = _doubleBuffer.read(buffer, size);
+    mutex_exit(&_mutex);
     irq_set_enabled(DMA_IRQ_0, true);
     return read;
 }
@@ -200,8 +226,7 @@ void PDMClass::onReceive(void(*function)(void)) {
 void PDMClass::setGain(int gain) {
     _gain = gain;
     if (_init == 1) {
-        filter.filterGain = _gain;
-        Open_PDM_Filter_Init(&filter);
+        decimator.setGain(_gain);
     }
 }
 
@@ -209,31 +234,60 @@ void PDMClass::setBufferSize(int bufferSize) {
     _doubleBuffer.setSize(bufferSize);
 }
 
-void PDMClass::IrqHandler(bool halftranfer) {
+void PDMClass::setCompensation(bool enable) {
+    decimator.setCompensation(enable);
+}
 
-    // Clear the interrupt request.
-    dma_hw->ints0 = 1u << _dmaChannel;
-    // Restart dma pointing to the other buffer
-    int shadowIndex = rawBufferIndex ^ 1;
-    dma_channel_set_write_addr(_dmaChannel, rawBuffer[shadowIndex], true);
+void PDMClass::setDeferred(bool deferred) {
+    _deferred = deferred;
+}
 
-    if (!_doubleBuffer.available()) {
+void PDMClass::process() {
+    if (_init != 1) {
+        return;
+    }
+    uint32_t owner;
+    if (!mutex_try_enter(&_mutex, &owner)) {
+        // Another core is reading or converting, catch up next time
+        return;
+    }
+    uint32_t head = rawHead;
+    if (head - rawTail >= RAW_BUFFERS) {
+        // The DMA lapped us, resume at the oldest block it has not overwritten
+        rawTail = head - (RAW_BUFFERS - 1);
+    }
+    if ((rawTail != head) && !_doubleBuffer.available()) {
         // fill final buffer with PCM samples
-        if (filter.Decimation == 128) {
-            Open_PDM_Filter_128(rawBuffer[rawBufferIndex], finalBuffer, 1, &filter);
-        } else {
-            Open_PDM_Filter_64(rawBuffer[rawBufferIndex], finalBuffer, 1, &filter);
-        }
+        int16_t *finalBuffer = (int16_t*)_doubleBuffer.data();
+        size_t frames = decimator.process(rawBuffer[rawTail % RAW_BUFFERS], rawBufferWords, finalBuffer);
+        size_t bytes = frames * _channels * sizeof(int16_t);
+        rawTail++;
 
         if (_cutSamples) {
-            memset(finalBuffer, 0, _cutSamples);
+            memset(finalBuffer, 0, ((size_t)_cutSamples < bytes) ? _cutSamples : bytes);
             _cutSamples = 0;
         }
 
-        // swap final buffer and raw buffers' indexes
-        finalBuffer = (int16_t*)_doubleBuffer.data();
-        _doubleBuffer.swap(filter.nSamples * sizeof(int16_t));
-        rawBufferIndex = shadowIndex;
+        _doubleBuffer.swap(bytes);
+    }
+    mutex_exit(&_mutex);
+}
+
+void PDMClass::IrqHandler(bool halftranfer) {
+    // The DMA IRQ is shared, so make sure it's ours
+    if (!dma_channel_get_irq0_status(_dmaChannel)) {
+        return;
+    }
+    // Clear the interrupt request.
+    dma_hw->ints0 = 1u << _dmaChannel;
+    // Restart dma pointing to the next buffer
+    rawHead++;
+    dma_channel_set_write_addr(_dmaChannel, rawBuffer[rawHead % RAW_BUFFERS], true);
+
+    if (!_deferred) {
+        // Only ever convert the newest block in the IRQ, the rest are stale
+        rawTail = rawHead - 1;
+        process();
     }
 
     if (_onReceive) {
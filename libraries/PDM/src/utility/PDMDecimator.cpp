@@ -0,0 +1,228 @@
+/*
+    PDM to PCM decimator: CIC, optional droop compensation, and HP/LP output filter
+
+    Copyright (c) 2024 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "PDMDecimator.h"
+
+#ifdef ARDUINO_ARCH_RP2040
+#include <pico.h>
+#else
+#define __not_in_flash_func(x) x
+#endif
+
+// Running a 3rd order integrator over 8 input bits at once:
+//   i3 += 8*i2 + 36*i1 + s3,  i2 += 8*i1 + s2,  i1 += s1
+// where s1, s2, s3 only depend on the byte and are packed here as s1 | s2<<8 | s3<<16
+static uint32_t _cic[256];
+
+static void _buildCIC() {
+    if (_cic[255]) {
+        return;
+    }
+    for (int b = 0; b < 256; b++) {
+        uint32_t s1 = 0, s2 = 0, s3 = 0;
+        for (int j = 0; j < 8; j++) {
+            if (b & (0x80 >> j)) {
+                int m = 8 - j;
+                s1 += 1;
+                s2 += m;
+                s3 += m * (m + 1) / 2;
+            }
+        }
+        _cic[b] = s1 | (s2 << 8) | (s3 << 16);
+    }
+}
+
+// Gathers the odd bits of x into the upper half and the even ones into the
+// lower, keeping their order (Hacker's Delight 7-2)
+static inline uint32_t _unzip(uint32_t x) {
+    uint32_t t;
+    t = (x ^ (x >> 1)) & 0x22222222;
+    x = x ^ t ^ (t << 1);
+    t = (x ^ (x >> 2)) & 0x0c0c0c0c;
+    x = x ^ t ^ (t << 2);
+    t = (x ^ (x >> 4)) & 0x00f000f0;
+    x = x ^ t ^ (t << 4);
+    t = (x ^ (x >> 8)) & 0x0000ff00;
+    x = x ^ t ^ (t << 8);
+    return x;
+}
+
+bool PDMDecimator::begin(int decimation, int interleave, int channels, int sampleRate, int gain) {
+    if ((decimation < 8) || (decimation > 256) || (decimation & 7)) {
+        return false;
+    }
+    if (((interleave != 1) && (interleave != 2) && (interleave != 4)) || (channels < 1) || (channels > interleave)) {
+        return false;
+    }
+    _buildCIC();
+
+    _decimation = decimation;
+    _interleave = interleave;
+    _channels = channels;
+
+    // Order of the mics within each group of interleaved bits, see pdm.pio.
+    // Stereo is falling then rising edge, quad is DIN1 then DIN0 on each edge.
+    static const uint8_t quad[4] = { 1, 3, 0, 2 };
+    for (int c = 0; c < maxChannels; c++) {
+        _pos[c] = (interleave == 4) ? quad[c] : c;
+    }
+
+    // Same types and rounding as Open_PDM_Filter_Init(), LP at Fs/2 and HP at 10Hz
+    float lp = sampleRate / 2;
+    float hp = 10;
+    uint16_t fs = sampleRate;
+    _lpAlfa = (lp != 0 ? (uint16_t)(lp * 256 / (lp + fs / (2 * 3.14159))) : 0);
+    _hpAlfa = (uint16_t)(fs * 256 / (2 * 3.14159 * hp + fs));
+
+    setGain(gain);
+    reset();
+    return true;
+}
+
+void PDMDecimator::reset() {
+    for (int c = 0; c < maxChannels; c++) {
+        _ch[c] = { };
+    }
+    _left = _decimation / 8;
+}
+
+void PDMDecimator::setGain(int gain) {
+    // The CIC sums to decimation^3 for all 1s, half that is silence
+    int64_t sum = (int64_t)_decimation * _decimation * _decimation;
+    _sub = sum >> 1;
+    _div = _sub / 32768 / ((gain > 0) ? gain : 1);
+    _div = (_div == 0) ? 1 : _div;
+}
+
+size_t PDMDecimator::frameStep() const {
+    int bits = _decimation * _interleave;
+    int step = 32;
+    while (!(bits & 1) && (step > 1)) {
+        bits >>= 1;
+        step >>= 1;
+    }
+    return step;
+}
+
+int16_t __not_in_flash_func(PDMDecimator::_output)(Channel *ch) {
+    // Open_PDM_Filter samples one bit before the end of each block, which is the
+    // last integrator before its final step
+    uint32_t s = ch->i3 - ch->i2;
+    uint32_t d1 = s - ch->c1;
+    ch->c1 = s;
+    uint32_t d2 = d1 - ch->c2;
+    ch->c2 = d1;
+    uint32_t d3 = d2 - ch->c3;
+    ch->c3 = d2;
+    int32_t z = (int32_t)d3 - _sub;
+
+    if (_compensate) {
+        // [-3 22 -3] / 16, unity at DC and +2.8dB at Fs/4
+        int32_t y = (22 * ch->z1 - 3 * (z + ch->z2)) >> 4;
+        ch->z2 = ch->z1;
+        ch->z1 = z;
+        z = y;
+    }
+
+    ch->oldOut = (_hpAlfa * (ch->oldOut + z - ch->oldIn)) >> 8;
+    ch->oldIn = z;
+    ch->oldZ = ((256 - _lpAlfa) * ch->oldZ + _lpAlfa * ch->oldOut) >> 8;
+
+    int64_t v = ch->oldZ;
+    v = (v > 0) ? ((v + _div / 2) / _div) : ((v - _div / 2) / _div);
+    if (v < -32700) {
+        v = -32700;
+    } else if (v > 32700) {
+        v = 32700;
+    }
+    return v;
+}
+
+size_t __not_in_flash_func(PDMDecimator::process)(const uint32_t *words, size_t count, int16_t *out) {
+    if (_interleave == 1) {
+        return _processMono(words, count, out);
+    }
+
+    // After unzipping, each channel's bits sit in consecutive bytes, oldest first
+    const int per = 4 / _interleave;
+    int shift[maxChannels][4];
+    for (int c = 0; c < _channels; c++) {
+        for (int k = 0; k < per; k++) {
+            shift[c][k] = 24 - 8 * (_pos[c] * per + k);
+        }
+    }
+
+    size_t frames = 0;
+    while (count--) {
+        uint32_t w = *words++;
+        if (_interleave > 1) {
+            w = _unzip(w);
+        }
+        if (_interleave > 2) {
+            w = _unzip(w);
+        }
+        for (int k = 0; k < per; k++) {
+            for (int c = 0; c < _channels; c++) {
+                Channel *ch = &_ch[c];
+                uint32_t t = _cic[(w >> shift[c][k]) & 0xff];
+                ch->i3 += 8 * ch->i2 + 36 * ch->i1 + (t >> 16);
+                ch->i2 += 8 * ch->i1 + ((t >> 8) & 0xff);
+                ch->i1 += t & 0xff;
+            }
+            if (!--_left) {
+                _left = _decimation / 8;
+                for (int c = 0; c < _channels; c++) {
+                    *out++ = _output(&_ch[c]);
+                }
+                frames++;
+            }
+        }
+    }
+    return frames;
+}
+
+// Single mic, with the integrators kept in registers
+size_t __not_in_flash_func(PDMDecimator::_processMono)(const uint32_t *words, size_t count, int16_t *out) {
+    Channel *ch = &_ch[0];
+    uint32_t i1 = ch->i1, i2 = ch->i2, i3 = ch->i3;
+    int left = _left;
+    size_t frames = 0;
+    while (count--) {
+        uint32_t w = *words++;
+        for (int k = 24; k >= 0; k -= 8) {
+            uint32_t t = _cic[(w >> k) & 0xff];
+            i3 += 8 * i2 + 36 * i1 + (t >> 16);
+            i2 += 8 * i1 + ((t >> 8) & 0xff);
+            i1 += t & 0xff;
+            if (!--left) {
+                left = _decimation / 8;
+                ch->i2 = i2;
+                ch->i3 = i3;
+                *out++ = _output(ch);
+                frames++;
+            }
+        }
+    }
+    ch->i1 = i1;
+    ch->i2 = i2;
+    ch->i3 = i3;
+    _left = left;
+    return frames;
+}
@@ -0,0 +1,80 @@
+/*
+    PDM to PCM decimator: CIC, optional droop compensation, and HP/LP output filter
+
+    Copyright (c) 2024 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+// No hardware access, so it runs the same on a host PC.  With compensation off
+// the output is bit-identical to Open_PDM_Filter_64/128 for the same settings.
+
+#include <stddef.h>
+#include <stdint.h>
+
+class PDMDecimator {
+public:
+    static constexpr int maxChannels = 4;
+
+    // decimation is PDM bits per output sample, a multiple of 8 from 8 to 256.
+    // interleave is how many mics share each input word (1, 2 or 4), of which
+    // the first channels are converted.
+    bool begin(int decimation, int interleave, int channels, int sampleRate, int gain);
+    void reset();
+    void setGain(int gain);
+
+    // 3-tap FIR after the CIC that cuts its droop at 0.2*Fs from -3dB to -1dB.
+    // Off by default, since it changes the output from the reference filter.
+    void setCompensation(bool enable) {
+        _compensate = enable;
+    }
+
+    // Converts count words as pushed by the PIO, oldest bit in the MSB, into
+    // interleaved 16-bit frames.  Returns the number of frames written.
+    size_t process(const uint32_t *words, size_t count, int16_t *out);
+
+    // Input words needed for a given number of output frames
+    size_t wordsPerFrames(size_t frames) const {
+        return frames * _decimation * _interleave / 32;
+    }
+    // Smallest frame count that fills whole words
+    size_t frameStep() const;
+
+private:
+    typedef struct {
+        uint32_t i1, i2, i3;   // Integrators, wrap around harmlessly
+        uint32_t c1, c2, c3;   // Comb delays
+        int32_t z1, z2;        // Compensation FIR history
+        int64_t oldOut, oldIn, oldZ;
+    } Channel;
+
+    int16_t _output(Channel *ch);
+    size_t _processMono(const uint32_t *words, size_t count, int16_t *out);
+
+    Channel _ch[maxChannels];
+    uint8_t _pos[maxChannels];   // Bit position of each channel in an input group
+    int _decimation = 0;
+    int _interleave = 1;
+    int _channels = 1;
+    int _left = 0;               // Input bytes per channel until the next output
+    bool _compensate = false;
+
+    int32_t _sub = 0;
+    uint32_t _div = 1;
+    uint16_t _lpAlfa = 0;
+    uint16_t _hpAlfa = 0;
+};
@@ -204,11 +204,7 @@ size_t PWMAudio::write(int16_t val, bool sync) {
     if (!_running) {
         return 0;
     }
-    // Go from signed -32K...32K to unsigned 0...64K
-    uint32_t sample = (uint32_t)(val + 0x8000);
-    // Adjust to the real range
-    sample *= _pwmScale;
-    sample >>= 16;
+    uint32_t sample = _scale(val);
     if (!_stereo) {
         // Duplicate sample since we don't care which PWM channel
         sample = (sample & 0xffff) | (sample << 16);
@@ -231,20 +227,50 @@ size_t PWMAudio::write(int16_t val, bool sync) {
 
 size_t PWMAudio::write(const uint8_t *buffer, size_t size) {
     // We can only write 16-bit chunks here
-    if (size & 0x1) {
+    if ((size & 0x1) || !_running) {
         return 0;
     }
     size_t writtenSize = 0;
-    int16_t *p = (int16_t *)buffer;
-    while (size) {
+    const int16_t *p = (const int16_t *)buffer;
+    size_t samples = size / 2;
+    // Finish any half-written stereo pair before going word-at-a-time
+    if (_stereo && _wasHolding && samples) {
         if (!write((int16_t)*p)) {
+            return 0;
+        }
+        p++;
+        samples--;
+        writtenSize += 2;
+    }
+    const size_t samplesPerWord = _stereo ? 2 : 1;
+    while (samples >= samplesPerWord) {
+        size_t words;
+        uint32_t *dest = _arb->getWriteBuffer(&words);
+        if (!dest) {
             // Blocked, stop write here
             return writtenSize;
+        }
+        words = std::min(words, samples / samplesPerWord);
+        // Convert straight into the DMA buffer
+        if (_stereo) {
+            for (size_t i = 0; i < words; i++) {
+                dest[i] = (_scale(p[0]) & 0xffff) | (_scale(p[1]) << 16);
+                p += 2;
+            }
         } else {
-            p++;
-            size -= 2;
-            writtenSize += 2;
+            for (size_t i = 0; i < words; i++) {
+                uint32_t sample = _scale(*p++);
+                // Duplicate sample since we don't care which PWM channel
+                dest[i] = (sample & 0xffff) | (sample << 16);
+            }
         }
+        _arb->commitWriteBuffer(words);
+        samples -= words * samplesPerWord;
+        writtenSize += words * samplesPerWord * 2;
+    }
+    // Odd trailing stereo sample gets held for the next write
+    if (samples && write((int16_t)*p)) {
+        writtenSize += 2;
     }
     return writtenSize;
 }
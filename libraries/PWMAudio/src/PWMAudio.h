@@ -97,6 +97,11 @@ private:
 
     AudioBufferManager *_arb;
 
+    // Go from signed -32K...32K to unsigned 0...64K, then adjust to the real range
+    inline uint32_t _scale(int16_t val) {
+        return (((uint32_t)(val + 0x8000)) * _pwmScale) >> 16;
+    }
+
     /*An accurate but brute force method to find 16bit numerator and denominator.*/
     void find_pacer_fraction(int target, uint16_t *numerator, uint16_t *denominator);
 };
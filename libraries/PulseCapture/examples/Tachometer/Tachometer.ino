@@ -0,0 +1,40 @@
+// Measures the frequency and duty cycle of a signal on GP2 while also
+// printing every high pulse width, all captured in the background by PIO.
+// For a quick test, jumper GP2 to GP3 which is generating a PWM signal.
+//
+// Released to the public domain
+
+#include <PulseCapture.h>
+
+PulseCapture cap(2);
+
+void setup() {
+  Serial.begin(115200);
+  delay(5000);
+
+  analogWriteFreq(1000);
+  analogWrite(3, 64); // 25% duty cycle
+
+  pinMode(2, INPUT);
+  if (!cap.begin()) {
+    Serial.println("Unable to start PulseCapture");
+  }
+}
+
+void loop() {
+  static uint32_t last = 0;
+  uint32_t cycles;
+
+  // Pull out pulses as they arrive, never blocking
+  while (cap.readPulse(HIGH, &cycles)) {
+    static int count = 0;
+    if (!(count++ % 1000)) {
+      Serial.printf("High pulse: %lu cycles, %lu us\n", cycles, PulseCapture::cyclesToMicros(cycles));
+    }
+  }
+
+  if (millis() - last > 1000) {
+    last = millis();
+    Serial.printf("Frequency: %.2f Hz, duty cycle: %.1f%%, overruns: %lu\n", cap.frequency(), cap.dutyCycle() * 100.0, cap.overruns());
+  }
+}
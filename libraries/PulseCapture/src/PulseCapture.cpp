@@ -0,0 +1,221 @@
+/*
+    PulseCapture - PIO and DMA based edge timestamping for the Raspberry Pi Pico
+
+    Copyright (c) 2024 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "PulseCapture.h"
+#include <hardware/clocks.h>
+#include <hardware/dma.h>
+#include <hardware/gpio.h>
+#include <stdlib.h>
+
+#ifdef USE_TINYUSB
+// For Serial when selecting TinyUSB.  Can't include in the core because Arduino IDE
+// will not link in libraries called from the core.  Instead, add the header to all
+// the standard libraries in the hope it will still catch some user cases where they
+// use these libraries.
+// See https://github.com/earlephilhower/arduino-pico/issues/167#issuecomment-848622174
+#include <Adafruit_TinyUSB.h>
+#endif
+
+#include "pulsecap.pio.h"
+static PIOProgram _pulsecapPgm(&pulsecap_program);
+
+#define PULSECAP_XMASK 0x7fffffff
+
+PulseCapture::PulseCapture(pin_size_t pin, size_t edges) {
+    _pin = pin;
+    // DMA ring wrap is at most 32KB
+    _edges = 2;
+    while ((_edges < edges) && (_edges < 8192)) {
+        _edges <<= 1;
+    }
+}
+
+PulseCapture::~PulseCapture() {
+    end();
+}
+
+bool PulseCapture::begin() {
+    if (_running) {
+        return true;
+    }
+    if (_pin >= NUM_BANK0_GPIOS) {
+        DEBUGCORE("ERROR: Illegal pin in PulseCapture (%d)\n", _pin);
+        return false;
+    }
+
+    // The DMA ring needs the buffer aligned to its size
+    size_t bytes = _edges * sizeof(uint32_t);
+    _buf = (uint32_t *)aligned_alloc(bytes, bytes);
+    if (!_buf) {
+        return false;
+    }
+    if (!_pulsecapPgm.prepare(&_pio, &_sm, &_offset)) {
+        free(_buf);
+        _buf = nullptr;
+        return false;
+    }
+    _dma = dma_claim_unused_channel(false);
+    if (_dma < 0) {
+        _pulsecapPgm.unprepare(_pio, _sm);
+        free(_buf);
+        _buf = nullptr;
+        return false;
+    }
+
+    pulsecap_program_init(_pio, _sm, _offset, _pin);
+
+    dma_channel_config c = dma_channel_get_default_config(_dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, __builtin_ctz(bytes));
+    channel_config_set_dreq(&c, pio_get_dreq(_pio, _sm, false));
+    dma_channel_configure(_dma, &c, _buf, &_pio->rxf[_sm], DMARing::COUNT, true);
+
+    _ring.begin(_dma, _buf, _edges);
+    _lastCycles = 0;
+    _inPulse = false;
+    _overruns = 0;
+    _seen = 0;
+    _seenMs = millis();
+
+    // X starts at all 1s, and the SM starts in the loop matching the current level.  If
+    // the pin changes right after we look, the SM sees that as the first edge.
+    bool level = gpio_get(_pin);
+    _lastSample = (level ? 0x80000000 : 0) | PULSECAP_XMASK;
+    pio_sm_exec(_pio, _sm, pio_encode_mov_not(pio_x, pio_null));
+    pio_sm_exec(_pio, _sm, pio_encode_jmp(_offset + (level ? pulsecap_offset_high : pulsecap_offset_low)));
+    pio_sm_set_enabled(_pio, _sm, true);
+
+    _running = true;
+    return true;
+}
+
+void PulseCapture::end() {
+    if (!_running) {
+        return;
+    }
+    pio_sm_set_enabled(_pio, _sm, false);
+    dma_channel_abort(_dma);
+    dma_channel_unclaim(_dma);
+    _pulsecapPgm.unprepare(_pio, _sm);
+    free(_buf);
+    _buf = nullptr;
+    _dma = -1;
+    _sm = -1;
+    _running = false;
+}
+
+// Cycles between two consecutive samples, see pulsecap.pio
+uint32_t PulseCapture::_width(uint32_t prev, uint32_t cur) {
+    uint32_t counts = ((prev & PULSECAP_XMASK) - (cur & PULSECAP_XMASK)) & PULSECAP_XMASK;
+    return 2 * counts + ((cur & 0x80000000) ? 3 : 2);
+}
+
+int PulseCapture::available() {
+    if (!_running) {
+        return 0;
+    }
+    bool lapped;
+    uint32_t n = _ring.available(&lapped);
+    if (lapped) {
+        // DMA lapped us.  X keeps running so times stay close, just missing these edges.
+        // Measure the next width from the sample just before the new read point.
+        _lastSample = _ring.at(_ring.consumed() - 1);
+        _overruns++;
+    }
+    return n;
+}
+
+bool PulseCapture::read(PulseEdge *edge) {
+    if (!available()) {
+        return false;
+    }
+    uint32_t s = _ring.pop();
+    _lastCycles += _width(_lastSample, s);
+    _lastSample = s;
+    edge->cycles = _lastCycles;
+    edge->level = s >> 31;
+    return true;
+}
+
+bool PulseCapture::readPulse(uint8_t state, uint32_t *cycles) {
+    PulseEdge e;
+    while (read(&e)) {
+        if (e.level == !!state) {
+            _pulseStart = e.cycles;
+            _inPulse = true;
+        } else if (_inPulse) {
+            _inPulse = false;
+            *cycles = e.cycles - _pulseStart;
+            return true;
+        }
+    }
+    return false;
+}
+
+// High and low time of the latest full period, from the newest 3 samples in the ring
+bool PulseCapture::_periods(uint32_t *high, uint32_t *low) {
+    if (!_running) {
+        return false;
+    }
+    uint64_t w = _ring.written();
+    if (w != _seen) {
+        _seen = w;
+        _seenMs = millis();
+    } else if (millis() - _seenMs > _timeoutMs) {
+        return false;
+    }
+    if (w < 3) {
+        return false;
+    }
+    uint32_t s3 = _ring.at(w - 3);
+    uint32_t s2 = _ring.at(w - 2);
+    uint32_t s1 = _ring.at(w - 1);
+    if (((s1 ^ s2) & 0x80000000) == 0 || ((s2 ^ s3) & 0x80000000) == 0) {
+        return false; // Not alternating, the FIFO must have overflowed
+    }
+    uint32_t a = _width(s3, s2);
+    uint32_t b = _width(s2, s1);
+    // The width ending in a falling edge is the high time
+    *high = (s1 & 0x80000000) ? a : b;
+    *low = (s1 & 0x80000000) ? b : a;
+    return true;
+}
+
+float PulseCapture::frequency() {
+    uint32_t high, low;
+    if (!_periods(&high, &low)) {
+        return 0.0;
+    }
+    return (float)clock_get_hz(clk_sys) / (float)(high + low);
+}
+
+float PulseCapture::dutyCycle() {
+    uint32_t high, low;
+    if (!_periods(&high, &low)) {
+        return 0.0;
+    }
+    return (float)high / (float)(high + low);
+}
+
+uint32_t PulseCapture::cyclesToMicros(uint64_t cycles) {
+    return cycles / (clock_get_hz(clk_sys) / 1000000);
+}
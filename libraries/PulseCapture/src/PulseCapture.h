@@ -0,0 +1,88 @@
+/*
+    PulseCapture - PIO and DMA based edge timestamping for the Raspberry Pi Pico
+
+    Copyright (c) 2024 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <hardware/pio.h>
+#include <DMARing.h>
+
+typedef struct {
+    uint64_t cycles; // System clock cycles since begin()
+    bool level;      // Pin level after the edge
+} PulseEdge;
+
+class PulseCapture {
+public:
+    // edges is the size of the capture ring, rounded up to a power of 2 (max 8192)
+    PulseCapture(pin_size_t pin, size_t edges = 256);
+    ~PulseCapture();
+
+    bool begin();
+    void end();
+
+    // Continuous stream of edges, oldest first
+    int available();
+    bool read(PulseEdge *edge);
+
+    // Non-blocking pulseIn(): consumes edges and returns true with the width
+    // of the next complete pulse at the given level
+    bool readPulse(uint8_t state, uint32_t *cycles);
+
+    // Measured from the two most recent periods, without consuming any edges.
+    // Returns 0 if no edge arrived within the timeout (default 1000ms).
+    float frequency();
+    float dutyCycle();
+    void setTimeout(uint32_t ms) {
+        _timeoutMs = ms;
+    }
+
+    // Number of times read() fell so far behind that edges were lost
+    uint32_t overruns() {
+        return _overruns;
+    }
+
+    static uint32_t cyclesToMicros(uint64_t cycles);
+
+private:
+    uint32_t _width(uint32_t prev, uint32_t cur);
+    bool _periods(uint32_t *high, uint32_t *low);
+
+    pin_size_t _pin;
+    size_t _edges;
+    uint32_t *_buf = nullptr;
+    bool _running = false;
+
+    PIO _pio;
+    int _sm = -1;
+    int _offset = -1;
+    int _dma = -1;
+
+    DMARing _ring;            // Edges written by the DMA and consumed by read()
+    uint32_t _lastSample = 0; // Last sample read(), to get the time to the next one
+    uint64_t _lastCycles = 0;
+    uint64_t _pulseStart = 0;
+    bool _inPulse = false;
+    uint32_t _overruns = 0;
+
+    uint64_t _seen = 0;       // For frequency() timeout
+    uint32_t _seenMs = 0;
+    uint32_t _timeoutMs = 1000;
+};
@@ -0,0 +1,58 @@
+// -------------------------------------------------- //
+// This file is autogenerated by pioasm; do not edit! //
+// -------------------------------------------------- //
+
+#pragma once
+
+#if !PICO_NO_HARDWARE
+#include "hardware/pio.h"
+#endif
+
+// -------- //
+// pulsecap //
+// -------- //
+
+#define pulsecap_wrap_target 0
+#define pulsecap_wrap 8
+
+#define pulsecap_offset_low 0u
+#define pulsecap_offset_high 5u
+
+static const uint16_t pulsecap_program_instructions[] = {
+    //     .wrap_target
+    0x00c3, //  0: jmp    pin, 3
+    0x0040, //  1: jmp    x--, 0
+    0x0000, //  2: jmp    0
+    0x4001, //  3: in     pins, 1
+    0x403f, //  4: in     x, 31
+    0x0046, //  5: jmp    x--, 6
+    0x00c5, //  6: jmp    pin, 5
+    0x4001, //  7: in     pins, 1
+    0x403f, //  8: in     x, 31
+    //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program pulsecap_program = {
+    .instructions = pulsecap_program_instructions,
+    .length = 9,
+    .origin = -1,
+};
+
+static inline pio_sm_config pulsecap_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + pulsecap_wrap_target, offset + pulsecap_wrap);
+    return c;
+}
+
+static inline void pulsecap_program_init(PIO pio, uint sm, uint offset, uint pin) {
+    pio_sm_config c = pulsecap_program_get_default_config(offset);
+    sm_config_set_in_pins(&c, pin);
+    sm_config_set_jmp_pin(&c, pin);
+    sm_config_set_in_shift(&c, false, true, 32);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_RX);
+    pio_sm_set_consecutive_pindirs(pio, sm, pin, 1, false);
+    pio_sm_init(pio, sm, offset, &c);
+}
+
+#endif
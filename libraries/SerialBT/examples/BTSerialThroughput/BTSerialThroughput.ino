@@ -0,0 +1,34 @@
+// Streams text lines over Serial-over-BT as fast as the link allows and prints
+// the throughput to the USB Serial port every few seconds.
+// Released to the public domain
+
+// Pair and connect to the "PicoW Throughput XX:XX..." device the same way as in
+// the BTSerialUppercase example, then just open the port and watch it scroll.
+
+#include <SerialBT.h>
+
+uint32_t line = 0;
+uint32_t lastReport = 0;
+
+void setup() {
+  Serial.begin(115200);
+  SerialBT.setName("PicoW Throughput 00:00:00:00:00:00");
+  SerialBT.setTXFIFOSize(4096);
+  SerialBT.begin();
+}
+
+void loop() {
+  if (!SerialBT.availableForWrite()) {
+    return; // Not connected, or the FIFO is full
+  }
+  SerialBT.printf("%08lu The quick brown fox jumps over the lazy dog\r\n", line++);
+
+  if (millis() - lastReport > 5000) {
+    lastReport = millis();
+    SerialBTStats s;
+    SerialBT.getStats(&s);
+    if (s.ms) {
+      Serial.printf("%lu bytes in %lu frames of up to %u, %lu bytes/s, %lu waits\n", s.txBytes, s.txFrames, s.frameSize, (uint32_t)((uint64_t)s.txBytes * 1000 / s.ms), s.txWaits);
+    }
+  }
+}
@@ -20,6 +20,7 @@
 
 #include "SerialBT.h"
 #include <CoreMutex.h>
+#include <algorithm>
 #define CCALLBACKNAME _SERIALBTCB
 #include <ctocppcallback.h>
 
@@ -36,6 +37,14 @@ bool SerialBT_::setFIFOSize(size_t size) {
     return true;
 }
 
+bool SerialBT_::setTXFIFOSize(size_t size) {
+    if (!size || _running) {
+        return false;
+    }
+    _txFifoSize = size + 1; // Always 1 unused entry
+    return true;
+}
+
 SerialBT_::SerialBT_() {
     mutex_init(&_mutex);
 }
@@ -53,6 +62,11 @@ void SerialBT_::begin(unsigned long baud, uint16_t config) {
     _queue = new uint8_t[_fifoSize];
     _writer = 0;
     _reader = 0;
+    _txQueue = new uint8_t[_txFifoSize];
+    _txWriter = 0;
+    _txReader = 0;
+    _frameSize = 0;
+    resetStats();
 
     // register for HCI events
     _hci_event_callback_registration.callback = PACKETHANDLERCB(SerialBT_, packetHandler);
@@ -96,6 +110,7 @@ void SerialBT_::end() {
     hci_power_control(HCI_POWER_OFF);
     __lockBluetooth();
     delete[] _queue;
+    delete[] _txQueue;
     __unlockBluetooth();
 }
 
@@ -126,6 +141,21 @@ int SerialBT_::read() {
     return -1;
 }
 
+size_t SerialBT_::read(uint8_t *p, size_t len) {
+    CoreMutex m(&_mutex);
+    if (!_running || !m) {
+        return 0;
+    }
+    size_t cnt = std::min(len, (size_t)((_fifoSize + _writer - _reader) % _fifoSize));
+    // At most 2 copies, up to the end of the queue and then from its start
+    size_t first = std::min(cnt, (size_t)(_fifoSize - _reader));
+    memcpy(p, _queue + _reader, first);
+    memcpy(p + first, _queue, cnt - first);
+    asm volatile("" ::: "memory"); // Ensure the data is read before advancing
+    _reader = (_reader + cnt) % _fifoSize;
+    return cnt;
+}
+
 bool SerialBT_::overflow() {
     if (!_running) {
         return false;
@@ -152,11 +182,17 @@ int SerialBT_::availableForWrite() {
     if (!_running || !m) {
         return 0;
     }
-    return _connected ? 1 : 0;
+    return _connected ? _txFree() : 0;
 }
 
 void SerialBT_::flush() {
-    // We always send blocking
+    CoreMutex m(&_mutex);
+    if (!_running || !m) {
+        return;
+    }
+    while (_connected && (_txReader != _txWriter)) {
+        /* noop busy wait */
+    }
 }
 
 size_t SerialBT_::write(uint8_t c) {
@@ -168,15 +204,89 @@ size_t SerialBT_::write(const uint8_t *p, size_t len) {
     if (!_running || !m || !_connected || !len)  {
         return 0;
     }
-    _writeBuff = p;
-    _writeLen = len;
+    size_t cnt = len;
+    while (cnt && _connected) {
+        size_t space = _txFree();
+        if (!space) {
+            // Full, wait for the packet handler to send something
+            _stats.txWaits++;
+            while (_connected && !_txFree()) {
+                /* noop busy wait */
+            }
+            continue;
+        }
+        // Copy as much as fits before the end of the ring
+        size_t chunk = std::min(std::min(space, cnt), (size_t)(_txFifoSize - _txWriter));
+        memcpy(_txQueue + _txWriter, p, chunk);
+        asm volatile("" ::: "memory"); // Ensure the queue is written before the writer advances
+        auto next_writer = _txWriter + chunk;
+        if (next_writer == _txFifoSize) {
+            next_writer = 0;
+        }
+        _txWriter = next_writer;
+        p += chunk;
+        cnt -= chunk;
+        __lockBluetooth();
+        if (_connected) {
+            rfcomm_request_can_send_now_event(_channelID);
+        }
+        __unlockBluetooth();
+    }
+    return len - cnt;
+}
+
+size_t SerialBT_::_txFree() {
+    return (_txFifoSize + _txReader - _txWriter - 1) % _txFifoSize;
+}
+
+// From the packet handler.  Sends frames straight from the TX queue until the
+// remote runs out of credits or the stack out of buffers, then waits for the
+// next RFCOMM_EVENT_CAN_SEND_NOW.
+void SerialBT_::_sendFrames() {
+    while (_txReader != _txWriter) {
+        if (!rfcomm_can_send_packet_now(_channelID)) {
+            rfcomm_request_can_send_now_event(_channelID);
+            return;
+        }
+        uint32_t r = _txReader;
+        uint32_t w = _txWriter;
+        // Avoid using division or mod because the HW divider could be in use
+        size_t queued = (w >= r) ? w - r : _txFifoSize - r + w;
+        size_t cnt = std::min(queued, (size_t)_frameSize);
+        size_t first = std::min(cnt, _txFifoSize - r);
+        // Assemble the frame directly in the outgoing buffer, even across the end of the queue
+        rfcomm_reserve_packet_buffer();
+        uint8_t *frame = rfcomm_get_outgoing_buffer();
+        memcpy(frame, _txQueue + r, first);
+        memcpy(frame + first, _txQueue, cnt - first);
+        if (rfcomm_send_prepared(_channelID, cnt)) {
+            rfcomm_release_packet_buffer();
+            rfcomm_request_can_send_now_event(_channelID);
+            return;
+        }
+        auto next_reader = r + cnt;
+        if (next_reader >= _txFifoSize) {
+            next_reader -= _txFifoSize;
+        }
+        _txReader = next_reader;
+        _stats.txBytes += cnt;
+        _stats.txFrames++;
+    }
+}
+
+void SerialBT_::getStats(SerialBTStats *stats) {
     __lockBluetooth();
-    rfcomm_request_can_send_now_event(_channelID);
+    *stats = _stats;
+    stats->ms = millis() - _statsStart;
+    stats->frameSize = _frameSize;
+    __unlockBluetooth();
+}
+
+void SerialBT_::resetStats() {
+    __lockBluetooth();
+    _stats = { };
+    _statsStart = millis();
     __unlockBluetooth();
-    while (_connected && _writeLen) {
-        /* noop busy wait */
-    }
-    return len;
 }
 
 SerialBT_::operator bool() {
@@ -188,7 +298,6 @@ void SerialBT_::packetHandler(uint8_t type, uint16_t channel, uint8_t *packet, u
     bd_addr_t event_addr;
     //uint8_t   rfcomm_channel_nr;
     //uint16_t  mtu;
-    int i;
 
     switch (type) {
     case HCI_EVENT_PACKET:
@@ -218,19 +327,25 @@ void SerialBT_::packetHandler(uint8_t type, uint16_t channel, uint8_t *packet, u
                 //Serial.printf("RFCOMM channel open failed, status 0x%02x\n", rfcomm_event_channel_opened_get_status(packet));
             } else {
                 _channelID = rfcomm_event_channel_opened_get_rfcomm_cid(packet);
-                //mtu = rfcomm_event_channel_opened_get_max_frame_size(packet);
+                _frameSize = rfcomm_event_channel_opened_get_max_frame_size(packet);
                 //Serial.printf("RFCOMM channel open succeeded. New RFCOMM Channel ID %u, max frame size %u\n", rfcomm_channel_id, mtu);
+                _stats = { };
+                _statsStart = millis();
                 _connected = true;
+                if (_txReader != _txWriter) {
+                    rfcomm_request_can_send_now_event(_channelID);
+                }
             }
             break;
         case RFCOMM_EVENT_CAN_SEND_NOW:
-            rfcomm_send(_channelID, (uint8_t *)_writeBuff, _writeLen);
-            _writeLen = 0;
+            _sendFrames();
             break;
         case RFCOMM_EVENT_CHANNEL_CLOSED:
             //Serial.printf("RFCOMM channel closed\n");
             _channelID = 0;
             _connected = false;
+            // Anything not sent is lost with the connection
+            _txReader = _txWriter;
             break;
 
         default:
@@ -238,22 +353,30 @@ void SerialBT_::packetHandler(uint8_t type, uint16_t channel, uint8_t *packet, u
         }
         break;
 
-    case RFCOMM_DATA_PACKET:
-        for (i = 0; i < size; i++) {
-            auto next_writer = _writer + 1;
-            if (next_writer == _fifoSize) {
-                next_writer = 0;
-            }
-            if (next_writer != _reader) {
-                _queue[_writer] = packet[i];
-                asm volatile("" ::: "memory"); // Ensure the queue is written before the written count advances
-                // Avoid using division or mod because the HW divider could be in use
-                _writer = next_writer;
-            } else {
-                _overflow = true;
-            }
+    case RFCOMM_DATA_PACKET: {
+        // Avoid using division or mod because the HW divider could be in use
+        uint32_t w = _writer;
+        uint32_t r = _reader;
+        size_t space = (r > w) ? r - w - 1 : _fifoSize - w + r - 1;
+        size_t cnt = std::min((size_t)size, space);
+        if (cnt < size) {
+            _overflow = true;
+            _stats.rxDropped += size - cnt;
         }
+        // At most 2 copies, up to the end of the queue and then from its start
+        size_t first = std::min(cnt, _fifoSize - w);
+        memcpy(_queue + w, packet, first);
+        memcpy(_queue, packet + first, cnt - first);
+        asm volatile("" ::: "memory"); // Ensure the queue is written before the written count advances
+        w += cnt;
+        if (w >= _fifoSize) {
+            w -= _fifoSize;
+        }
+        _writer = w;
+        _stats.rxBytes += cnt;
+        _stats.rxFrames++;
         break;
+    }
 
     default:
         break;
@@ -32,11 +32,23 @@
 class SerialBT_;
 extern SerialBT_ SerialBT;
 
+typedef struct {
+    uint32_t txBytes;      // Handed to the Bluetooth stack since the stats were reset
+    uint32_t txFrames;     // RFCOMM frames those bytes were sent in
+    uint32_t txWaits;      // Times write() had to wait for TX FIFO space
+    uint32_t rxBytes;
+    uint32_t rxFrames;
+    uint32_t rxDropped;    // Bytes lost because the RX FIFO was full
+    uint32_t ms;           // Time since the stats were reset
+    uint16_t frameSize;    // Largest RFCOMM frame negotiated for the connection
+} SerialBTStats;
+
 class SerialBT_ : public HardwareSerial {
 public:
     SerialBT_();
 
     bool setFIFOSize(size_t size);
+    bool setTXFIFOSize(size_t size);
     bool setName(const char *name) {
         if (_running) {
             return false;
@@ -54,6 +66,7 @@ public:
 
     virtual int peek() override;
     virtual int read() override;
+    size_t read(uint8_t *p, size_t len); // Non-blocking, returns number of bytes actually read
     virtual int available() override;
     virtual int availableForWrite() override;
     virtual void flush() override;
@@ -63,6 +76,10 @@ public:
     bool overflow();
     operator bool() override;
 
+    // Counters are reset on each new connection, or by resetStats()
+    void getStats(SerialBTStats *stats);
+    void resetStats();
+
     // ESP8266 compat
     void setDebugOutput(bool unused) {
         (void) unused;
@@ -75,6 +92,8 @@ private:
     volatile bool _connected = false;
 
     void packetHandler(uint8_t type, uint16_t channel, uint8_t *packet, uint16_t size);
+    void _sendFrames();
+    size_t _txFree();
 
     // Lockless, IRQ-handled circular queue
     uint32_t _writer;
@@ -88,8 +107,16 @@ private:
     uint8_t  _spp_service_buffer[150];
     btstack_packet_callback_registration_t _hci_event_callback_registration;
 
-    volatile int _writeLen = 0;
-    const void *_writeBuff;
+    // TX circular queue, written by the app and drained by the BT packet handler
+    // in frames of up to _frameSize bytes, as many as the remote's credits allow
+    size_t   _txFifoSize = 1024 + 1;
+    uint8_t  *_txQueue;
+    volatile uint32_t _txWriter;
+    volatile uint32_t _txReader;
+    volatile uint16_t _frameSize;
+
+    SerialBTStats _stats;
+    uint32_t _statsStart;
 
     char *_name = nullptr;
 };
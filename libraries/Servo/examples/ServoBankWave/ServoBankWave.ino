@@ -0,0 +1,26 @@
+/* ServoBankWave
+  Drives 8 servos on GP2 through GP9 from one PIO state machine, sending a
+  sine wave down the row.  All the servos move on the same frame.
+
+  Released to the public domain
+*/
+
+#include <ServoBank.h>
+
+#define SERVOS 8
+
+ServoBank bank(2, SERVOS);
+
+void setup() {
+  bank.begin();
+}
+
+void loop() {
+  float t = millis() / 1000.0;
+  bank.beginUpdate();
+  for (int i = 0; i < SERVOS; i++) {
+    bank.write(i, 90 + 80 * sin(t * 2 + i * 0.8));
+  }
+  bank.endUpdate();
+  delay(20);
+}
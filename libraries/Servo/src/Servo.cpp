@@ -115,7 +115,7 @@ void Servo::detach() {
             // Do nothing until we are stuck in the halt loop (avoid short pulses
         } while (pio_sm_get_pc(_pio, _smIdx) != servo_offset_halt + _pgmOffset);
         pio_sm_set_enabled(_pio, _smIdx, false);
-        pio_sm_unclaim(_pio, _smIdx);
+        _servoPgm.unprepare(_pio, _smIdx);
         _attached = false;
         _valueUs = DEFAULT_NEUTRAL_PULSE_WIDTH;
     }
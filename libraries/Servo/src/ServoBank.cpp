@@ -0,0 +1,309 @@
+/*
+    ServoBank - Many servo or pulse outputs from a single PIO state machine
+
+    Copyright (c) 2024 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include "ServoBank.h"
+#include <hardware/clocks.h>
+#include <hardware/dma.h>
+#include <hardware/pio.h>
+#include <algorithm>
+
+#ifdef USE_TINYUSB
+// For Serial when selecting TinyUSB.  Can't include in the core because Arduino IDE
+// will not link in libraries called from the core.  Instead, add the header to all
+// the standard libraries in the hope it will still catch some user cases where they
+// use these libraries.
+// See https://github.com/earlephilhower/arduino-pico/issues/167#issuecomment-848622174
+#include <Adafruit_TinyUSB.h>
+#endif
+
+#include "servobank.pio.h"
+static PIOProgram _servoBankPgm(&servobank_program);
+
+// Each table entry lasts its count plus this many cycles, see servobank.pio
+#define SERVOBANK_OVERHEAD 3
+// Edges closer than this many cycles are merged, which keeps every entry long
+// enough for the DMA to keep up
+#define SERVOBANK_MIN_GAP 8
+
+extern int improved_map(int value, int minIn, int maxIn, int minOut, int maxOut);
+
+static ServoBank *_bankMap[NUM_DMA_CHANNELS]; // Lets the IRQ handler find the bank for each data channel
+static int _banks = 0;
+
+ServoBank::ServoBank(pin_size_t basePin, int channels, int periodUs) {
+    _basePin = basePin;
+    _channels = channels;
+    _periodUs = periodUs;
+    for (int c = 0; c < maxChannels; c++) {
+        _minUs[c] = DEFAULT_MIN_PULSE_WIDTH;
+        _maxUs[c] = DEFAULT_MAX_PULSE_WIDTH;
+        _valueUs[c] = DEFAULT_NEUTRAL_PULSE_WIDTH;
+        _width[c] = 0;
+    }
+}
+
+ServoBank::~ServoBank() {
+    end();
+}
+
+bool ServoBank::begin() {
+    if (_running) {
+        return true;
+    }
+    if ((_channels < 1) || (_channels > maxChannels) || (_basePin + _channels > std::min(32, NUM_BANK0_GPIOS))) {
+        DEBUGCORE("ERROR: Illegal pins for ServoBank (%d + %d)\n", _basePin, _channels);
+        return false;
+    }
+
+    _period = RP2040::usToPIOCycles(_periodUs);
+    _words = 2 * (_channels + 1);
+    _tables = new uint32_t[2 * _words];
+    for (int c = 0; c < _channels; c++) {
+        _width[c] = _toCycles(_valueUs[c]);
+    }
+    _build(_tables);
+    _current = (uint32_t)_tables;
+    _dirty = false;
+    _holding = false;
+
+    if (!_servoBankPgm.prepare(&_pio, &_sm, &_offset)) {
+        // ERROR, no free slots
+        delete[] _tables;
+        _tables = nullptr;
+        return false;
+    }
+    _dataDMA = dma_claim_unused_channel(false);
+    _ctrlDMA = (_dataDMA != -1) ? dma_claim_unused_channel(false) : -1;
+    if (_ctrlDMA == -1) {
+        if (_dataDMA != -1) {
+            dma_channel_unclaim(_dataDMA);
+            _dataDMA = -1;
+        }
+        _servoBankPgm.unprepare(_pio, _sm);
+        delete[] _tables;
+        _tables = nullptr;
+        return false;
+    }
+
+    servobank_program_init(_pio, _sm, _offset, _basePin, _channels);
+
+    // The data channel plays one frame into the FIFO, then chains to the control
+    // channel which restarts it from _current.  Swapping frames is just a store.
+    dma_channel_config c = dma_channel_get_default_config(_dataDMA);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(_pio, _sm, true));
+    channel_config_set_chain_to(&c, _ctrlDMA);
+    dma_channel_configure(_dataDMA, &c, &_pio->txf[_sm], _tables, _words, false);
+
+    dma_channel_config cc = dma_channel_get_default_config(_ctrlDMA);
+    channel_config_set_transfer_data_size(&cc, DMA_SIZE_32);
+    channel_config_set_read_increment(&cc, false);
+    channel_config_set_write_increment(&cc, false);
+    dma_channel_configure(_ctrlDMA, &cc, &dma_hw->ch[_dataDMA].al3_read_addr_trig, &_current, 1, false);
+
+    // Only needed to rebuild the spare frame once the other one has started
+    _bankMap[_dataDMA] = this;
+    dma_channel_set_irq0_enabled(_dataDMA, true);
+    if (!_banks++) {
+        irq_add_shared_handler(DMA_IRQ_0, _irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+    }
+
+    pio_sm_set_enabled(_pio, _sm, true);
+    dma_channel_start(_ctrlDMA);
+    _running = true;
+    return true;
+}
+
+void ServoBank::end() {
+    if (!_running) {
+        return;
+    }
+    // Finish on a frame with every pin low, so no channel sees a short pulse
+    _holding = false;
+    for (int c = 0; c < _channels; c++) {
+        _width[c] = 0;
+    }
+    _dirty = true;
+    while (_dirty) {
+        /* Wait for the IRQ to build and queue it */
+    }
+    uint32_t quiet = _current;
+    uint32_t r;
+    do {
+        r = dma_channel_hw_addr(_dataDMA)->read_addr;
+    } while ((r < quiet) || (r > quiet + _words * sizeof(uint32_t)));
+    // Break the chain and let the last frame run out, the SM then stalls with all pins low
+    hw_write_masked(&dma_hw->ch[_dataDMA].al1_ctrl, _dataDMA << DMA_CH0_CTRL_TRIG_CHAIN_TO_LSB, DMA_CH0_CTRL_TRIG_CHAIN_TO_BITS);
+    dma_channel_wait_for_finish_blocking(_dataDMA);
+
+    dma_channel_set_irq0_enabled(_dataDMA, false);
+    _bankMap[_dataDMA] = nullptr;
+    if (!--_banks) {
+        irq_remove_handler(DMA_IRQ_0, _irq);
+    }
+    dma_channel_unclaim(_dataDMA);
+    dma_channel_unclaim(_ctrlDMA);
+    _dataDMA = -1;
+    _ctrlDMA = -1;
+    pio_sm_set_enabled(_pio, _sm, false);
+    _servoBankPgm.unprepare(_pio, _sm);
+    _sm = -1;
+    delete[] _tables;
+    _tables = nullptr;
+    _running = false;
+}
+
+void __not_in_flash_func(ServoBank::_irq)() {
+    for (int i = 0; i < NUM_DMA_CHANNELS; i++) {
+        ServoBank *b = _bankMap[i];
+        if (!b || !dma_channel_get_irq0_status(i)) {
+            continue;
+        }
+        dma_channel_acknowledge_irq0(i);
+        if (b->_dirty && !b->_holding) {
+            b->_dirty = false;
+            // The control channel has just restarted the data one on _current, so the other table is free
+            uint32_t *next = (b->_current == (uint32_t)b->_tables) ? b->_tables + b->_words : b->_tables;
+            b->_build(next);
+            b->_current = (uint32_t)next;
+        }
+    }
+}
+
+// Lays out one frame as (levels, count) pairs.  All active channels rise at the
+// start and each falls after its width, then the pins stay low until the end.
+// The number of entries is always the same, so the data DMA never needs its
+// count changed.
+void __not_in_flash_func(ServoBank::_build)(uint32_t *table) {
+    // Active channels sorted by width, insertion sort since there are so few
+    uint32_t w[maxChannels];
+    uint8_t ch[maxChannels];
+    uint32_t levels = 0;
+    int n = 0;
+    for (int c = 0; c < _channels; c++) {
+        uint32_t v = _width[c];
+        if (!v) {
+            continue;
+        }
+        levels |= 1u << c;
+        int i = n++;
+        while (i && (w[i - 1] > v)) {
+            w[i] = w[i - 1];
+            ch[i] = ch[i - 1];
+            i--;
+        }
+        w[i] = v;
+        ch[i] = c;
+    }
+
+    uint32_t *p = table;
+    uint32_t now = 0;
+    int entries = 0;
+    for (int i = 0; i < n;) {
+        uint32_t t = w[i];
+        uint32_t fall = 0;
+        while ((i < n) && (w[i] - t < SERVOBANK_MIN_GAP)) {
+            fall |= 1u << ch[i++];
+        }
+        *p++ = levels;
+        *p++ = t - now - SERVOBANK_OVERHEAD;
+        levels &= ~fall;
+        now = t;
+        entries++;
+    }
+    // Pad with the shortest possible entries, then the long low tail gives the
+    // DMA plenty of slack to restart before the next frame
+    int pads = _channels - entries;
+    for (int i = 0; i < pads; i++) {
+        *p++ = 0;
+        *p++ = 0;
+    }
+    *p++ = 0;
+    *p++ = _period - now - SERVOBANK_OVERHEAD * (pads + 1);
+}
+
+// Pulse width in PIO cycles, limited so every table entry stays valid
+uint32_t ServoBank::_toCycles(int us) {
+    if (us <= 0) {
+        return 0;
+    }
+    uint32_t cycles = RP2040::usToPIOCycles(us);
+    uint32_t most = _period - SERVOBANK_OVERHEAD * (_channels + 1) - SERVOBANK_MIN_GAP;
+    return std::max((uint32_t)SERVOBANK_MIN_GAP, std::min(most, cycles));
+}
+
+void ServoBank::setRange(int channel, int minUs, int maxUs) {
+    if ((channel < 0) || (channel >= _channels)) {
+        return;
+    }
+    _maxUs[channel] = max(0, min(_periodUs, maxUs));
+    _minUs[channel] = max(0, min(_maxUs[channel], minUs));
+}
+
+void ServoBank::write(int channel, int value) {
+    if ((channel < 0) || (channel >= _channels)) {
+        return;
+    }
+    // treat any value less than 200 as angle in degrees (values equal or larger are handled as microseconds)
+    if (value < 200) {
+        // assumed to be 0-180 degrees servo
+        value = constrain(value, 0, 180);
+        value = improved_map(value, 0, 180, _minUs[channel], _maxUs[channel]);
+    }
+    writeMicroseconds(channel, value);
+}
+
+void ServoBank::writeMicroseconds(int channel, int value) {
+    if ((channel < 0) || (channel >= _channels)) {
+        return;
+    }
+    value = constrain(value, _minUs[channel], _maxUs[channel]);
+    _valueUs[channel] = value;
+    if (_running) {
+        _width[channel] = _toCycles(value);
+        _dirty = true;
+    }
+}
+
+int ServoBank::read(int channel) {
+    if ((channel < 0) || (channel >= _channels)) {
+        return 0;
+    }
+    return improved_map(readMicroseconds(channel), _minUs[channel], _maxUs[channel], 0, 180);
+}
+
+int ServoBank::readMicroseconds(int channel) {
+    if ((channel < 0) || (channel >= _channels)) {
+        return 0;
+    }
+    return _valueUs[channel];
+}
+
+void ServoBank::beginUpdate() {
+    _holding = true;
+}
+
+void ServoBank::endUpdate() {
+    _holding = false;
+}
@@ -0,0 +1,90 @@
+/*
+    ServoBank - Many servo or pulse outputs from a single PIO state machine
+
+    Copyright (c) 2024 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+    A ServoBank drives up to 32 consecutive pins from one state machine.  Every
+    frame all channels rise together and each falls after its own pulse width.
+    The frame is a table of pin level/duration pairs which DMA replays forever,
+    so the CPU is only involved when a width changes.
+
+    Writes never block.  They're picked up at the start of the next frame, all
+    together, and anything written between beginUpdate() and endUpdate() is
+    guaranteed to land on the same frame.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <Servo.h>
+
+class ServoBank {
+public:
+    static constexpr int maxChannels = 32;
+
+    // Channel N is on pin basePin + N
+    ServoBank(pin_size_t basePin, int channels, int periodUs = REFRESH_INTERVAL);
+    ~ServoBank();
+
+    bool begin();
+    void end();
+
+    // min and max values in microseconds for write(), like Servo::attach.  Up to
+    // 0 and the frame period are allowed here, for general pulse generation.
+    void setRange(int channel, int minUs, int maxUs);
+    void write(int channel, int value);             // if value is < 200 its treated as an angle, otherwise as pulse width in microseconds
+    void writeMicroseconds(int channel, int value); // Write pulse width in microseconds, 0 (if in range) keeps the pin low
+    int read(int channel);                          // returns current pulse width as an angle between 0 and 180 degrees
+    int readMicroseconds(int channel);              // returns current pulse width in microseconds for this channel
+
+    void beginUpdate();
+    void endUpdate();
+
+    int channels() {
+        return _channels;
+    }
+
+private:
+    static void _irq();
+    void _build(uint32_t *table);
+    uint32_t _toCycles(int us);
+
+    pin_size_t _basePin;
+    int        _channels;
+    int        _periodUs;
+    bool       _running = false;
+    PIO        _pio = nullptr;
+    int        _sm = -1;
+    int        _offset = -1;
+
+    int        _minUs[maxChannels];
+    int        _maxUs[maxChannels];
+    int        _valueUs[maxChannels];
+    volatile uint32_t _width[maxChannels]; // PIO cycles, read by the IRQ
+
+    // Two frames, one being replayed by the DMA and the other free to rebuild
+    uint32_t   *_tables = nullptr;
+    volatile uint32_t _current;            // Address of the next frame, read by the control DMA
+    volatile bool _dirty = false;
+    volatile bool _holding = false;
+    uint32_t   _period;                    // Frame period in PIO cycles
+    int        _words;                     // Per table, a level and a duration for each entry
+    int        _dataDMA = -1;
+    int        _ctrlDMA = -1;
+};
@@ -0,0 +1,123 @@
+// Measures how many requests/second the WebServer can answer with several
+// clients hammering it at once.
+//
+// Flash one board as the server (the default).  It serves a small page using
+// setMaxClients() so that slow or idle connections don't hold up the others,
+// and prints the requests/second it answered.
+//
+// Flash a second board with LOADTEST_TARGET set to the server's IP address.  It
+// opens LOADTEST_CLIENTS keep-alive connections and round-robins GET requests
+// across them, printing the requests/second it saw answered.  A PC running
+// something like "ab -k -c 8 -n 10000 http://<ip>/" works as well.
+//
+// Released to the public domain
+
+#include <WiFi.h>
+#include <WebServer.h>
+
+#ifndef STASSID
+#define STASSID "your-ssid"
+#define STAPSK "your-password"
+#endif
+
+//#define LOADTEST_TARGET "192.168.1.100"
+#define LOADTEST_CLIENTS 4
+
+const char* ssid = STASSID;
+const char* password = STAPSK;
+
+uint32_t lastReport = 0;
+uint32_t count = 0;
+
+void report() {
+  if (millis() - lastReport >= 1000) {
+    Serial.printf("%lu requests/second\n", count * 1000 / (millis() - lastReport));
+    count = 0;
+    lastReport = millis();
+  }
+}
+
+#ifndef LOADTEST_TARGET
+
+WebServer server(80);
+
+void setupRole() {
+  server.setMaxClients(LOADTEST_CLIENTS);
+  server.on("/", []() {
+    count++;
+    server.send(200, "text/plain", "Hello from the concurrent server\r\n");
+  });
+  server.begin();
+  Serial.printf("Serving on http://%s/\n", WiFi.localIP().toString().c_str());
+}
+
+void loopRole() {
+  server.handleClient();
+}
+
+#else
+
+WiFiClient clients[LOADTEST_CLIENTS];
+bool waiting[LOADTEST_CLIENTS];
+
+void setupRole() {
+  Serial.printf("Loading http://%s/ with %d connections\n", LOADTEST_TARGET, LOADTEST_CLIENTS);
+}
+
+void loopRole() {
+  for (int i = 0; i < LOADTEST_CLIENTS; i++) {
+    WiFiClient &c = clients[i];
+    if (!c.connected()) {
+      waiting[i] = false;
+      if (!c.connect(LOADTEST_TARGET, 80)) {
+        continue;
+      }
+      c.setNoDelay(true);
+    }
+    if (!waiting[i]) {
+      c.print("GET / HTTP/1.1\r\nHost: " LOADTEST_TARGET "\r\n\r\n");
+      waiting[i] = true;
+    } else if (c.available()) {
+      // Skip the headers, then the body's length tells us where the response ends
+      int len = 0;
+      while (true) {
+        String line = c.readStringUntil('\n');
+        if (line.startsWith("Content-Length:")) {
+          len = line.substring(15).toInt();
+        } else if (line == "\r" || line.length() == 0) {
+          break;
+        }
+      }
+      char body[64];
+      while (len > 0) {
+        int r = c.readBytes(body, std::min(len, (int)sizeof(body)));
+        if (r <= 0) {
+          break;
+        }
+        len -= r;
+      }
+      count++;
+      waiting[i] = false;
+    }
+  }
+}
+
+#endif
+
+void setup() {
+  Serial.begin(115200);
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(ssid, password);
+  while (WiFi.status() != WL_CONNECTED) {
+    delay(500);
+    Serial.print(".");
+  }
+  Serial.println("");
+  setupRole();
+  lastReport = millis();
+}
+
+void loop() {
+  loopRole();
+  report();
+}
@@ -60,7 +60,8 @@ HTTPServer::HTTPServer()
     , _currentHeaders(nullptr)
     , _contentLength(0)
     , _clientContentLength(0)
-    , _chunked(false) {
+    , _chunked(false)
+    , _keepAlive(false) {
     log_v("HTTPServer::HTTPServer()");
 }
 
@@ -371,7 +372,7 @@ void HTTPServer::_prepareHeader(String& response, int code, const char* content_
         sendHeader(String(FPSTR("Access-Control-Allow-Methods")), String("*"));
         sendHeader(String(FPSTR("Access-Control-Allow-Headers")), String("*"));
     }
-    sendHeader(String(F("Connection")), String(F("close")));
+    sendHeader(String(F("Connection")), _keepAlive ? String(F("keep-alive")) : String(F("close")));
 
     response += _responseHeaders;
     response += "\r\n";
@@ -58,7 +58,19 @@ enum HTTPAuthMethod { BASIC_AUTH, DIGEST_AUTH };
 
 class HTTPServer;
 
-typedef struct {
+// Upload and raw buffers are large and only copied through, so they are allocated with
+// bufmalloc() and may be placed in PSRAM (see rp2040.setPSRAMPolicy)
+struct BufAllocated {
+    static void *operator new(size_t size) {
+        void *p = bufmalloc(size);
+        return p ? p : ::operator new(size);
+    }
+    static void operator delete(void *p) {
+        pfree(p);
+    }
+};
+
+typedef struct HTTPUpload : BufAllocated {
     HTTPUploadStatus status;
     String  filename;
     String  name;
@@ -69,7 +81,7 @@ typedef struct {
 } HTTPUpload;
 
 
-typedef struct {
+typedef struct HTTPRaw : BufAllocated {
     HTTPRawStatus status;
     size_t  totalSize;   // content size
     size_t  currentSize; // size of data currently in buf
@@ -243,6 +255,7 @@ protected:
     void _handleRequest();
     void _finalizeResponse();
     ClientFuture _parseRequest(WiFiClient* client);
+    static size_t _requestLength(const uint8_t *buf, size_t len, size_t bufSize);
     void _parseArguments(String data);
     static String _responseCodeToString(int code);
     bool _parseForm(WiFiClient* client, String boundary, uint32_t len);
@@ -295,6 +308,7 @@ protected:
 
     String           _hostHeader;
     bool             _chunked;
+    bool             _keepAlive;   // Connection may be reused after this response
 
     String           _snonce;  // Store noance and opaque for future comparison
     String           _sopaque;
@@ -100,6 +100,9 @@ HTTPServer::ClientFuture HTTPServer::_parseRequest(WiFiClient* client) {
     String url = req.substring(addr_start + 1, addr_end);
     String versionEnd = req.substring(addr_end + 8);
     _currentVersion = atoi(versionEnd.c_str());
+    if (_currentVersion == 0) {
+        _keepAlive = false; // HTTP/1.0 has no persistent connections
+    }
     String searchStr = "";
     int hasSearch = url.indexOf('?');
     if (hasSearch != -1) {
@@ -185,6 +188,8 @@ HTTPServer::ClientFuture HTTPServer::_parseRequest(WiFiClient* client) {
                 _clientContentLength = headerValue.toInt();
             } else if (headerName.equalsIgnoreCase(F("Host"))) {
                 _hostHeader = headerValue;
+            } else if (headerName.equalsIgnoreCase(F("Connection")) && headerValue.equalsIgnoreCase(F("close"))) {
+                _keepAlive = false;
             }
         }
 
@@ -270,6 +275,8 @@ HTTPServer::ClientFuture HTTPServer::_parseRequest(WiFiClient* client) {
 
             if (headerName.equalsIgnoreCase("Host")) {
                 _hostHeader = headerValue;
+            } else if (headerName.equalsIgnoreCase("Connection") && headerValue.equalsIgnoreCase("close")) {
+                _keepAlive = false;
             }
         }
         _parseArguments(searchStr);
@@ -282,6 +289,35 @@ HTTPServer::ClientFuture HTTPServer::_parseRequest(WiFiClient* client) {
     return CLIENT_REQUEST_CAN_CONTINUE;
 }
 
+size_t HTTPServer::_requestLength(const uint8_t *buf, size_t len, size_t bufSize) {
+    // Find the blank line ending the request line and headers
+    size_t head = 0;
+    for (size_t i = 3; i < len; i++) {
+        if (buf[i] == '\n' && buf[i - 1] == '\r' && buf[i - 2] == '\n' && buf[i - 3] == '\r') {
+            head = i + 1;
+            break;
+        }
+    }
+    if (!head) {
+        return 0;
+    }
+
+    // If there is a body which fits in the buffer, wait for all of it so the
+    // parser never has to block.  Larger bodies are streamed as before.
+    static const char cl[] = "\r\ncontent-length:";
+    const size_t cllen = sizeof(cl) - 1;
+    for (size_t i = 0; i + cllen < head; i++) {
+        if (!strncasecmp((const char *)buf + i, cl, cllen)) {
+            size_t body = strtoul((const char *)buf + i + cllen, nullptr, 10);
+            if (head + body <= bufSize) {
+                return (len >= head + body) ? head + body : 0;
+            }
+            break;
+        }
+    }
+    return head;
+}
+
 bool HTTPServer::_collectHeader(const char* headerName, const char* headerValue) {
     for (int i = 0; i < _headerKeysCount; i++) {
         if (_currentHeaders[i].key.equalsIgnoreCase(headerName)) {
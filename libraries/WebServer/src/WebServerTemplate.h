@@ -22,6 +22,10 @@
 
 #include "HTTPServer.h"
 
+#ifndef WEBSERVER_CLIENT_BUFLEN
+#define WEBSERVER_CLIENT_BUFLEN 1024 // Per-connection request buffer in concurrent mode
+#endif
+
 template<typename ServerType, int DefaultPort = 80>
 class WebServerTemplate;
 
@@ -42,6 +46,12 @@ public:
     virtual void close();
     virtual void stop();
 
+    // Serve up to maxClients connections at once instead of one at a time.
+    // Each connection gets a WEBSERVER_CLIENT_BUFLEN buffer and is only handed
+    // to the request handlers once its request has fully arrived.  1 restores
+    // the original blocking, single client behavior.
+    void setMaxClients(int maxClients);
+
     ServerType &getServer() {
         return _server;
     }
@@ -53,6 +63,83 @@ public:
 
 private:
     ServerType _server;
+
+    // A client which first replays the bytes collected while its request
+    // was arriving, so _parseRequest() and hooks can read it as usual
+    class BufferedClient : public ClientType {
+    public:
+        BufferedClient(const ClientType &c, uint8_t *buf) : ClientType(c), _buf(buf) { }
+
+        // Pull whatever the connection has ready into the buffer without blocking
+        void fill() {
+            if (_pos && (_pos == _len)) {
+                _pos = _len = 0;
+            } else if (_pos) {
+                memmove(_buf, _buf + _pos, _len - _pos);
+                _len -= _pos;
+                _pos = 0;
+            }
+            int avail = ClientType::available();
+            if ((avail > 0) && (_len < WEBSERVER_CLIENT_BUFLEN)) {
+                int r = ClientType::read(_buf + _len, std::min((size_t)avail, (size_t)(WEBSERVER_CLIENT_BUFLEN - _len)));
+                if (r > 0) {
+                    _len += r;
+                }
+            }
+        }
+
+        const uint8_t *buffered() const {
+            return _buf + _pos;
+        }
+        size_t bufferedLen() const {
+            return _len - _pos;
+        }
+
+        int available() override {
+            return (_len - _pos) + ClientType::available();
+        }
+        int read() override {
+            return (_pos < _len) ? _buf[_pos++] : ClientType::read();
+        }
+        int read(uint8_t *buf, size_t size) override {
+            if (_pos == _len) {
+                return ClientType::read(buf, size);
+            }
+            size_t n = std::min(size, _len - _pos);
+            memcpy(buf, _buf + _pos, n);
+            _pos += n;
+            return n;
+        }
+        int peek() override {
+            return (_pos < _len) ? _buf[_pos] : ClientType::peek();
+        }
+        size_t peekBytes(uint8_t *buf, size_t size) override {
+            if (_pos == _len) {
+                return ClientType::peekBytes(buf, size);
+            }
+            size_t n = std::min(size, _len - _pos);
+            memcpy(buf, _buf + _pos, n);
+            return n;
+        }
+
+    private:
+        uint8_t *_buf;
+        size_t _len = 0;
+        size_t _pos = 0;
+    };
+
+    struct ClientSlot {
+        BufferedClient *client;
+        unsigned long statusChange;
+        bool idle; // Between requests on a kept-alive connection
+    };
+
+    void _handleClients();
+    void _freeSlot(ClientSlot &slot, bool stop);
+
+    int _maxClients = 1;
+    ClientSlot *_slots = nullptr;
+    uint8_t *_slotBuffers = nullptr; // Fixed pool, WEBSERVER_CLIENT_BUFLEN per slot
 };
 
 template <typename ServerType, int DefaultPort>
@@ -66,6 +153,124 @@ WebServerTemplate<ServerType, DefaultPort>::WebServerTemplate(int port) : HTTPSe
 template <typename ServerType, int DefaultPort>
 WebServerTemplate<ServerType, DefaultPort>::~WebServerTemplate() {
     _server.close();
+    setMaxClients(1);
+}
+
+template <typename ServerType, int DefaultPort>
+void WebServerTemplate<ServerType, DefaultPort>::setMaxClients(int maxClients) {
+    if (_slots) {
+        for (int i = 0; i < _maxClients; i++) {
+            _freeSlot(_slots[i], true);
+        }
+        delete[] _slots;
+        delete[] _slotBuffers;
+        _slots = nullptr;
+        _slotBuffers = nullptr;
+    }
+    _maxClients = std::max(1, maxClients);
+    if (_maxClients > 1) {
+        _slots = new ClientSlot[_maxClients]();
+        _slotBuffers = new uint8_t[_maxClients * WEBSERVER_CLIENT_BUFLEN];
+    }
+}
+
+template <typename ServerType, int DefaultPort>
+void WebServerTemplate<ServerType, DefaultPort>::_freeSlot(ClientSlot &slot, bool stop) {
+    if (slot.client) {
+        if (stop) {
+            slot.client->stop();
+        }
+        delete slot.client;
+        slot.client = nullptr;
+    }
+}
+
+template <typename ServerType, int DefaultPort>
+void WebServerTemplate<ServerType, DefaultPort>::_handleClients() {
+    // Accept new connections into any free slots
+    for (int i = 0; i < _maxClients; i++) {
+        if (!_slots[i].client) {
+            if (!_server.hasClient()) {
+                break;
+            }
+            _slots[i].client = new BufferedClient(_server.accept(), _slotBuffers + i * WEBSERVER_CLIENT_BUFLEN);
+            _slots[i].statusChange = millis();
+            _slots[i].idle = false;
+        }
+    }
+
+    bool busy = false;
+    for (int i = 0; i < _maxClients; i++) {
+        ClientSlot &slot = _slots[i];
+        if (!slot.client) {
+            continue;
+        }
+        if (!slot.client->connected() && !slot.client->available()) {
+            _freeSlot(slot, false);
+            continue;
+        }
+
+        // Only parse once the whole request (or at least its headers) is here
+        slot.client->fill();
+        if (slot.idle && slot.client->bufferedLen()) {
+            // Next request on a kept-alive connection has started
+            slot.idle = false;
+            slot.statusChange = millis();
+        }
+        size_t reqLen = _requestLength(slot.client->buffered(), slot.client->bufferedLen(), WEBSERVER_CLIENT_BUFLEN);
+        if (!reqLen) {
+            unsigned long timeSinceChange = millis() - slot.statusChange;
+            if (slot.client->bufferedLen() == WEBSERVER_CLIENT_BUFLEN) {
+                // Headers will never fit
+                _freeSlot(slot, true);
+            } else if (timeSinceChange > (slot.idle ? HTTP_MAX_CLOSE_WAIT : HTTP_MAX_DATA_WAIT)) {
+                _freeSlot(slot, true);
+            }
+            continue;
+        }
+
+        busy = true;
+        _currentClient = slot.client;
+        _currentStatus = HC_WAIT_READ;
+        _keepAlive = true;
+        _currentClient->setTimeout(HTTP_MAX_SEND_WAIT);
+        bool keep = false;
+        bool stop = true;
+        switch (_parseRequest(_currentClient)) {
+        case CLIENT_REQUEST_CAN_CONTINUE:
+            _contentLength = CONTENT_LENGTH_NOT_SET;
+            _handleRequest();
+        /* fallthrough */
+        case CLIENT_REQUEST_IS_HANDLED:
+            keep = _keepAlive && _currentClient->connected();
+            break;
+        case CLIENT_MUST_STOP:
+            break;
+        case CLIENT_IS_GIVEN:
+            // Connection now belongs to someone else (i.e. a websocket)
+            stop = false;
+            break;
+        }
+        if (keep) {
+            slot.idle = true;
+            slot.statusChange = millis();
+        } else {
+            _freeSlot(slot, stop);
+        }
+        _currentClient = nullptr;
+        _currentStatus = HC_NONE;
+        _keepAlive = false;
+        _currentUpload.reset();
+        _currentRaw.reset();
+    }
+
+    if (!busy) {
+        if (_nullDelay) {
+            delay(1);
+        } else {
+            yield();
+        }
+    }
 }
 
 template <typename ServerType, int DefaultPort>
@@ -84,6 +289,11 @@ void WebServerTemplate<ServerType, DefaultPort>::begin(uint16_t port) {
 
 template <typename ServerType, int DefaultPort>
 void WebServerTemplate<ServerType, DefaultPort>::handleClient() {
+    if (_maxClients > 1) {
+        _handleClients();
+        return;
+    }
+
     if (_currentStatus == HC_NONE) {
         if (_currentClient) {
             delete _currentClient;
@@ -181,6 +391,9 @@ void WebServerTemplate<ServerType, DefaultPort>::handleClient() {
 
 template <typename ServerType, int DefaultPort>
 void WebServerTemplate<ServerType, DefaultPort>::close() {
+    for (int i = 0; _slots && (i < _maxClients); i++) {
+        _freeSlot(_slots[i], true);
+    }
     _server.close();
     httpClose();
 }
@@ -111,9 +111,20 @@ void loop() {
   Serial.printf("Connecting without sessions...");
   start = millis();
   client.setTrustAnchors(&cert);
+  client.setSessionCache(nullptr);  // No per-host cache, the default
   fetchURL(&client, host, port, path);
   finish = millis();
-  Serial.printf("Total time: %lums\n", finish - start);
+  Serial.printf("Total time: %lums, handshake %luus\n", finish - start, client.getHandshakeTime());
+
+  Serial.printf("Connecting twice with the shared session cache...");
+  client.setSessionCache(BearSSL::SessionCache::shared());
+  for (int i = 0; i < 2; i++) {
+    start = millis();
+    client.setTrustAnchors(&cert);
+    fetchURL(&client, host, port, path);
+    finish = millis();
+    Serial.printf("Total time: %lums, handshake %luus, %s\n", finish - start, client.getHandshakeTime(), client.sessionResumed() ? "resumed" : "full");
+  }
 
   BearSSL::Session session;
   client.setSession(&session);
@@ -138,5 +149,11 @@ void loop() {
   finish = millis();
   Serial.printf("Total time: %lums\n", finish - start);
 
+  BearSSL::HandshakeStats stats;
+  BearSSL::WiFiClientSecure::getHandshakeStats(&stats);
+  Serial.printf("Handshakes so far: %lu full averaging %lums, %lu resumed averaging %lums\n",
+                stats.full, stats.full ? (uint32_t)(stats.fullUs / stats.full / 1000) : 0,
+                stats.resumed, stats.resumed ? (uint32_t)(stats.resumedUs / stats.resumed / 1000) : 0);
+
   delay(10000);  // Avoid DDOSing github
 }
@@ -29,6 +29,7 @@
 #include <string.h>
 #include <Arduino.h>
 #include "StackThunk.h"
+#include <FS.h>
 
 #include <Updater_Signing.h>
 #ifndef ARDUINO_SIGNING
@@ -877,24 +878,308 @@ bool X509List::append(const uint8_t *derCert, size_t derLen) {
     return true;
 }
 
+// Cache file layout: magic, entry count, then the raw entries
+static constexpr uint32_t _sessionFileMagic = 0x53534c31; // "SSL1"
+
+uint32_t SessionCache::_hash(const char *host, uint16_t port, uint32_t trust) {
+    // FNV-1a.  A collision only means offering a server a session it will not
+    // know, so it falls back to a full handshake.
+    uint32_t h = 2166136261UL;
+    while (host && *host) {
+        h = (h ^ (uint8_t)*host++) * 16777619UL;
+    }
+    h = (h ^ (port & 0xff)) * 16777619UL;
+    h = (h ^ (port >> 8)) * 16777619UL;
+    for (int i = 0; i < 32; i += 8) {
+        h = (h ^ ((trust >> i) & 0xff)) * 16777619UL;
+    }
+    return h ? h : 1;
+}
+
+bool SessionCache::_alloc() {
+    if (!_cache && _entries) {
+        _cache = new (std::nothrow) Entry[_entries];
+        if (_cache) {
+            memset(_cache, 0, _entries * sizeof(Entry));
+        }
+    }
+    return _cache != nullptr;
+}
+
+// The least recently used entry (unused ones have used == 0)
+SessionCache::Entry *SessionCache::_victim() {
+    Entry *e = &_cache[0];
+    for (int i = 1; i < _entries; i++) {
+        if (_cache[i].used < e->used) {
+            e = &_cache[i];
+        }
+    }
+    return e;
+}
+
+SessionCache::Entry *SessionCache::_find(uint32_t hash) {
+    for (int i = 0; _cache && (i < _entries); i++) {
+        if (_cache[i].hash == hash) {
+            return &_cache[i];
+        }
+    }
+    return nullptr;
+}
+
+bool SessionCache::get(const char *host, uint16_t port, br_ssl_session_parameters *params, uint32_t trust) {
+    CoreMutex m(&_mutex);
+    if (!m) {
+        return false;
+    }
+    Entry *e = _find(_hash(host, port, trust));
+    if (!e) {
+        return false;
+    }
+    e->used = ++_stamp;
+    memcpy(params, &e->params, sizeof(*params));
+    return true;
+}
+
+void SessionCache::put(const char *host, uint16_t port, const br_ssl_session_parameters *params, uint32_t trust) {
+    CoreMutex m(&_mutex);
+    if (!m || !params->session_id_len || !_alloc()) {
+        return;
+    }
+    uint32_t hash = _hash(host, port, trust);
+    Entry *e = _find(hash);
+    if (!e) {
+        e = _victim();
+    }
+    e->hash = hash;
+    e->used = ++_stamp;
+    memcpy(&e->params, params, sizeof(*params));
+}
+
+void SessionCache::remove(const char *host, uint16_t port, uint32_t trust) {
+    CoreMutex m(&_mutex);
+    if (!m) {
+        return;
+    }
+    Entry *e = _find(_hash(host, port, trust));
+    if (e) {
+        memset(e, 0, sizeof(*e));
+    }
+}
+
+void SessionCache::clear() {
+    CoreMutex m(&_mutex);
+    if (m) {
+        _clear();
+    }
+}
+
+void SessionCache::_clear() {
+    if (_cache) {
+        memset(_cache, 0, _entries * sizeof(Entry));
+    }
+}
+
+bool SessionCache::save(fs::FS &fs, const char *path) {
+    CoreMutex m(&_mutex);
+    if (!m) {
+        return false;
+    }
+    File f = fs.open(path, "w");
+    if (!f) {
+        return false;
+    }
+    uint32_t hdr[2] = { _sessionFileMagic, 0 };
+    for (int i = 0; _cache && (i < _entries); i++) {
+        hdr[1] += _cache[i].hash ? 1 : 0;
+    }
+    bool ok = f.write((const uint8_t *)hdr, sizeof(hdr)) == sizeof(hdr);
+    for (int i = 0; ok && _cache && (i < _entries); i++) {
+        if (_cache[i].hash) {
+            ok = f.write((const uint8_t *)&_cache[i], sizeof(Entry)) == sizeof(Entry);
+        }
+    }
+    f.close();
+    return ok;
+}
+
+bool SessionCache::load(fs::FS &fs, const char *path) {
+    CoreMutex m(&_mutex);
+    if (!m) {
+        return false;
+    }
+    File f = fs.open(path, "r");
+    if (!f) {
+        return false;
+    }
+    uint32_t hdr[2];
+    if ((f.read((uint8_t *)hdr, sizeof(hdr)) != sizeof(hdr)) || (hdr[0] != _sessionFileMagic) || !_alloc()) {
+        f.close();
+        return false;
+    }
+    _clear();
+    _stamp = 0;
+    for (uint32_t i = 0; i < hdr[1]; i++) {
+        Entry e;
+        if (f.read((uint8_t *)&e, sizeof(e)) != sizeof(e)) {
+            break;
+        }
+        if (!e.hash || !e.params.session_id_len) {
+            continue;
+        }
+        Entry *n = _find(e.hash);
+        *(n ? n : _victim()) = e;
+        _stamp = std::max(_stamp, e.used);
+    }
+    f.close();
+    return true;
+}
+
+SessionCache *SessionCache::shared() {
+    static SessionCache cache;
+    return &cache;
+}
+
 ServerSessions::~ServerSessions() {
     if (_isDynamic && _store != nullptr) {
-        delete _store;
+        delete[] _store;
     }
 }
 
 ServerSessions::ServerSessions(ServerSession *sessions, uint32_t size, bool isDynamic) :
     _size(sessions != nullptr ? size : 0),
     _store(sessions), _isDynamic(isDynamic) {
+    static_assert(sizeof(Entry) <= sizeof(ServerSession), "ServerSession too small");
     if (_size > 0) {
-        br_ssl_session_cache_lru_init(&_cache, (uint8_t*)_store, size * sizeof(ServerSession));
+        memset(_store, 0, _size * sizeof(ServerSession));
     }
+    _cache.vtable = &_vtable;
+    _cache.owner = this;
 }
 
+const br_ssl_session_cache_class ServerSessions::_vtable = {
+    sizeof(_cache), ServerSessions::_save, ServerSessions::_load
+};
+
 const br_ssl_session_cache_class **ServerSessions::getCache() {
     return _size > 0 ? &_cache.vtable : nullptr;
 }
 
+// Entries in the store may be unaligned, so they're always copied in and out
+int ServerSessions::_find(const unsigned char *id, size_t len) {
+    for (uint32_t i = 0; i < _size; i++) {
+        Entry e;
+        memcpy(&e, _store[i], sizeof(e));
+        if ((e.params.session_id_len == len) && !memcmp(e.params.session_id, id, len)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void ServerSessions::_save(const br_ssl_session_cache_class **ctx, br_ssl_server_context *server_ctx, const br_ssl_session_parameters *params) {
+    (void) server_ctx;
+    ServerSessions *me = ((decltype(_cache) *)ctx)->owner;
+    if (!me->_size) {
+        return;
+    }
+    int idx = me->_find(params->session_id, params->session_id_len);
+    if (idx < 0) {
+        // Evict the least recently used (unused entries have used == 0)
+        uint32_t oldest = 0xffffffff;
+        for (uint32_t i = 0; i < me->_size; i++) {
+            uint32_t used;
+            memcpy(&used, me->_store[i], sizeof(used)); // Entry::used is first
+            if (used < oldest) {
+                oldest = used;
+                idx = i;
+            }
+        }
+    }
+    if ((idx < 0) || ((uint32_t)idx >= me->_size)) {
+        return;
+    }
+    Entry e;
+    e.used = ++me->_stamp;
+    memcpy(&e.params, params, sizeof(e.params));
+    memcpy(me->_store[idx], &e, sizeof(e));
+}
+
+int ServerSessions::_load(const br_ssl_session_cache_class **ctx, br_ssl_server_context *server_ctx, br_ssl_session_parameters *params) {
+    (void) server_ctx;
+    ServerSessions *me = ((decltype(_cache) *)ctx)->owner;
+    int idx = params->session_id_len ? me->_find(params->session_id, params->session_id_len) : -1;
+    if (idx < 0) {
+        me->_misses++;
+        return 0;
+    }
+    Entry e;
+    memcpy(&e, me->_store[idx], sizeof(e));
+    memcpy(params, &e.params, sizeof(*params));
+    e.used = ++me->_stamp;
+    memcpy(me->_store[idx], &e, sizeof(e));
+    // BearSSL can still refuse it for a different version or cipher, so it's only
+    // counted as a hit once the handshake has finished with this session ID
+    memcpy(me->_offered, params->session_id, params->session_id_len);
+    me->_offeredLen = params->session_id_len;
+    return 1;
+}
+
+bool ServerSessions::_handshakeDone(bool ok, const br_ssl_engine_context *eng) {
+    bool resumed = false;
+    if (_offeredLen) {
+        resumed = ok && (eng->session.session_id_len == _offeredLen) && !memcmp(eng->session.session_id, _offered, _offeredLen);
+        if (resumed) {
+            _hits++;
+        } else {
+            _misses++;
+        }
+    }
+    _offeredLen = 0;
+    return resumed;
+}
+
+bool ServerSessions::save(fs::FS &fs, const char *path) {
+    File f = fs.open(path, "w");
+    if (!f) {
+        return false;
+    }
+    uint32_t hdr[2] = { _sessionFileMagic, _size };
+    bool ok = f.write((const uint8_t *)hdr, sizeof(hdr)) == sizeof(hdr);
+    for (uint32_t i = 0; ok && (i < _size); i++) {
+        ok = f.write(_store[i], sizeof(Entry)) == sizeof(Entry);
+    }
+    f.close();
+    return ok;
+}
+
+bool ServerSessions::load(fs::FS &fs, const char *path) {
+    if (!_size) {
+        return false;
+    }
+    File f = fs.open(path, "r");
+    if (!f) {
+        return false;
+    }
+    uint32_t hdr[2];
+    if ((f.read((uint8_t *)hdr, sizeof(hdr)) != sizeof(hdr)) || (hdr[0] != _sessionFileMagic)) {
+        f.close();
+        return false;
+    }
+    // If the saved cache was bigger than this one, later entries push out earlier ones
+    _stamp = 0;
+    for (uint32_t i = 0; i < hdr[1]; i++) {
+        Entry e;
+        if (f.read((uint8_t *)&e, sizeof(e)) != sizeof(e)) {
+            break;
+        }
+        if (e.params.session_id_len) {
+            _save(&_cache.vtable, nullptr, &e.params);
+        }
+    }
+    f.close();
+    return true;
+}
+
 // SHA256 hash for updater
 void HashSHA256::begin() {
     br_sha256_init(&_cc);
@@ -26,6 +26,11 @@
 #include <bearssl/bearssl.h>
 #include <Updater.h>
 #include <StackThunk.h>
+#include <CoreMutex.h>
+
+namespace fs {
+class FS;
+};
 
 // Internal opaque structures, not needed by user applications
 namespace brssl {
@@ -154,6 +159,56 @@ private:
     br_ssl_session_parameters _session;
 };
 
+// Per-host cache of TLS client sessions, so reconnecting to a server can skip the
+// full key exchange.  Opt-in: a WiFiClientSecure only uses one given to it with
+// setSessionCache (i.e. SessionCache::shared()).  Safe to share between cores.
+class SessionCache {
+public:
+    SessionCache(uint8_t entries = 4) : _entries(entries) {
+        mutex_init(&_mutex);
+    }
+    ~SessionCache() {
+        delete[] _cache;
+    }
+
+    // Returns true and fills in params if there is a session for this host.  trust
+    // identifies how the server was validated, so a session is only resumed by a
+    // client that would have accepted the same server.
+    bool get(const char *host, uint16_t port, br_ssl_session_parameters *params, uint32_t trust = 0);
+    void put(const char *host, uint16_t port, const br_ssl_session_parameters *params, uint32_t trust = 0);
+    void remove(const char *host, uint16_t port, uint32_t trust = 0);
+    void clear();
+
+    // Persist the cache so sessions survive a reboot.  The file holds the session
+    // master secrets, so only use this on a filesystem nobody else can read.
+    bool save(fs::FS &fs, const char *path);
+    bool load(fs::FS &fs, const char *path);
+
+    uint8_t size() {
+        return _entries;
+    }
+
+    static SessionCache *shared();
+
+private:
+    typedef struct {
+        uint32_t hash; // Of host and port, 0 if unused
+        uint32_t used; // LRU stamp
+        br_ssl_session_parameters params;
+    } Entry;
+
+    static uint32_t _hash(const char *host, uint16_t port, uint32_t trust);
+    Entry *_find(uint32_t hash);
+    Entry *_victim();
+    bool _alloc();
+    void _clear();
+
+    mutex_t _mutex;
+    uint8_t _entries;
+    Entry *_cache = nullptr;
+    uint32_t _stamp = 0;
+};
+
 // Represents a single server session.
 // Use with BearSSL::ServerSessions.
 typedef uint8_t ServerSession[100];
@@ -179,22 +234,56 @@ public:
         return _size;
     }
 
+    // Persist the sessions so clients can still resume them after the server reboots.
+    // The file holds the session master secrets, so keep it private.
+    bool save(fs::FS &fs, const char *path);
+    bool load(fs::FS &fs, const char *path);
+
+    // Number of client handshakes that resumed a cached session, or needed a full one
+    uint32_t hits() {
+        return _hits;
+    }
+    uint32_t misses() {
+        return _misses;
+    }
+
 private:
     ServerSessions(ServerSession *sessions, uint32_t size, bool isDynamic);
 
     // Returns the cache's vtable or null if the cache has no capacity.
     const br_ssl_session_cache_class **getCache();
 
+    typedef struct {
+        uint32_t used; // LRU stamp
+        br_ssl_session_parameters params; // session_id_len is 0 if unused
+    } Entry;
+
+    static void _save(const br_ssl_session_cache_class **ctx, br_ssl_server_context *server_ctx, const br_ssl_session_parameters *params);
+    static int _load(const br_ssl_session_cache_class **ctx, br_ssl_server_context *server_ctx, br_ssl_session_parameters *params);
+    static const br_ssl_session_cache_class _vtable;
+    int _find(const unsigned char *id, size_t len);
+    // Called by the server after each handshake, returns whether the offered session was resumed
+    bool _handshakeDone(bool ok, const br_ssl_engine_context *eng);
+
     // Size of the store in sessions.
     uint32_t _size;
-    // Store where the information for the sessions are stored.
+    // Store where the information for the sessions are stored, as unaligned Entry's.
     ServerSession *_store;
     // Whether the store is dynamically allocated.
     // If this is true, the store needs to be freed in the destructor.
     bool _isDynamic;
 
-    // Cache of the server using the _store.
-    br_ssl_session_cache_lru _cache;
+    uint32_t _stamp = 0;
+    uint32_t _hits = 0;
+    uint32_t _misses = 0;
+    unsigned char _offered[32]; // Session found by _load in the running handshake
+    uint8_t _offeredLen = 0;
+
+    // The BearSSL cache object handed to the server engine
+    struct {
+        const br_ssl_session_cache_class *vtable;
+        ServerSessions *owner;
+    } _cache;
 };
 
 
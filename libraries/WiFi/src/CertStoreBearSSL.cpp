@@ -19,6 +19,7 @@
 
 #include "CertStoreBearSSL.h"
 #include <memory>
+#include <algorithm>
 
 
 #if defined(DEBUG_RP2040_CORE) && defined(DEBUG_RP2040_PORT)
@@ -41,6 +42,36 @@ extern "C" {
 CertStore::~CertStore() {
     free(_indexName);
     free(_dataName);
+    // Nothing can still be verifying against a destroyed store, so free it all
+    for (int i = 0; i < CERTSTORE_TA_CACHE; i++) {
+        delete _taCache[i].x509;
+        _taCache[i].x509 = nullptr;
+    }
+    while (_retired) {
+        RetiredTA *next = _retired->next;
+        delete _retired->x509;
+        delete _retired;
+        _retired = next;
+    }
+    _clearCache();
+}
+
+void CertStore::_clearCache() {
+    for (int i = 0; i < CERTSTORE_TA_CACHE; i++) {
+        CachedTA *c = &_taCache[i];
+        if (c->x509 && c->refs) {
+            // A handshake in progress still points into this one
+            if (!_retire(c->x509, c->refs)) {
+                DEBUG_BSSL("CertStore::_clearCache: OOM, leaking busy TA\n");
+            }
+        } else {
+            delete c->x509;
+        }
+    }
+    memset(_taCache, 0, sizeof(_taCache));
+    free(_index);
+    _index = nullptr;
+    _indexCount = 0;
 }
 
 CertStore::CertInfo CertStore::_preprocessCert(uint32_t length, uint32_t offset, const void *raw) {
@@ -88,9 +119,12 @@ int CertStore::initCertStore(fs::FS &fs, const char *indexFileName, const char *
 
     _fs = &fs;
 
-    // In case initCertStore called multiple times, don't leak old filenames
+    // In case initCertStore called multiple times, don't leak old filenames or TAs
     free(_indexName);
     free(_dataName);
+    _clearCache();
+    _trustHash = 0;
+    uint32_t hash = 2166136261UL;
 
     // No strdup_P, so manually do it
     _indexName = (char *)malloc(strlen_P(indexFileName) + 1);
@@ -148,12 +182,16 @@ int CertStore::initCertStore(fs::FS &fs, const char *indexFileName, const char *
 
         // If the filename starts with "//" then this is a rename file, skip it
         if (fileHeader[0] != '/' || fileHeader[1] != '/') {
-            CertStore::CertInfo ci = _preprocessCert(length, offset, raw);
-            if (index.write((uint8_t *)&ci, sizeof(ci)) != (ssize_t)sizeof(ci)) {
+            for (int32_t i = 0; i < length; i++) {
+                hash = (hash ^ ((uint8_t *)raw)[i]) * 16777619UL;
+            }
+            CertStore::CertInfo *grown = (CertStore::CertInfo *)realloc(_index, (count + 1) * sizeof(CertInfo));
+            if (!grown) {
                 free(raw);
                 break;
             }
-            count++;
+            _index = grown;
+            _index[count++] = _preprocessCert(length, offset, raw);
         }
 
         offset += length;
@@ -165,7 +203,21 @@ int CertStore::initCertStore(fs::FS &fs, const char *indexFileName, const char *
         }
     }
     data.close();
+
+    // Sort by hash so lookups are a binary search.  The file gets the same sorted
+    // index, but lookups only use the RAM copy.
+    std::sort(_index, _index + count, [](const CertInfo & a, const CertInfo & b) {
+        return memcmp(a.sha256, b.sha256, sizeof(a.sha256)) < 0;
+    });
+    _indexCount = count;
+    if (index.write((uint8_t *)_index, count * sizeof(CertInfo)) != (ssize_t)(count * sizeof(CertInfo))) {
+        count = 0;
+        _clearCache();
+    }
     index.close();
+    if (count) {
+        _trustHash = hash ? hash : 1;
+    }
     return count;
 }
 
@@ -173,64 +225,130 @@ void CertStore::installCertStore(br_x509_minimal_context *ctx) {
     br_x509_minimal_set_dynamic(ctx, (void*)this, findHashedTA, freeHashedTA);
 }
 
+bool CertStore::_findInfo(const void *hashed_dn, CertInfo *ci) {
+    int lo = 0;
+    int hi = _indexCount - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int cmp = memcmp(_index[mid].sha256, hashed_dn, sizeof(ci->sha256));
+        if (!cmp) {
+            *ci = _index[mid];
+            return true;
+        } else if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return false;
+}
+
+// Read and decode one certificate from the data file
+X509List *CertStore::_loadTA(const CertInfo &ci) {
+    uint8_t *der = (uint8_t*)malloc(ci.length);
+    if (!der) {
+        return nullptr;
+    }
+    fs::File data = _fs->open(_dataName, "r");
+    if (!data) {
+        free(der);
+        return nullptr;
+    }
+    if (!data.seek(ci.offset, fs::SeekSet) || (data.read(der, ci.length) != (int)ci.length)) {
+        data.close();
+        free(der);
+        return nullptr;
+    }
+    data.close();
+    X509List *x509 = new (std::nothrow) X509List(der, ci.length);
+    free(der);
+    if (!x509) {
+        DEBUG_BSSL("CertStore::findHashedTA: OOM\n");
+        return nullptr;
+    }
+    // BearSSL looks the TA up by the DN hash, so store that in place of the DN
+    br_x509_trust_anchor *ta = (br_x509_trust_anchor*)x509->getTrustAnchors();
+    memcpy(ta->dn.data, ci.sha256, sizeof(ci.sha256));
+    ta->dn.len = sizeof(ci.sha256);
+    return x509;
+}
+
+bool CertStore::_retire(X509List *x509, int refs) {
+    RetiredTA *r = new (std::nothrow) RetiredTA;
+    if (!r) {
+        return false;
+    }
+    r->x509 = x509;
+    r->refs = refs;
+    r->next = _retired;
+    _retired = r;
+    return true;
+}
+
 const br_x509_trust_anchor *CertStore::findHashedTA(void *ctx, void *hashed_dn, size_t len) {
     CertStore *cs = static_cast<CertStore*>(ctx);
     CertStore::CertInfo ci;
 
-    if (!cs || len != sizeof(ci.sha256) || !cs->_indexName || !cs->_dataName || !cs->_fs) {
+    if (!cs || len != sizeof(ci.sha256) || !cs->_dataName || !cs->_fs || !cs->_findInfo(hashed_dn, &ci)) {
         return nullptr;
     }
 
-    fs::File index = cs->_fs->open(cs->_indexName, "r");
-    if (!index) {
-        return nullptr;
+    // Reuse an already decoded TA, or else pick the least recently used idle slot
+    CachedTA *slot = nullptr;
+    for (int i = 0; i < CERTSTORE_TA_CACHE; i++) {
+        CachedTA *c = &cs->_taCache[i];
+        if (c->x509 && (c->offset == ci.offset)) {
+            c->used = ++cs->_taStamp;
+            c->refs++;
+            return c->x509->getTrustAnchors();
+        }
+        if (!c->refs && (!slot || (c->used < slot->used))) {
+            slot = c;
+        }
     }
 
-    while (index.read((uint8_t *)&ci, sizeof(ci)) == sizeof(ci)) {
-        if (!memcmp(ci.sha256, hashed_dn, sizeof(ci.sha256))) {
-            index.close();
-            uint8_t *der = (uint8_t*)malloc(ci.length);
-            if (!der) {
-                return nullptr;
-            }
-            fs::File data = cs->_fs->open(cs->_dataName, "r");
-            if (!data) {
-                free(der);
-                return nullptr;
-            }
-            if (!data.seek(ci.offset, fs::SeekSet)) {
-                data.close();
-                free(der);
-                return nullptr;
-            }
-            if (data.read(der, ci.length) != (int)ci.length) {
-                free(der);
-                return nullptr;
-            }
-            data.close();
-            cs->_x509 = new (std::nothrow) X509List(der, ci.length);
-            free(der);
-            if (!cs->_x509) {
-                DEBUG_BSSL("CertStore::findHashedTA: OOM\n");
-                return nullptr;
-            }
-
-            br_x509_trust_anchor *ta = (br_x509_trust_anchor*)cs->_x509->getTrustAnchors();
-            memcpy(ta->dn.data, ci.sha256, sizeof(ci.sha256));
-            ta->dn.len = sizeof(ci.sha256);
-
-            return ta;
+    X509List *x509 = cs->_loadTA(ci);
+    if (!x509) {
+        return nullptr;
+    }
+    if (!slot) {
+        // Everything cached is in use, hand out an uncached copy
+        if (!cs->_retire(x509, 1)) {
+            delete x509;
+            return nullptr;
         }
+        return x509->getTrustAnchors();
     }
-    index.close();
-    return nullptr;
+    delete slot->x509;
+    slot->x509 = x509;
+    slot->offset = ci.offset;
+    slot->used = ++cs->_taStamp;
+    slot->refs = 1;
+    return x509->getTrustAnchors();
 }
 
 void CertStore::freeHashedTA(void *ctx, const br_x509_trust_anchor *ta) {
     CertStore *cs = static_cast<CertStore*>(ctx);
-    (void) ta; // Unused
-    delete cs->_x509;
-    cs->_x509 = nullptr;
+    for (int i = 0; i < CERTSTORE_TA_CACHE; i++) {
+        CachedTA *c = &cs->_taCache[i];
+        if (c->x509 && (c->x509->getTrustAnchors() == ta)) {
+            if (c->refs) {
+                c->refs--;
+            }
+            return; // Stays decoded for the next handshake
+        }
+    }
+    for (RetiredTA **p = &cs->_retired; *p; p = &(*p)->next) {
+        RetiredTA *r = *p;
+        if (r->x509->getTrustAnchors() == ta) {
+            if (!--r->refs) {
+                *p = r->next;
+                delete r->x509;
+                delete r;
+            }
+            return;
+        }
+    }
 }
 
 }
@@ -28,6 +28,11 @@
 // of a large set of certificates stored on FS or SD card to
 // be dynamically used when validating a X509 certificate
 
+// Number of decoded trust anchors kept in RAM for reuse between handshakes
+#ifndef CERTSTORE_TA_CACHE
+#define CERTSTORE_TA_CACHE 4
+#endif
+
 namespace BearSSL {
 
 class CertStoreBase {
@@ -36,6 +41,12 @@ public:
 
     // Installs the cert store into the X509 decoder (normally via static function callbacks)
     virtual void installCertStore(br_x509_minimal_context *ctx) = 0;
+
+    // Identifies the contents of the store, so cached client TLS sessions are kept
+    // apart per set of trust anchors.  0 means unknown and disables the cache.
+    virtual uint32_t trustHash() const {
+        return 0;
+    }
 };
 
 class CertStore: public CertStoreBase {
@@ -49,11 +60,15 @@ public:
     // Installs the cert store into the X509 decoder (normally via static function callbacks)
     void installCertStore(br_x509_minimal_context *ctx);
 
+    uint32_t trustHash() const override {
+        return _trustHash;
+    }
+
 protected:
     fs::FS *_fs = nullptr;
     char *_indexName = nullptr;
     char *_dataName = nullptr;
-    X509List *_x509 = nullptr;
+    uint32_t _trustHash = 0; // FNV-1a of every certificate in the data file
 
     // These need to be static as they are callbacks from BearSSL C code
     static const br_x509_trust_anchor *findHashedTA(void *ctx, void *hashed_dn, size_t len);
@@ -68,6 +83,33 @@ protected:
     };
     static CertInfo _preprocessCert(uint32_t length, uint32_t offset, const void *raw);
 
+    // The index, sorted by hash, for a binary search without any file access
+    CertInfo *_index = nullptr;
+    int _indexCount = 0;
+    bool _findInfo(const void *hashed_dn, CertInfo *ci);
+
+    // LRU of decoded trust anchors, keyed by their offset in the data file
+    typedef struct {
+        X509List *x509;
+        uint32_t offset;
+        uint32_t used;
+        int refs;
+    } CachedTA;
+    CachedTA _taCache[CERTSTORE_TA_CACHE] = { };
+    uint32_t _taStamp = 0;
+    X509List *_loadTA(const CertInfo &ci);
+    void _clearCache();
+
+    // TAs still held by a handshake but not cacheable, either because every slot
+    // was busy or because initCertStore() replaced the cache.  Freed on last release.
+    typedef struct RetiredTA {
+        X509List *x509;
+        int refs;
+        struct RetiredTA *next;
+    } RetiredTA;
+    RetiredTA *_retired = nullptr;
+    bool _retire(X509List *x509, int refs);
+
 };
 
 };
@@ -199,6 +199,15 @@ size_t WiFiClient::write(const uint8_t *buf, size_t size) {
     return _client->write((const char*)buf, size);
 }
 
+size_t WiFiClient::write(const uint8_t *buf, size_t size, std::function<void(void)> release) {
+    if (!_client || !size) {
+        release();
+        return 0;
+    }
+    _client->setTimeout(_timeout);
+    return _client->write((const char*)buf, size, std::move(release));
+}
+
 size_t WiFiClient::write(Stream& stream) {
     if (!_client || !stream.available()) {
         return 0;
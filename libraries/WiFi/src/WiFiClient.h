@@ -23,6 +23,7 @@
 #pragma once
 
 #include <memory>
+#include <functional>
 #include "Print.h"
 #include "Client.h"
 #include "IPAddress.h"
@@ -71,6 +72,8 @@ public:
     virtual size_t write(uint8_t) override;
     virtual size_t write(const uint8_t *buf, size_t size) override;
     size_t write(Stream& stream);
+    // Zero-copy write, buf must stay valid until release() is called
+    size_t write(const uint8_t *buf, size_t size, std::function<void(void)> release);
 
     virtual int available() override;
     virtual int read() override;
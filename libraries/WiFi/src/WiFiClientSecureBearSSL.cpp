@@ -62,6 +62,8 @@ extern "C" uint32_t __picoRand() {
 
 namespace BearSSL {
 
+HandshakeStats WiFiClientSecureCtx::_handshakeStats;
+
 void WiFiClientSecureCtx::_clear() {
     // TLS handshake may take more than the 5 second default timeout
     _timeout = 15000;
@@ -82,6 +84,8 @@ void WiFiClientSecureCtx::_clear() {
     _recvapp_len = 0;
     _oom_err = false;
     _session = nullptr;
+    _handshakeUs = 0;
+    _resumed = false;
     _cipher_list = nullptr;
     _cipher_cnt = 0;
     _tls_min = BR_TLS10;
@@ -109,6 +113,7 @@ WiFiClientSecureCtx::WiFiClientSecureCtx() : WiFiClient() {
     _clear();
     _clearAuthenticationSettings();
     _certStore = nullptr; // Don't want to remove cert store on a clear, should be long lived
+    _sessionCache = nullptr; // Opt-in with setSessionCache
     _sk = nullptr;
     stack_thunk_add_ref();
 }
@@ -134,6 +139,7 @@ WiFiClientSecureCtx::WiFiClientSecureCtx(ClientContext* client,
     _clear();
     _clearAuthenticationSettings();
     stack_thunk_add_ref();
+    _sessionCache = nullptr; // Server side sessions live in the ServerSessions cache
     _iobuf_in_size = iobuf_in_size;
     _iobuf_out_size = iobuf_out_size;
     _client = client;
@@ -155,6 +161,7 @@ WiFiClientSecureCtx::WiFiClientSecureCtx(ClientContext *client,
     _clear();
     _clearAuthenticationSettings();
     stack_thunk_add_ref();
+    _sessionCache = nullptr; // Server side sessions live in the ServerSessions cache
     _iobuf_in_size = iobuf_in_size;
     _iobuf_out_size = iobuf_out_size;
     _client = client;
@@ -1052,6 +1059,72 @@ bool WiFiClientSecureCtx::setSSLVersion(uint32_t min, uint32_t max) {
     return true;
 }
 
+// Identifies the objects the server is validated against, mixed like FNV-1a.  Distinct
+// but equivalent setups just don't share sessions.
+static uint32_t _fnv(uint32_t h, const void *data, size_t len) {
+    const uint8_t *d = (const uint8_t *)data;
+    while (len--) {
+        h = (h ^ *d++) * 16777619UL;
+    }
+    return h;
+}
+
+static uint32_t _fnvKey(uint32_t h, const br_x509_pkey *k) {
+    h = _fnv(h, &k->key_type, sizeof(k->key_type));
+    if (k->key_type == BR_KEYTYPE_RSA) {
+        h = _fnv(h, k->key.rsa.n, k->key.rsa.nlen);
+        h = _fnv(h, k->key.rsa.e, k->key.rsa.elen);
+    } else {
+        h = _fnv(h, &k->key.ec.curve, sizeof(k->key.ec.curve));
+        h = _fnv(h, k->key.ec.q, k->key.ec.qlen);
+    }
+    return h;
+}
+
+static uint32_t _fnvTAs(uint32_t h, const X509List *l) {
+    if (!l) {
+        return _fnv(h, "", 1);
+    }
+    for (size_t i = 0; i < l->getCount(); i++) {
+        const br_x509_trust_anchor *ta = &l->getTrustAnchors()[i];
+        h = _fnv(h, ta->dn.data, ta->dn.len);
+        h = _fnv(h, &ta->flags, sizeof(ta->flags));
+        h = _fnvKey(h, &ta->pkey);
+    }
+    return h;
+}
+
+// Hashes the contents of whatever validates the server, not the objects' addresses,
+// so saved sessions stay usable across reboots and never outlive a change of trust.
+// Returns false if the trust can't be identified, and the cache must not be used.
+bool WiFiClientSecureCtx::_trustKey(uint32_t *key) {
+    uint32_t h = 2166136261UL;
+    if (_knownkey) {
+        br_x509_pkey k;
+        if (_knownkey->isRSA()) {
+            k.key_type = BR_KEYTYPE_RSA;
+            k.key.rsa = *_knownkey->getRSA();
+        } else if (_knownkey->isEC()) {
+            k.key_type = BR_KEYTYPE_EC;
+            k.key.ec = *_knownkey->getEC();
+        } else {
+            return false;
+        }
+        h = _fnvKey(_fnv(h, "K", 1), &k);
+    }
+    h = _fnvTAs(_fnv(h, "T", 1), _ta);
+    h = _fnvTAs(_fnv(h, "E", 1), _esp32_ta);
+    if (_certStore) {
+        uint32_t cs = _certStore->trustHash();
+        if (!cs) {
+            return false;
+        }
+        h = _fnv(_fnv(h, "C", 1), &cs, sizeof(cs));
+    }
+    *key = h;
+    return true;
+}
+
 // Installs the appropriate X509 cert validation method for a client connection
 bool WiFiClientSecureCtx::_installClientX509Validator() {
     if (_use_insecure || _use_fingerprint || _use_self_signed) {
@@ -1113,14 +1186,8 @@ bool WiFiClientSecureCtx::_installClientX509Validator() {
 }
 
 std::shared_ptr<unsigned char> WiFiClientSecureCtx::_alloc_iobuf(size_t sz) {
-    // Allocate buffer with preference to IRAM
-    //  HeapSelectIram primary;
-    auto sptr = std::shared_ptr<unsigned char>(new (std::nothrow) unsigned char[sz], std::default_delete<unsigned char[]>());
-    if (!sptr) {
-        //    HeapSelectDram alternate;
-        sptr = std::shared_ptr<unsigned char>(new (std::nothrow) unsigned char[sz], std::default_delete<unsigned char[]>());
-    }
-    return sptr;
+    // The I/O buffers are the biggest part of a TLS connection, so let the PSRAM policy place them
+    return std::shared_ptr<unsigned char>((unsigned char *)bufmalloc(sz), pfree);
 }
 
 // Called by connect() to do the actual SSL setup and handshake.
@@ -1196,18 +1263,49 @@ bool WiFiClientSecureCtx::_connectSSL(const char* hostName) {
                                      _esp32_sk->getRSA(), br_rsa_pkcs1_sign_get_default());
     }
 
-    // Restore session from the storage spot, if present
+    // Restore session from the storage spot, if present, or else the per-host cache
+    br_ssl_session_parameters offered;
+    memset(&offered, 0, sizeof(offered));
+    String ipName;
+    if (!hostName) {
+        ipName = remoteIP().toString();
+    }
+    const char *cacheKey = hostName ? hostName : ipName.c_str();
+    // Only cache sessions whose server was fully validated, and keep them apart per trust
+    // setup, because BearSSL does not check the certificate again when resuming
+    uint32_t trust = 0;
+    SessionCache *cache = (_use_insecure || _use_fingerprint || _use_self_signed || !_trustKey(&trust)) ? nullptr : _sessionCache;
     if (_session) {
-        br_ssl_engine_set_session_parameters(_eng, _session->getSession());
+        memcpy(&offered, _session->getSession(), sizeof(offered));
+    } else if (cache) {
+        cache->get(cacheKey, remotePort(), &offered, trust);
+    }
+    bool resume = offered.session_id_len > 0;
+    if (resume) {
+        br_ssl_engine_set_session_parameters(_eng, &offered);
     }
 
-    if (!br_ssl_client_reset(_sc.get(), hostName, _session ? 1 : 0)) {
+    if (!br_ssl_client_reset(_sc.get(), hostName, resume ? 1 : 0)) {
         _freeSSL();
         DEBUG_BSSL("_connectSSL: Can't reset client\n");
         return false;
     }
 
+    uint32_t start = micros();
     auto ret = _wait_for_handshake();
+    bool resumed = false;
+    if (ret) {
+        // A server resuming the session echoes back the same session ID
+        br_ssl_session_parameters now;
+        br_ssl_engine_get_session_parameters(_eng, &now);
+        resumed = resume && (now.session_id_len == offered.session_id_len) && !memcmp(now.session_id, offered.session_id, now.session_id_len);
+        if (!_session && cache) {
+            cache->put(cacheKey, remotePort(), &now, trust);
+        }
+    } else if (resume && !_session && cache) {
+        cache->remove(cacheKey, remotePort(), trust); // Don't retry a session that may be the problem
+    }
+    _recordHandshake(ret, resumed, micros() - start);
 #if defined(DEBUG_RP2040_CORE) && defined(DEBUG_RP2040_PORT)
     if (!ret) {
         char err[256];
@@ -1231,6 +1329,20 @@ bool WiFiClientSecureCtx::_connectSSL(const char* hostName) {
     return ret;
 }
 
+void WiFiClientSecureCtx::_recordHandshake(bool ok, bool resumed, uint32_t us) {
+    _handshakeUs = us;
+    _resumed = ok && resumed;
+    if (ok) {
+        if (resumed) {
+            _handshakeStats.resumed++;
+            _handshakeStats.resumedUs += us;
+        } else {
+            _handshakeStats.full++;
+            _handshakeStats.fullUs += us;
+        }
+    }
+}
+
 // Slightly different X509 setup for servers who want to validate client
 // certificates, so factor it out as it's used in RSA and EC servers.
 bool WiFiClientSecureCtx::_installServerX509Validator(const X509List *client_CA_ta) {
@@ -1306,7 +1418,11 @@ bool WiFiClientSecureCtx::_connectSSLServerRSA(const X509List *chain,
         return false;
     }
 
-    return _wait_for_handshake();
+    uint32_t start = micros();
+    bool ret = _wait_for_handshake();
+    bool resumed = cache && cache->_handshakeDone(ret, _eng);
+    _recordHandshake(ret, resumed, micros() - start);
+    return ret;
 }
 
 // Called by WiFiServerBearSSL when an elliptic curve cert/key is specified.
@@ -1351,7 +1467,11 @@ bool WiFiClientSecureCtx::_connectSSLServerEC(const X509List *chain,
         return false;
     }
 
-    return _wait_for_handshake();
+    uint32_t start = micros();
+    bool ret = _wait_for_handshake();
+    bool resumed = cache && cache->_handshakeDone(ret, _eng);
+    _recordHandshake(ret, resumed, micros() - start);
+    return ret;
 #else
     (void) chain;
     (void) cert_issuer_key_type;
@@ -32,6 +32,14 @@
 
 namespace BearSSL {
 
+// Handshake totals over all WiFiClientSecure connections, client and server side
+typedef struct {
+    uint32_t full;      // Handshakes that needed a full key exchange
+    uint32_t resumed;   // Handshakes that resumed a cached session
+    uint64_t fullUs;    // Total microseconds spent in each kind
+    uint64_t resumedUs;
+} HandshakeStats;
+
 class WiFiClientSecureCtx : public WiFiClient {
 public:
     WiFiClientSecureCtx();
@@ -79,6 +87,25 @@ public:
         _session = session;
     }
 
+    // Per-host session cache used when no Session is set, off (nullptr) by default
+    void setSessionCache(SessionCache *cache) {
+        _sessionCache = cache;
+    }
+
+    // Duration of the last handshake and whether it resumed a session
+    uint32_t getHandshakeTime() {
+        return _handshakeUs;
+    }
+    bool sessionResumed() {
+        return _resumed;
+    }
+    static void getHandshakeStats(HandshakeStats *stats) {
+        *stats = _handshakeStats;
+    }
+    static void resetHandshakeStats() {
+        memset(&_handshakeStats, 0, sizeof(_handshakeStats));
+    }
+
     // Don't validate the chain, just accept whatever is given.  VERY INSECURE!
     void setInsecure() {
         _clearAuthenticationSettings();
@@ -284,6 +311,12 @@ private:
     // Optional storage space pointer for session parameters
     // Will be used on connect and updated on close
     Session *_session;
+    SessionCache *_sessionCache;
+
+    uint32_t _handshakeUs;
+    bool _resumed;
+    static HandshakeStats _handshakeStats;
+    void _recordHandshake(bool ok, bool resumed, uint32_t us);
 
     bool _use_insecure;
     bool _use_fingerprint;
@@ -334,6 +367,7 @@ private:
 
     // X.509 validators differ from server to client
     bool _installClientX509Validator(); // Set up X509 validator for a client conn.
+    bool _trustKey(uint32_t *key); // Keys the session cache by how the server is validated
     bool _installServerX509Validator(const X509List *client_CA_ta); // Setup X509 client cert validation, if supplied
 
     uint8_t *_streamLoad(Stream& stream, size_t size);
@@ -442,6 +476,27 @@ public:
         _ctx->setSession(session);
     }
 
+    // Per-host session cache used when no Session is set (i.e. SessionCache::shared()), off by default
+    void setSessionCache(SessionCache *cache) {
+        _ctx->setSessionCache(cache);
+    }
+
+    // Microseconds the last handshake took, and whether it resumed a session
+    uint32_t getHandshakeTime() {
+        return _ctx->getHandshakeTime();
+    }
+    bool sessionResumed() {
+        return _ctx->sessionResumed();
+    }
+
+    // Totals over all connections
+    static void getHandshakeStats(HandshakeStats *stats) {
+        WiFiClientSecureCtx::getHandshakeStats(stats);
+    }
+    static void resetHandshakeStats() {
+        WiFiClientSecureCtx::resetHandshakeStats();
+    }
+
     // Don't validate the chain, just accept whatever is given.  VERY INSECURE!
     void setInsecure() {
         _ctx->setInsecure();
@@ -26,7 +26,13 @@ class WiFiClient;
 
 typedef void (*discard_cb_t)(void*, ClientContext*);
 
+// Maximum number of zero-copy writes which may be waiting for the peer's ACK at once
+#ifndef CLIENTCONTEXT_MAX_ZEROCOPY
+#define CLIENTCONTEXT_MAX_ZEROCOPY 8
+#endif
+
 #include <assert.h>
+#include <functional>
 #include "lwip/timeouts.h"
 
 //#include <esp_priv.h>
@@ -74,11 +80,20 @@ public:
             tcp_abort(_pcb);
             _pcb = nullptr;
         }
+        _zc_release_all();
         return ERR_ABRT;
     }
 
     err_t close() {
         err_t err = ERR_OK;
+        if (_pcb && _zc_pending()) {
+            // lwIP would keep referencing zero-copy buffers while it finishes
+            // sending after tcp_close(), so let them drain or give up on them
+            wait_until_acked();
+            if (_zc_pending()) {
+                return abort();
+            }
+        }
         if (_pcb) {
             DEBUGV(":close\r\n");
             tcp_arg(_pcb, nullptr);
@@ -371,21 +386,44 @@ public:
         return _write_from_source(ds, dl);
     }
 
+    // Send a buffer without copying it into lwIP.  The caller must keep the
+    // data untouched until release() is called, which happens once the peer
+    // has acknowledged all of it (or the connection goes away).  Returns as
+    // soon as the data is queued, so several buffers may be in flight.
+    size_t write(const char* ds, const size_t dl, std::function<void(void)> release) {
+        if (!_pcb || _zc_full()) {
+            release();
+            return 0;
+        }
+        // Queue the release first, ACKs may arrive while we are still writing
+        ZeroCopyBuffer &zc = _zc_queue[_zc_tail];
+        zc.end = _tx_queued + dl;
+        zc.release = std::move(release);
+        __dmb(); // Entry must be visible before the new tail
+        _zc_tail = (_zc_tail + 1) % (CLIENTCONTEXT_MAX_ZEROCOPY + 1);
+
+        _zerocopy = true;
+        size_t ret = _write_from_source(ds, dl);
+        _zerocopy = false;
+        if (ret != dl) {
+            // The rest never reached lwIP, so don't wait for it to be acknowledged
+            zc.end = _tx_queued;
+        }
+        return ret;
+    }
+
     size_t write(Stream& stream) {
         if (!_pcb) {
             return 0;
         }
         size_t sent = 0;
-        uint8_t buff[256];
+        char buff[256];
         while (stream.available()) {
-            // Stream only lets you read 1 byte at a time, so buffer in local copy
-            size_t i;
-            for (i = 0; (i < sizeof(buff)) && stream.available(); i++) {
-                buff[i] = stream.read();
-            }
+            size_t i = std::min((size_t)stream.available(), sizeof(buff));
+            i = stream.readBytes(buff, i);
             if (i) {
                 // Send as a single packet
-                int len = write((const char *)buff, i);
+                int len = write(buff, i);
                 sent += len;
                 if (len != (int)i) {
                     break; // Write error...
@@ -500,7 +538,7 @@ protected:
             _send_waiting = false;
         } while (true);
 
-        if (_sync) {
+        if (_sync && !_zerocopy) {
             wait_until_acked();
         }
 
@@ -548,9 +586,10 @@ protected:
             {
                 flags |= TCP_WRITE_FLAG_MORE;    // do not tcp-PuSH (yet)
             }
-            if (!_sync)
+            if (!_sync && !_zerocopy)
                 // user data must be copied when data are sent but not yet acknowledged
-                // (with sync, we wait for acknowledgment before returning to user)
+                // (with sync, we wait for acknowledgment before returning to user, and
+                // zero-copy buffers are held until _acked() releases them)
             {
                 flags |= TCP_WRITE_FLAG_COPY;
             }
@@ -564,6 +603,7 @@ protected:
 
             if (err == ERR_OK) {
                 _written += next_chunk_size;
+                _tx_queued += next_chunk_size;
                 has_written = true;
             } else if (err == ERR_MEM) {
                 if (scale < 4) {
@@ -599,12 +639,36 @@ protected:
 
     err_t _acked(tcp_pcb* pcb, uint16_t len) {
         (void) pcb;
-        (void) len;
         DEBUGV(":ack %d\r\n", len);
+        _tx_acked += len;
+        // Hand back every zero-copy buffer whose last byte has now been acknowledged
+        while (_zc_head != _zc_tail && (int32_t)(_zc_queue[_zc_head].end - _tx_acked) <= 0) {
+            __dmb(); // Entry must be read before the slot is released
+            auto release = std::move(_zc_queue[_zc_head].release);
+            _zc_head = (_zc_head + 1) % (CLIENTCONTEXT_MAX_ZEROCOPY + 1);
+            release();
+        }
         _write_some_from_cb();
         return ERR_OK;
     }
 
+    bool _zc_pending() const {
+        return _zc_head != _zc_tail;
+    }
+
+    bool _zc_full() const {
+        return (_zc_tail + 1) % (CLIENTCONTEXT_MAX_ZEROCOPY + 1) == _zc_head;
+    }
+
+    // Only call once lwIP can no longer reach the buffers (pcb aborted or errored)
+    void _zc_release_all() {
+        while (_zc_pending()) {
+            auto release = std::move(_zc_queue[_zc_head].release);
+            _zc_head = (_zc_head + 1) % (CLIENTCONTEXT_MAX_ZEROCOPY + 1);
+            release();
+        }
+    }
+
     void _consume(size_t size) {
         ptrdiff_t left = _rx_buf->len - _rx_buf_offset - size;
         if (left > 0) {
@@ -666,6 +730,7 @@ protected:
         tcp_recv(_pcb, nullptr);
         tcp_err(_pcb, nullptr);
         _pcb = nullptr;
+        _zc_release_all();
         _notify_error();
     }
 
@@ -747,4 +812,16 @@ private:
     ClientContext* _next;
 
     bool _sync;
+
+    // Zero-copy writes, a ring filled by write() and drained by _acked()
+    struct ZeroCopyBuffer {
+        uint32_t end; // Value of _tx_queued once this buffer was queued
+        std::function<void(void)> release;
+    };
+    ZeroCopyBuffer _zc_queue[CLIENTCONTEXT_MAX_ZEROCOPY + 1];
+    volatile size_t _zc_head = 0; // Only written by _acked()
+    volatile size_t _zc_tail = 0; // Only written by write()
+    uint32_t _tx_queued = 0;      // Total bytes accepted by tcp_write()
+    uint32_t _tx_acked = 0;       // Total bytes acknowledged by the peer
+    bool _zerocopy = false;
 };
@@ -52,6 +52,14 @@ public:
         return LOW;
     }
 
+    static constexpr bool chunkedReadIsPossible() {
+        return false;
+    }
+
+    static constexpr bool chunkedWriteIsPossible() {
+        return false;
+    }
+
     constexpr bool needsSPI() const {
         return false;
     }
@@ -95,6 +95,14 @@ public:
         return LOW;
     }
 
+    static constexpr bool chunkedReadIsPossible() {
+        return false;
+    }
+
+    static constexpr bool chunkedWriteIsPossible() {
+        return false;
+    }
+
     void setSSID(const char *p) {
         _ssid = p;
     }
@@ -51,6 +51,14 @@ public:
         return HIGH;
     }
 
+    static constexpr bool chunkedReadIsPossible() {
+        return false;
+    }
+
+    static constexpr bool chunkedWriteIsPossible() {
+        return false;
+    }
+
     constexpr bool needsSPI() const {
         return false;
     }
@@ -23,9 +23,6 @@
 
 #pragma once
 
-// TODO:
-// unchain pbufs
-
 #include <netif/ethernet.h>
 #include <lwip/init.h>
 #include <lwip/netif.h>
@@ -50,6 +47,15 @@
 #define DEFAULT_MTU 1500
 #endif
 
+// Number of frames handlePackets() may pull from the device per call.  The
+// budget grows while a backlog remains and shrinks back once it drains
+#ifndef ETH_RX_BUDGET_MIN
+#define ETH_RX_BUDGET_MIN 8
+#endif
+#ifndef ETH_RX_BUDGET_MAX
+#define ETH_RX_BUDGET_MAX 64
+#endif
+
 enum EthernetLinkStatus {
     Unknown,
     LinkON,
@@ -148,6 +154,21 @@ public:
     uint32_t packetsSent() {
         return _packetsSent;
     }
+    uint32_t packetsDropped() {
+        return _packetsDropped;
+    }
+
+    // Microseconds from the receive interrupt (or start of the poll) until
+    // a frame was handed to lwIP, for the last frame and the worst seen
+    uint32_t rxLatency() {
+        return _rxLatency;
+    }
+    uint32_t rxLatencyMax() {
+        return _rxLatencyMax;
+    }
+    void resetRxLatency() {
+        _rxLatencyMax = 0;
+    }
 
 
     // ESP8266WiFi API compatibility
@@ -170,6 +191,8 @@ public:
     // called on a regular basis or on interrupt
     err_t handlePackets();
 protected:
+    struct pbuf *readFrame(uint16_t tot_len);
+
     // members
     SPIClass& _spiUnit;
     SPISettings _spiSettings = SPISettings(4000000, MSBFIRST, SPI_MODE0);
@@ -192,6 +215,13 @@ protected:
 
     uint32_t _packetsReceived = 0;
     uint32_t _packetsSent = 0;
+    uint32_t _packetsDropped = 0;
+
+    // Receive engine state
+    int _rxBudget = ETH_RX_BUDGET_MIN;
+    volatile uint32_t _rxStart = 0;
+    uint32_t _rxLatency = 0;
+    uint32_t _rxLatencyMax = 0;
 };
 
 
@@ -446,6 +476,7 @@ void LwipIntfDev<RawDev>::end() {
 template<class RawDev>
 void LwipIntfDev<RawDev>::_irq(void *param) {
     LwipIntfDev *d = static_cast<LwipIntfDev*>(param);
+    d->_rxStart = micros();
     ethernet_arch_lwip_begin();
     d->handlePackets();
     sys_check_timeouts();
@@ -466,16 +497,31 @@ template<class RawDev>
 err_t LwipIntfDev<RawDev>::linkoutput_s(netif* netif, struct pbuf* pbuf) {
     LwipIntfDev* lid = (LwipIntfDev*)netif->state;
     ethernet_arch_lwip_begin();
-    uint16_t len = lid->sendFrame((const uint8_t*)pbuf->payload, pbuf->len);
+    uint16_t len;
+    if constexpr (RawDev::chunkedWriteIsPossible()) {
+        // Gather the chain straight into the device, no need for lwIP to flatten it first
+        len = lid->sendFrameChunks(pbuf);
+    } else if (pbuf->next) {
+        // Chained pbuf (i.e. TCP headers + payload) and the device needs it contiguous
+        struct pbuf *flat = pbuf_clone(PBUF_RAW, PBUF_RAM, pbuf);
+        if (!flat) {
+            ethernet_arch_lwip_end();
+            return ERR_MEM;
+        }
+        len = lid->sendFrame((const uint8_t*)flat->payload, flat->len);
+        pbuf_free(flat);
+    } else {
+        len = lid->sendFrame((const uint8_t*)pbuf->payload, pbuf->len);
+    }
     lid->_packetsSent++;
 #if PHY_HAS_CAPTURE
     if (phy_capture) {
         phy_capture(lid->_netif.num, (const char*)pbuf->payload, pbuf->len, /*out*/ 1,
-                    /*success*/ len == pbuf->len);
+                    /*success*/ len == pbuf->tot_len);
     }
 #endif
     ethernet_arch_lwip_end();
-    return len == pbuf->len ? ERR_OK : ERR_MEM;
+    return len == pbuf->tot_len ? ERR_OK : ERR_MEM;
 }
 
 template<class RawDev>
@@ -541,58 +587,90 @@ void LwipIntfDev<RawDev>::check_route() {
 }
 
 template<class RawDev>
-err_t LwipIntfDev<RawDev>::handlePackets() {
-    int pkt = 0;
-    while (1) {
-        if (++pkt == 10)
-            // prevent starvation
-        {
-            return ERR_OK;
+struct pbuf *LwipIntfDev<RawDev>::readFrame(uint16_t tot_len) {
+    pbuf* pbuf;
+    if constexpr (RawDev::chunkedReadIsPossible()) {
+        // from doc: use PBUF_RAM for TX, PBUF_POOL from RX
+        // The pool is preallocated, so this can't fragment the heap, but
+        // may return a chain of pbufs which we fill one link at a time.
+        pbuf = pbuf_alloc(PBUF_RAW, tot_len, PBUF_POOL);
+        if (!pbuf) {
+            RawDev::discardFrame(tot_len);
+            return nullptr;
         }
-
-        uint16_t tot_len = RawDev::readFrameSize();
-        if (!tot_len) {
-            return ERR_OK;
+        for (struct pbuf *q = pbuf; q; q = q->next) {
+            RawDev::readFrameChunk((uint8_t*)q->payload, q->len);
         }
-
-        // from doc: use PBUF_RAM for TX, PBUF_POOL from RX
-        // however:
-        // PBUF_POOL can return chained pbuf (not in one piece)
-        // and WiznetDriver does not have the proper API to deal with that
-        // so in the meantime, we use PBUF_RAM instead which is currently
-        // guarantying to deliver a continuous chunk of memory.
-        // TODO: tweak the wiznet driver to allow copying partial chunk
-        //       of received data and use PBUF_POOL.
-        pbuf* pbuf = pbuf_alloc(PBUF_RAW, tot_len, PBUF_RAM);
+        RawDev::readFrameEnd();
+    } else {
+        // This device can only copy a frame out in one piece, so we need
+        // PBUF_RAM which guarantees a contiguous chunk of memory.
+        pbuf = pbuf_alloc(PBUF_RAW, tot_len, PBUF_RAM);
         if (!pbuf || pbuf->len < tot_len) {
             if (pbuf) {
                 pbuf_free(pbuf);
             }
             RawDev::discardFrame(tot_len);
-            return ERR_BUF;
+            return nullptr;
         }
-
         uint16_t len = RawDev::readFrameData((uint8_t*)pbuf->payload, tot_len);
         if (len != tot_len) {
             // tot_len is given by readFrameSize()
             // and is supposed to be honoured by readFrameData()
-            // todo: ensure this test is unneeded, remove the print
             pbuf_free(pbuf);
+            return nullptr;
+        }
+    }
+    return pbuf;
+}
+
+template<class RawDev>
+err_t LwipIntfDev<RawDev>::handlePackets() {
+    if (_intrPin < 0) {
+        _rxStart = micros();
+    }
+
+    int pkt = 0;
+    while (1) {
+        if (pkt == _rxBudget) {
+            // prevent starvation, but let a persistent backlog drain faster next time
+            if (_rxBudget < ETH_RX_BUDGET_MAX) {
+                _rxBudget *= 2;
+            }
+            return ERR_OK;
+        }
+
+        uint16_t tot_len = RawDev::readFrameSize();
+        if (!tot_len) {
+            if ((pkt < _rxBudget / 2) && (_rxBudget > ETH_RX_BUDGET_MIN)) {
+                _rxBudget /= 2;
+            }
+            return ERR_OK;
+        }
+        pkt++;
+
+        pbuf* pbuf = readFrame(tot_len);
+        if (!pbuf) {
+            _packetsDropped++;
             return ERR_BUF;
         }
 
         _packetsReceived++;
 
-        err_t err = _netif.input(pbuf, &_netif);
+        _rxLatency = micros() - _rxStart;
+        if (_rxLatency > _rxLatencyMax) {
+            _rxLatencyMax = _rxLatency;
+        }
 
 #if PHY_HAS_CAPTURE
         if (phy_capture) {
-            phy_capture(_netif.num, (const char*)pbuf->payload, tot_len, /*out*/ 0,
-                        /*success*/ err == ERR_OK);
+            phy_capture(_netif.num, (const char*)pbuf->payload, pbuf->len, /*out*/ 0, /*success*/ 1);
         }
 #endif
 
+        err_t err = _netif.input(pbuf, &_netif);
         if (err != ERR_OK) {
+            _packetsDropped++;
             pbuf_free(pbuf);
             return err;
         }
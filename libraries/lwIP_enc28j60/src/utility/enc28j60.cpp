@@ -523,8 +523,6 @@ void ENC28J60::end() {
 /*---------------------------------------------------------------------------*/
 
 uint16_t ENC28J60::sendFrame(const uint8_t* data, uint16_t datalen) {
-    uint16_t dataend;
-
     ethernet_arch_lwip_gpio_mask(); // So we don't fire an IRQ and interrupt the send w/a receive!
 
     /*
@@ -548,12 +546,7 @@ uint16_t ENC28J60::sendFrame(const uint8_t* data, uint16_t datalen) {
          ECON1.TXRTS.
     */
 
-    setregbank(ERXTX_BANK);
-    /* Set up the transmit buffer pointer */
-    writereg(ETXSTL, TX_BUF_START & 0xff);
-    writereg(ETXSTH, TX_BUF_START >> 8);
-    writereg(EWRPTL, TX_BUF_START & 0xff);
-    writereg(EWRPTH, TX_BUF_START >> 8);
+    txbegin();
 
     /*  Write the transmission control register as the first byte of the
         output packet. We write 0x00 to indicate that the default
@@ -562,22 +555,10 @@ uint16_t ENC28J60::sendFrame(const uint8_t* data, uint16_t datalen) {
 
     writedata(data, datalen);
 
-    /* Write a pointer to the last data byte. */
-    dataend = TX_BUF_START + datalen;
-    writereg(ETXNDL, dataend & 0xff);
-    writereg(ETXNDH, dataend >> 8);
-
-    /* Clear EIR.TXIF */
-    clearregbitfield(EIR, EIR_TXIF);
-
-    /* Don't care about interrupts for now */
-
-    /* Send the packet */
-    setregbitfield(ECON1, ECON1_TXRTS);
-    while ((readreg(ECON1) & ECON1_TXRTS) > 0)
-        ;
+    txstart(datalen);
 
 #if DEBUG
+    uint16_t dataend = TX_BUF_START + datalen;
     if ((readreg(ESTAT) & ESTAT_TXABRT) != 0) {
         uint16_t erdpt;
         uint8_t  tsv[7];
@@ -605,6 +586,57 @@ uint16_t ENC28J60::sendFrame(const uint8_t* data, uint16_t datalen) {
     return datalen;
 }
 
+uint16_t ENC28J60::sendFrameChunks(const struct pbuf* p) {
+    uint16_t datalen = p->tot_len;
+
+    ethernet_arch_lwip_gpio_mask(); // So we don't fire an IRQ and interrupt the send w/a receive!
+
+    txbegin();
+
+    /* One WBM command covers the control byte and the whole chain, EWRPT
+       auto-increments so there is no need to restart it per pbuf */
+    enc28j60_arch_spi_select();
+    SPI.transfer(0x7a);
+    SPI.transfer(0x00); /* MACON3 */
+    for (const struct pbuf *q = p; q; q = q->next) {
+        SPI.transfer(q->payload, nullptr, q->len);
+    }
+    enc28j60_arch_spi_deselect();
+
+    txstart(datalen);
+
+    ethernet_arch_lwip_gpio_unmask();
+    return datalen;
+}
+
+void ENC28J60::txbegin(void) {
+    setregbank(ERXTX_BANK);
+    /* Set up the transmit buffer pointer */
+    writereg(ETXSTL, TX_BUF_START & 0xff);
+    writereg(ETXSTH, TX_BUF_START >> 8);
+    writereg(EWRPTL, TX_BUF_START & 0xff);
+    writereg(EWRPTH, TX_BUF_START >> 8);
+}
+
+void ENC28J60::txstart(uint16_t datalen) {
+    uint16_t dataend;
+
+    /* Write a pointer to the last data byte. */
+    dataend = TX_BUF_START + datalen;
+    writereg(ETXNDL, dataend & 0xff);
+    writereg(ETXNDH, dataend >> 8);
+
+    /* Clear EIR.TXIF */
+    clearregbitfield(EIR, EIR_TXIF);
+
+    /* Don't care about interrupts for now */
+
+    /* Send the packet */
+    setregbitfield(ECON1, ECON1_TXRTS);
+    while ((readreg(ECON1) & ECON1_TXRTS) > 0)
+        ;
+}
+
 /*---------------------------------------------------------------------------*/
 
 uint16_t ENC28J60::readFrame(uint8_t* buffer, uint16_t bufsize) {
@@ -669,6 +701,28 @@ uint16_t ENC28J60::readFrameData(uint8_t* buffer, uint16_t framesize) {
         readdata(buffer, _len);
     }
 
+    readFrameEnd();
+
+    if (!buffer) {
+        PRINTF("enc28j60: rx err: flushed %d\n", _len);
+        return 0;
+    }
+    PRINTF("enc28j60: rx: %d: %02x:%02x:%02x:%02x:%02x:%02x\n", _len, 0xff & buffer[0],
+           0xff & buffer[1], 0xff & buffer[2], 0xff & buffer[3], 0xff & buffer[4],
+           0xff & buffer[5]);
+
+    // received_packets++;
+    // PRINTF("enc28j60: received_packets %d\n", received_packets);
+
+    return _len;
+}
+
+void ENC28J60::readFrameChunk(uint8_t* buffer, uint16_t len) {
+    // ERDPT auto-increments, so consecutive RBM commands continue where the last one stopped
+    readdata(buffer, len);
+}
+
+void ENC28J60::readFrameEnd() {
     /* Read an additional byte at odd lengths, to avoid FIFO corruption */
     if ((_len % 2) != 0) {
         readdatabyte();
@@ -684,19 +738,6 @@ uint16_t ENC28J60::readFrameData(uint8_t* buffer, uint16_t framesize) {
     writereg(ERXRDPTH, _next >> 8);
 
     setregbitfield(ECON2, ECON2_PKTDEC);
-
-    if (!buffer) {
-        PRINTF("enc28j60: rx err: flushed %d\n", _len);
-        return 0;
-    }
-    PRINTF("enc28j60: rx: %d: %02x:%02x:%02x:%02x:%02x:%02x\n", _len, 0xff & buffer[0],
-           0xff & buffer[1], 0xff & buffer[2], 0xff & buffer[3], 0xff & buffer[4],
-           0xff & buffer[5]);
-
-    // received_packets++;
-    // PRINTF("enc28j60: received_packets %d\n", received_packets);
-
-    return _len;
 }
 
 uint16_t ENC28J60::phyread(uint8_t reg) {
@@ -74,6 +74,13 @@ public:
     */
     virtual uint16_t sendFrame(const uint8_t* data, uint16_t datalen);
 
+    /**
+        Send an Ethernet frame held in a chain of pbufs
+        @param p the first pbuf of the chain, p->tot_len bytes are sent
+        @return the number of bytes transmitted
+    */
+    virtual uint16_t sendFrameChunks(const struct pbuf* p);
+
     /**
         Read an Ethernet frame
         @param buffer a pointer to a buffer to write the packet to
@@ -111,6 +118,14 @@ protected:
         return LOW;
     }
 
+    static constexpr bool chunkedReadIsPossible() {
+        return true;
+    }
+
+    static constexpr bool chunkedWriteIsPossible() {
+        return true;
+    }
+
     /**
         Read an Ethernet frame size
         @return the length of data do receive
@@ -135,6 +150,20 @@ protected:
     */
     uint16_t readFrameData(uint8_t* frame, uint16_t framesize);
 
+    /**
+        Read part of an Ethernet frame's data
+           readFrameSize() must be called first, then readFrameChunk()
+           until the whole frame has been consumed, then readFrameEnd()
+        @param buffer a pointer to a buffer to write the data to
+        @param len number of bytes to copy out of the current frame
+    */
+    void readFrameChunk(uint8_t* buffer, uint16_t len);
+
+    /**
+        Release the frame being read with readFrameChunk()
+    */
+    void readFrameEnd();
+
 private:
     uint8_t is_mac_mii_reg(uint8_t reg);
     uint8_t readreg(uint8_t reg);
@@ -149,6 +178,8 @@ private:
     void    softreset(void);
     uint8_t readrev(void);
     bool    reset(void);
+    void    txbegin(void);
+    void    txstart(uint16_t datalen);
 
     void    enc28j60_arch_spi_init(void);
     uint8_t enc28j60_arch_spi_write(uint8_t data);
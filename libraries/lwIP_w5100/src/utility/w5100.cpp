@@ -277,22 +277,28 @@ uint16_t Wiznet5100::readFrameData(uint8_t* buffer, uint16_t framesize) {
     return framesize;
 }
 
-uint16_t Wiznet5100::sendFrame(const uint8_t* buf, uint16_t len) {
-    ethernet_arch_lwip_gpio_mask(); // So we don't fire an IRQ and interrupt the send w/a receive!
+void Wiznet5100::readFrameChunk(uint8_t* buffer, uint16_t len) {
+    // Only advances the read pointer, the chip sees the space freed at readFrameEnd()
+    wizchip_recv_data(buffer, len);
+}
 
-    // Wait for space in the transmit buffer
+void Wiznet5100::readFrameEnd() {
+    setSn_CR(Sn_CR_RECV);
+}
+
+bool Wiznet5100::wizchip_wait_tx_space(uint16_t len) {
     while (1) {
         uint16_t freesize = getSn_TX_FSR();
         if (getSn_SR() == SOCK_CLOSED) {
-            ethernet_arch_lwip_gpio_unmask();
-            return -1;
+            return false;
         }
         if (len <= freesize) {
-            break;
+            return true;
         }
     };
+}
 
-    wizchip_send_data(buf, len);
+bool Wiznet5100::wizchip_send_and_wait() {
     setSn_CR(Sn_CR_SEND);
 
     while (1) {
@@ -300,15 +306,48 @@ uint16_t Wiznet5100::sendFrame(const uint8_t* buf, uint16_t len) {
         if (tmp & Sn_IR_SENDOK) {
             setSn_IR(Sn_IR_SENDOK);
             // Packet sent ok
-            break;
+            return true;
         } else if (tmp & Sn_IR_TIMEOUT) {
             setSn_IR(Sn_IR_TIMEOUT);
             // There was a timeout
-            ethernet_arch_lwip_gpio_unmask();
-            return -1;
+            return false;
         }
     }
+}
+
+uint16_t Wiznet5100::sendFrame(const uint8_t* buf, uint16_t len) {
+    ethernet_arch_lwip_gpio_mask(); // So we don't fire an IRQ and interrupt the send w/a receive!
+
+    // Wait for space in the transmit buffer
+    if (!wizchip_wait_tx_space(len)) {
+        ethernet_arch_lwip_gpio_unmask();
+        return -1;
+    }
+
+    wizchip_send_data(buf, len);
+    bool ok = wizchip_send_and_wait();
+
+    ethernet_arch_lwip_gpio_unmask();
+    return ok ? len : -1;
+}
+
+uint16_t Wiznet5100::sendFrameChunks(const struct pbuf* p) {
+    uint16_t len = p->tot_len;
+
+    ethernet_arch_lwip_gpio_mask(); // So we don't fire an IRQ and interrupt the send w/a receive!
+
+    if (!wizchip_wait_tx_space(len)) {
+        ethernet_arch_lwip_gpio_unmask();
+        return -1;
+    }
+
+    // Every byte carries its own address on this chip, so there is no burst
+    // mode, but we still only issue one SEND for the whole chain
+    for (const struct pbuf *q = p; q; q = q->next) {
+        wizchip_send_data((const uint8_t*)q->payload, q->len);
+    }
+    bool ok = wizchip_send_and_wait();
 
     ethernet_arch_lwip_gpio_unmask();
-    return len;
+    return ok ? len : -1;
 }
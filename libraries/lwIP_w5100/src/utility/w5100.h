@@ -69,6 +69,13 @@ public:
     */
     uint16_t sendFrame(const uint8_t* data, uint16_t datalen);
 
+    /**
+        Send an Ethernet frame held in a chain of pbufs
+        @param p the first pbuf of the chain, p->tot_len bytes are sent
+        @return the number of bytes transmitted
+    */
+    uint16_t sendFrameChunks(const struct pbuf* p);
+
     /**
         Read an Ethernet frame
         @param buffer a pointer to a buffer to write the packet to
@@ -108,6 +115,14 @@ protected:
         return LOW;
     }
 
+    static constexpr bool chunkedReadIsPossible() {
+        return true;
+    }
+
+    static constexpr bool chunkedWriteIsPossible() {
+        return true;
+    }
+
     /**
         Read an Ethernet frame size
         @return the length of data do receive
@@ -132,6 +147,20 @@ protected:
     */
     uint16_t readFrameData(uint8_t* frame, uint16_t framesize);
 
+    /**
+        Read part of an Ethernet frame's data
+           readFrameSize() must be called first, then readFrameChunk()
+           until the whole frame has been consumed, then readFrameEnd()
+        @param buffer a pointer to a buffer to write the data to
+        @param len number of bytes to copy out of the current frame
+    */
+    void readFrameChunk(uint8_t* buffer, uint16_t len);
+
+    /**
+        Release the frame being read with readFrameChunk()
+    */
+    void readFrameEnd();
+
 private:
     static const uint16_t TxBufferAddress = 0x4000; /* Internal Tx buffer address of the iinchip */
     static const uint16_t RxBufferAddress = 0x6000; /* Internal Rx buffer address of the iinchip */
@@ -234,6 +263,18 @@ private:
     */
     void wizchip_send_data(const uint8_t* wizdata, uint16_t len);
 
+    /**
+        Wait until the socket TX buffer can take len bytes
+        @return false if the socket was closed
+    */
+    bool wizchip_wait_tx_space(uint16_t len);
+
+    /**
+        Issue SEND for the data queued in the TX buffer and wait for it to complete
+        @return false on timeout
+    */
+    bool wizchip_send_and_wait();
+
     /**
         It copies data to your buffer from internal RX memory
 
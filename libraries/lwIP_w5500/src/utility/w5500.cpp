@@ -337,22 +337,28 @@ uint16_t Wiznet5500::readFrameData(uint8_t* buffer, uint16_t framesize) {
     return framesize;
 }
 
-uint16_t Wiznet5500::sendFrame(const uint8_t* buf, uint16_t len) {
-    ethernet_arch_lwip_gpio_mask(); // So we don't fire an IRQ and interrupt the send w/a receive!
+void Wiznet5500::readFrameChunk(uint8_t* buffer, uint16_t len) {
+    // Only advances the read pointer, the chip sees the space freed at readFrameEnd()
+    wizchip_recv_data(buffer, len);
+}
 
-    // Wait for space in the transmit buffer
+void Wiznet5500::readFrameEnd() {
+    setSn_CR(Sn_CR_RECV);
+}
+
+bool Wiznet5500::wizchip_wait_tx_space(uint16_t len) {
     while (1) {
         uint16_t freesize = getSn_TX_FSR();
         if (getSn_SR() == SOCK_CLOSED) {
-            ethernet_arch_lwip_gpio_unmask();
-            return -1;
+            return false;
         }
         if (len <= freesize) {
-            break;
+            return true;
         }
     };
+}
 
-    wizchip_send_data(buf, len);
+bool Wiznet5500::wizchip_send_and_wait() {
     setSn_CR(Sn_CR_SEND);
 
     while (1) {
@@ -360,15 +366,55 @@ uint16_t Wiznet5500::sendFrame(const uint8_t* buf, uint16_t len) {
         if (tmp & Sn_IR_SENDOK) {
             setSn_IR(Sn_IR_SENDOK);
             // Packet sent ok
-            break;
+            return true;
         } else if (tmp & Sn_IR_TIMEOUT) {
             setSn_IR(Sn_IR_TIMEOUT);
             // There was a timeout
-            ethernet_arch_lwip_gpio_unmask();
-            return -1;
+            return false;
         }
     }
+}
+
+uint16_t Wiznet5500::sendFrame(const uint8_t* buf, uint16_t len) {
+    ethernet_arch_lwip_gpio_mask(); // So we don't fire an IRQ and interrupt the send w/a receive!
+
+    // Wait for space in the transmit buffer
+    if (!wizchip_wait_tx_space(len)) {
+        ethernet_arch_lwip_gpio_unmask();
+        return -1;
+    }
+
+    wizchip_send_data(buf, len);
+    bool ok = wizchip_send_and_wait();
+
+    ethernet_arch_lwip_gpio_unmask();
+    return ok ? len : -1;
+}
+
+uint16_t Wiznet5500::sendFrameChunks(const struct pbuf* p) {
+    uint16_t len = p->tot_len;
+
+    ethernet_arch_lwip_gpio_mask(); // So we don't fire an IRQ and interrupt the send w/a receive!
+
+    if (!wizchip_wait_tx_space(len)) {
+        ethernet_arch_lwip_gpio_unmask();
+        return -1;
+    }
+
+    // Stream the whole chain behind a single address header, the chip wraps
+    // the offset within the socket TX buffer for us
+    uint16_t ptr = getSn_TX_WR();
+    wizchip_cs_select();
+    wizchip_spi_write_byte((ptr & 0xFF00) >> 8);
+    wizchip_spi_write_byte((ptr & 0x00FF) >> 0);
+    wizchip_spi_write_byte(BlockSelectTxBuf | AccessModeWrite);
+    for (const struct pbuf *q = p; q; q = q->next) {
+        _spi.transfer(q->payload, nullptr, q->len);
+    }
+    wizchip_cs_deselect();
+    setSn_TX_WR(ptr + len);
+    bool ok = wizchip_send_and_wait();
 
     ethernet_arch_lwip_gpio_unmask();
-    return len;
+    return ok ? len : -1;
 }
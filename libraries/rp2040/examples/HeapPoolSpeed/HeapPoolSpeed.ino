@@ -0,0 +1,94 @@
+// Times small malloc()/free() calls through the size-class pool against the
+// old path of newlib's malloc with IRQs disabled, first on one core and then
+// with the other core allocating at the same time.
+// Released to the public domain by Earle F. Philhower, III
+
+#define LIVE 64        // Blocks kept allocated at once
+#define OPS 20000      // Allocate/free pairs per run
+#define MAXSIZE 128    // Largest request, everything up to here fits the pool
+
+extern "C" void *__real_malloc(size_t size);
+extern "C" void __real_free(void *mem);
+
+// What every malloc() used to do before the pool
+void *oldMalloc(size_t size) {
+  noInterrupts();
+  void *rc = __real_malloc(size);
+  interrupts();
+  return rc;
+}
+
+void oldFree(void *mem) {
+  noInterrupts();
+  __real_free(mem);
+  interrupts();
+}
+
+typedef struct {
+  const char *name;
+  void *(*alloc)(size_t);
+  void (*release)(void *);
+} Allocator;
+
+const Allocator allocators[] = {
+  { "newlib + IRQ off", oldMalloc, oldFree },
+  { "pool", malloc, free },
+};
+
+volatile int core1Mode = -1; // Allocator core 1 is hammering, -1 for none
+
+// Random small blocks replaced one at a time, like a busy app
+uint32_t churn(const Allocator *a, int ops, uint32_t *seed) {
+  void *live[LIVE] = { };
+  uint32_t cycles = 0;
+  for (int i = 0; i < ops; i++) {
+    *seed = *seed * 1103515245 + 12345;
+    int slot = (*seed >> 8) % LIVE;
+    size_t size = 1 + ((*seed >> 16) % MAXSIZE);
+    uint32_t start = rp2040.getCycleCount();
+    a->release(live[slot]);
+    live[slot] = a->alloc(size);
+    cycles += rp2040.getCycleCount() - start;
+  }
+  for (int i = 0; i < LIVE; i++) {
+    a->release(live[i]);
+  }
+  return cycles;
+}
+
+void run(bool dual) {
+  for (int i = 0; i < 2; i++) {
+    core1Mode = dual ? i : -1;
+    delay(10);
+    uint32_t seed = 1;
+    uint32_t cycles = churn(&allocators[i], OPS, &seed);
+    core1Mode = -1;
+    Serial.printf("%-18s %-10s %6.1f cycles per malloc+free\n", allocators[i].name, dual ? "dual core" : "one core", (float)cycles / OPS);
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(5000);
+  run(false);
+  run(true);
+
+  HeapPoolStats s[16];
+  int n = rp2040.getHeapPoolStats(s, 16);
+  Serial.printf("\nPool classes (%lu fallbacks to the main heap):\n", rp2040.getHeapPoolFallbacks());
+  for (int i = 0; i < n; i++) {
+    Serial.printf("%4d bytes: %2d pages, %3ld in use, %3ld peak, %7lu allocs\n", s[i].size, s[i].pages, s[i].inUse, s[i].peak, s[i].allocs);
+  }
+}
+
+void loop() {
+}
+
+// Keeps the other core allocating while core 0 measures
+void loop1() {
+  static uint32_t seed = 2;
+  int mode = core1Mode;
+  if (mode >= 0) {
+    churn(&allocators[mode], 100, &seed);
+  }
+}
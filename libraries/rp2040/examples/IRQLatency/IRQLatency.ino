@@ -0,0 +1,68 @@
+// Measures GPIO interrupt latency, from setting an output pin to the first
+// instruction of the callback, for attachInterrupt() and attachInterruptRaw().
+//
+// Connect a jumper wire between OUTPIN and INPIN.
+//
+// Released to the public domain
+
+#define OUTPIN 2
+#define INPIN 3
+#define LOOPS 1000
+
+volatile uint32_t start;
+volatile uint32_t stop;
+volatile bool fired;
+
+void plainIRQ() {
+  stop = rp2040.getCycleCount();
+  fired = true;
+}
+
+void rawIRQ(pin_size_t pin, uint32_t events, uint32_t us, void *param) {
+  (void) pin;
+  (void) events;
+  (void) us;
+  (void) param;
+  stop = rp2040.getCycleCount();
+  fired = true;
+}
+
+void measure(const char *name) {
+  uint32_t minC = 0xffffffff, maxC = 0;
+  uint64_t sum = 0;
+  for (int i = 0; i < LOOPS; i++) {
+    fired = false;
+    start = rp2040.getCycleCount();
+    digitalWriteFast(OUTPIN, HIGH);
+    while (!fired) {
+      /* wait */
+    }
+    uint32_t c = stop - start;
+    minC = std::min(minC, c);
+    maxC = std::max(maxC, c);
+    sum += c;
+    digitalWriteFast(OUTPIN, LOW);
+    delayMicroseconds(10);
+  }
+  uint32_t mhz = rp2040.f_cpu() / 1000000;
+  Serial.printf("%-20s min %4lu  avg %4lu  max %4lu cycles (%lu MHz)\n", name, minC, (uint32_t)(sum / LOOPS), maxC, mhz);
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(5000);
+  pinMode(OUTPIN, OUTPUT);
+  digitalWrite(OUTPIN, LOW);
+  pinMode(INPIN, INPUT);
+
+  attachInterrupt(INPIN, plainIRQ, RISING);
+  measure("attachInterrupt");
+  detachInterrupt(INPIN);
+
+  attachInterruptRaw(INPIN, rawIRQ, RISING);
+  measure("attachInterruptRaw");
+  detachInterrupt(INPIN);
+}
+
+void loop() {
+}
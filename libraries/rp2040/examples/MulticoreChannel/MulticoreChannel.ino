@@ -0,0 +1,68 @@
+// Measures the throughput and round-trip latency of the zero-copy
+// rp2040.channel message passing between core 0 and core 1, compared
+// with the single-word rp2040.fifo.
+//
+// Core 1 simply echoes every message it receives back to core 0.
+
+// Released to the public domain
+
+#define ROUNDS 10000
+
+static uint8_t msgbuf[256];
+
+void setup() {
+  Serial.begin(115200);
+  delay(5000);
+}
+
+void loop() {
+  // Round trip, one message outstanding at a time
+  uint32_t start = rp2040.getCycleCount();
+  for (int i = 0; i < ROUNDS; i++) {
+    rp2040.channel.send(msgbuf, sizeof(msgbuf));
+    rp2040.channel.receive();
+  }
+  uint32_t cycles = rp2040.getCycleCount() - start;
+  Serial.printf("channel round trip: %lu cycles\n", cycles / ROUNDS);
+
+  start = rp2040.getCycleCount();
+  for (int i = 0; i < ROUNDS; i++) {
+    rp2040.fifo.push(i);
+    rp2040.fifo.pop();
+  }
+  cycles = rp2040.getCycleCount() - start;
+  Serial.printf("fifo round trip:    %lu cycles\n", cycles / ROUNDS);
+
+  // Throughput, keep the ring full and collect the echoes as they come in
+  int sent = 0, rcvd = 0;
+  uint32_t startMS = millis();
+  while (rcvd < ROUNDS) {
+    if ((sent < ROUNDS) && rp2040.channel.send_nb(msgbuf, sizeof(msgbuf))) {
+      sent++;
+    }
+    void *m;
+    if (rp2040.channel.receive_nb(&m)) {
+      rcvd++;
+    }
+  }
+  uint32_t ms = millis() - startMS;
+  Serial.printf("channel throughput: %lu msgs/sec (%lu KB/s of %d byte messages)\n\n", ROUNDS * 1000UL / (ms ? ms : 1),
+                ROUNDS * sizeof(msgbuf) / (ms ? ms : 1), sizeof(msgbuf));
+  delay(1000);
+}
+
+// Echo everything back to core 0 from inside the FIFO IRQ
+void echo(void *msg, size_t len) {
+  rp2040.channel.send(msg, len);
+}
+
+void setup1() {
+  rp2040.channel.onReceive(echo);
+}
+
+void loop1() {
+  // Also echo the plain FIFO for comparison
+  if (rp2040.fifo.available()) {
+    rp2040.fifo.push(rp2040.fifo.pop());
+  }
+}
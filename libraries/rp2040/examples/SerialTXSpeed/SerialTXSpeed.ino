@@ -0,0 +1,52 @@
+// Compares SerialUART transmit with and without the DMA-drained TX FIFO.
+// Released to the public domain by Earle F. Philhower, III
+//
+// Sends the same data at a high baud rate both ways and reports the line
+// throughput and how much of the time the CPU was stuck inside write().
+// With the TX FIFO the CPU only queues data and is free for other work
+// while the DMA sends it.  Nothing needs to be connected to the TX pin.
+
+#define BAUD 3000000
+#define TOTAL (64 * 1024)   // Bytes sent per run
+#define CHUNK 256           // Bytes per write() call
+
+uint8_t buff[CHUNK];
+
+void run(int fifo) {
+  Serial1.end();
+  Serial1.setTXFIFOSize(fifo);
+  Serial1.begin(BAUD);
+
+  uint32_t inWrite = 0;
+  uint32_t spare = 0;
+  uint32_t start = micros();
+  for (size_t sent = 0; sent < TOTAL;) {
+    if (fifo && (Serial1.availableForWrite() < CHUNK)) {
+      spare++; // The app could be doing something useful here
+      continue;
+    }
+    uint32_t t = micros();
+    sent += Serial1.write(buff, CHUNK);
+    inWrite += micros() - t;
+  }
+  Serial1.flush();
+  uint32_t elapsed = micros() - start;
+
+  Serial.printf("TX FIFO %5d: %7.1f KB/s, CPU in write() %5.1f%% of the time, %lu idle loops\n",
+                fifo, TOTAL * 1000.0 / 1024.0 / elapsed * 1000.0, 100.0 * inWrite / elapsed, spare);
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(5000);
+  for (int i = 0; i < CHUNK; i++) {
+    buff[i] = 'A' + (i % 26);
+  }
+  Serial.printf("Sending %d bytes at %d baud\n", TOTAL, BAUD);
+  run(0);
+  run(1024);
+  run(4096);
+}
+
+void loop() {
+}
@@ -0,0 +1,209 @@
+/*
+    Host stress test for AudioBufferRing
+
+    One thread stands in for the DMA IRQ and the other for the user app.
+    Buffers circulate between a "filled" and an "empty" ring exactly as in
+    AudioBufferManager, and each buffer carries a sequence number so that
+    any loss, duplication or reordering is caught.
+
+    Copyright (c) 2024 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <initializer_list>
+#include "AudioBufferRing.h"
+
+static int failures = 0;
+
+#define CHECK(x) do { if (!(x)) { fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #x); failures++; } } while (0)
+
+// Single producer pushing a counter, single consumer popping it back
+typedef struct {
+    AudioBufferRing *ring;
+    size_t cap;
+    uint32_t ops;
+    uint32_t errors;
+} Ctx;
+
+static void *producer(void *p) {
+    Ctx *c = (Ctx *)p;
+    uint32_t n = 0;
+    while (n < c->ops) {
+        if (c->ring->push((uint16_t)n)) {
+            n++;
+        } else {
+            sched_yield();
+        }
+    }
+    return nullptr;
+}
+
+static void *consumer(void *p) {
+    Ctx *c = (Ctx *)p;
+    uint32_t n = 0;
+    while (n < c->ops) {
+        size_t cnt = c->ring->count();
+        if (cnt > c->cap) {
+            c->errors++;
+        }
+        int pk = c->ring->peek();
+        uint16_t v;
+        if (c->ring->pop(&v)) {
+            if ((v != (uint16_t)n) || (pk != (int)(uint16_t)n)) {
+                c->errors++;
+            }
+            n++;
+        } else {
+            sched_yield();
+        }
+    }
+    return nullptr;
+}
+
+static void testSequence(size_t cap, uint32_t ops) {
+    AudioBufferRing r;
+    r.init(cap);
+    Ctx c = { &r, cap, ops, 0 };
+    pthread_t a, b;
+    pthread_create(&a, nullptr, producer, &c);
+    pthread_create(&b, nullptr, consumer, &c);
+    pthread_join(a, nullptr);
+    pthread_join(b, nullptr);
+    CHECK(c.errors == 0);
+    CHECK(r.count() == 0);
+    CHECK(r.peek() == -1);
+    printf("sequence cap=%zu ops=%u errors=%u\n", cap, ops, c.errors);
+}
+
+// Buffers bounce between _empty and _filled like an output AudioBufferManager
+typedef struct {
+    AudioBufferRing filled;
+    AudioBufferRing empty;
+    size_t buffers;
+    uint32_t *seq;       // Sequence number stamped into each buffer
+    uint32_t ops;
+    uint32_t errors;
+} Loop;
+
+static void *irq(void *p) {
+    Loop *l = (Loop *)p;
+    uint32_t expect = 0;
+    while (expect < l->ops) {
+        uint16_t i;
+        if (l->filled.pop(&i)) {
+            if ((i >= l->buffers) || (l->seq[i] != expect)) {
+                l->errors++;
+            }
+            expect++;
+            if (!l->empty.push(i)) {
+                l->errors++; // Can never be full, every index is owned by one side
+            }
+        } else {
+            sched_yield();
+        }
+    }
+    return nullptr;
+}
+
+static void *app(void *p) {
+    Loop *l = (Loop *)p;
+    uint32_t next = 0;
+    while (next < l->ops) {
+        uint16_t i;
+        if (l->empty.pop(&i)) {
+            if (i >= l->buffers) {
+                l->errors++;
+                continue;
+            }
+            l->seq[i] = next++;
+            if (!l->filled.push(i)) {
+                l->errors++;
+            }
+        } else {
+            sched_yield();
+        }
+        if (l->empty.count() + l->filled.count() > l->buffers) {
+            l->errors++;
+        }
+    }
+    return nullptr;
+}
+
+static void testLoop(size_t buffers, uint32_t ops) {
+    Loop l;
+    l.buffers = buffers;
+    l.ops = ops;
+    l.errors = 0;
+    l.seq = new uint32_t[buffers];
+    l.filled.init(buffers);
+    l.empty.init(buffers);
+    for (size_t i = 0; i < buffers; i++) {
+        CHECK(l.empty.push(i));
+    }
+    CHECK(!l.empty.push(0));
+    pthread_t a, b;
+    pthread_create(&a, nullptr, irq, &l);
+    pthread_create(&b, nullptr, app, &l);
+    pthread_join(a, nullptr);
+    pthread_join(b, nullptr);
+    CHECK(l.errors == 0);
+    CHECK(l.filled.count() == 0);
+    CHECK(l.empty.count() == buffers);
+    printf("loop buffers=%zu ops=%u errors=%u\n", buffers, ops, l.errors);
+    delete[] l.seq;
+}
+
+int main(int argc, char **argv) {
+    uint32_t ops = (argc > 1) ? strtoul(argv[1], nullptr, 0) : 1000000;
+
+    // Single-threaded edge cases
+    AudioBufferRing r;
+    r.init(1);
+    CHECK(r.count() == 0);
+    CHECK(r.peek() == -1);
+    CHECK(r.push(7));
+    CHECK(!r.push(8));
+    CHECK(r.count() == 1);
+    CHECK(r.peek() == 7);
+    uint16_t v;
+    CHECK(r.pop(&v) && (v == 7));
+    CHECK(!r.pop(&v));
+    r.init(3); // Re-init must reset state
+    for (int i = 0; i < 10; i++) {
+        CHECK(r.push(i) && r.push(i + 100));
+        CHECK(r.count() == 2);
+        CHECK(r.pop(&v) && (v == i));
+        CHECK(r.pop(&v) && (v == i + 100));
+    }
+
+    for (size_t cap : { 1, 2, 3, 8, 64 }) {
+        testSequence(cap, ops);
+    }
+    for (size_t buffers : { 2, 3, 8 }) {
+        testLoop(buffers, ops);
+    }
+
+    if (failures) {
+        printf("FAILED: %d\n", failures);
+        return 1;
+    }
+    printf("PASSED\n");
+    return 0;
+}
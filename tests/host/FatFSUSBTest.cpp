@@ -0,0 +1,210 @@
+/*
+    Host test and benchmark for the FatFSUSB READ10/WRITE10 sector handling
+
+    Drives read10/write10 the way the TinyUSB MSC class does, in pieces of the
+    USB buffer size, against a RAM disk.  Checks the data and counts how many
+    disk_read/disk_write calls (flash operations on the device) each pattern
+    needs, which is what the sector cache is there to cut down.
+
+    Copyright (c) 2024 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <initializer_list>
+#include <FatFS.h>
+#include "FatFSUSB.h"
+
+static int failures = 0;
+
+#define CHECK(x) do { if (!(x)) { fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #x); failures++; } } while (0)
+
+#define SECTSIZE 512
+#define SECTORS 1024
+
+static uint8_t disk[SECTORS * SECTSIZE];
+static uint8_t model[SECTORS * SECTSIZE]; // What the USB host believes it wrote
+static uint32_t reads, writes, readSects, writeSects;
+
+namespace fatfs {
+DSTATUS disk_initialize(BYTE pdrv) {
+    (void) pdrv;
+    return 0;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count) {
+    (void) pdrv;
+    if ((sector >= SECTORS) || (count > SECTORS - sector)) {
+        return RES_PARERR;
+    }
+    memcpy(buff, disk + sector * SECTSIZE, count * SECTSIZE);
+    reads++;
+    readSects += count;
+    return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count) {
+    (void) pdrv;
+    if ((sector >= SECTORS) || (count > SECTORS - sector)) {
+        return RES_PARERR;
+    }
+    memcpy(disk + sector * SECTSIZE, buff, count * SECTSIZE);
+    writes++;
+    writeSects += count;
+    return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff) {
+    (void) pdrv;
+    if (cmd == GET_SECTOR_SIZE) {
+        *(WORD *)buff = SECTSIZE;
+    } else if (cmd == GET_SECTOR_COUNT) {
+        *(LBA_t *)buff = SECTORS;
+    }
+    return RES_OK;
+}
+};
+
+extern "C" bool tud_msc_set_sense(uint8_t lun, uint8_t sense_key, uint8_t add_sense_code, uint8_t add_sense_qualifier) {
+    (void) lun;
+    (void) sense_key;
+    (void) add_sense_code;
+    (void) add_sense_qualifier;
+    return true;
+}
+
+static void resetCounts() {
+    reads = writes = readSects = writeSects = 0;
+}
+
+// One SCSI command of "sects" sectors split into "chunk" byte callbacks
+static bool xfer(bool write, uint32_t lba, uint32_t sects, uint32_t chunk, uint8_t *buf) {
+    uint32_t total = sects * SECTSIZE;
+    for (uint32_t off = 0; off < total; off += chunk) {
+        uint32_t n = std::min(chunk, total - off);
+        int32_t r = write ? FatFSUSB.write10(lba, off, buf + off, n) : FatFSUSB.read10(lba, off, buf + off, n);
+        if (r != (int32_t)n) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void bench(uint32_t chunk) {
+    const uint32_t cmdSects = 16; // 8KB per command, like a typical host
+    static uint8_t buf[cmdSects * SECTSIZE];
+    double us[2];
+    uint32_t ops[2][2];
+    for (int w = 1; w >= 0; w--) {
+        resetCounts();
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t lba = 0; lba < SECTORS; lba += cmdSects) {
+            if (w) {
+                for (size_t i = 0; i < sizeof(buf); i++) {
+                    buf[i] = rand();
+                }
+                memcpy(model + lba * SECTSIZE, buf, sizeof(buf));
+            }
+            CHECK(xfer(w, lba, cmdSects, chunk, buf));
+            if (!w) {
+                CHECK(!memcmp(buf, model + lba * SECTSIZE, sizeof(buf)));
+            }
+        }
+        FatFSUSB.unplug(); // Flush like an eject does
+        us[w] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        ops[w][0] = reads;
+        ops[w][1] = writes;
+    }
+    CHECK(!memcmp(disk, model, sizeof(disk)));
+    // The cache must keep flash traffic to at most one operation per sector
+    CHECK(ops[1][1] <= SECTORS);
+    CHECK(ops[0][0] <= SECTORS);
+    if (chunk >= SECTSIZE) {
+        CHECK(ops[1][0] == 0); // Whole sectors never need a read-modify-write
+    }
+    printf("chunk %4u: write %4u disk reads %4u disk writes %6.1f MB/s, read %4u disk reads %6.1f MB/s\n",
+           chunk, ops[1][0], ops[1][1], sizeof(disk) / us[1], ops[0][0], sizeof(disk) / us[0]);
+}
+
+// Random unaligned transfers, including ones that start mid-sector
+static void testRandom() {
+    static uint8_t buf[8 * SECTSIZE];
+    srand(7);
+    for (int i = 0; i < 20000; i++) {
+        uint32_t lba = rand() % SECTORS;
+        uint32_t off = rand() % (3 * SECTSIZE);
+        uint32_t len = 1 + rand() % sizeof(buf);
+        uint64_t pos = (uint64_t)lba * SECTSIZE + off;
+        bool write = rand() & 1;
+        if (pos + len > sizeof(disk)) {
+            // Runs off the end, must stop at the last sector
+            int32_t r = write ? FatFSUSB.write10(lba, off, buf, len) : FatFSUSB.read10(lba, off, buf, len);
+            CHECK((r == -1 && pos >= sizeof(disk)) || (r == (int32_t)(sizeof(disk) - pos)));
+            if (write && (r > 0)) {
+                memcpy(model + pos, buf, r);
+            }
+            continue;
+        }
+        if (write) {
+            for (uint32_t j = 0; j < len; j++) {
+                buf[j] = rand();
+            }
+            CHECK(FatFSUSB.write10(lba, off, buf, len) == (int32_t)len);
+            memcpy(model + pos, buf, len);
+        } else {
+            CHECK(FatFSUSB.read10(lba, off, buf, len) == (int32_t)len);
+            if (memcmp(buf, model + pos, len)) {
+                CHECK(!"read mismatch");
+            }
+        }
+        if (!(i % 1000)) {
+            FatFSUSB.unplug();
+            CHECK(!memcmp(disk, model, sizeof(disk)));
+            FatFSUSB.plug();
+        }
+    }
+    FatFSUSB.unplug();
+    CHECK(!memcmp(disk, model, sizeof(disk)));
+}
+
+int main() {
+    for (size_t i = 0; i < sizeof(disk); i++) {
+        disk[i] = model[i] = i * 7;
+    }
+    CHECK(FatFSUSB.read10(0, 0, disk, 4) == -1); // Not started
+    CHECK(FatFSUSB.begin());
+    uint32_t count;
+    uint16_t size;
+    FatFSUSB.capacity(&count, &size);
+    CHECK((count == SECTORS) && (size == SECTSIZE));
+
+    for (uint32_t chunk : { 64, 512, 4096 }) {
+        bench(chunk);
+    }
+    testRandom();
+    FatFSUSB.end();
+
+    if (failures) {
+        printf("FAILED: %d\n", failures);
+        return 1;
+    }
+    printf("PASSED\n");
+    return 0;
+}
@@ -0,0 +1,186 @@
+/*
+    Host test for HeapArena, random alloc/free/realloc against a shadow model
+
+    Copyright (c) 2024 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "HeapArena.h"
+
+static int failures = 0;
+
+#define CHECK(x) do { if (!(x)) { fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #x); failures++; } } while (0)
+
+static const size_t header = 8;
+
+static void testBasics() {
+    static uint8_t mem[1024 + 7];
+    static uint64_t other[4];
+    HeapArena h;
+
+    h.begin(mem, 8);
+    CHECK(!h.alloc(1));
+    CHECK(!h.owns(mem));
+
+    h.begin(mem + 1, 1024); // Unaligned start gets rounded in
+    size_t total = h.totalBytes();
+    CHECK(total <= 1024 && total >= 1016);
+    CHECK(h.freeBytes() == total);
+    CHECK(h.largestFree() == total - header);
+    CHECK(!h.alloc(total));
+    CHECK(!h.alloc((size_t) -1));
+
+    void *p = h.alloc(total - header);
+    CHECK(p && !((uintptr_t)p & 7));
+    CHECK(h.freeBytes() == 0);
+    CHECK(!h.alloc(1));
+    h.free(p);
+    h.free(p); // Double free ignored
+    h.free(nullptr);
+    h.free(&other[2]); // Not ours
+    CHECK(h.freeBytes() == total);
+
+    // Coalescing with both neighbors, in every order
+    for (int order = 0; order < 6; order++) {
+        static const int perm[6][3] = { {0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0} };
+        void *b[4];
+        for (int i = 0; i < 4; i++) {
+            b[i] = h.alloc(100);
+            CHECK(b[i]);
+        }
+        for (int i = 0; i < 3; i++) {
+            h.free(b[perm[order][i]]);
+        }
+        CHECK(h.largestFree() >= 3 * 104);
+        h.free(b[3]);
+        CHECK(h.freeBytes() == total);
+        CHECK(h.largestFree() == total - header);
+    }
+
+    // realloc grows into the free block behind it, and shrinks in place
+    void *a = h.alloc(64);
+    void *b = h.alloc(64);
+    h.free(b);
+    memset(a, 0x5a, 64);
+    void *g = h.realloc(a, 200);
+    CHECK(g == a);
+    CHECK(h.usableSize(g) >= 200);
+    CHECK(((uint8_t *)g)[63] == 0x5a);
+    CHECK(h.realloc(g, 16) == g);
+    CHECK(h.usableSize(g) < 200);
+    CHECK(!h.realloc(g, 0));
+    CHECK(h.freeBytes() == total);
+    CHECK(h.realloc(nullptr, 10) != nullptr);
+}
+
+static void testRandom(uint32_t seed, size_t arena, int ops, size_t maxSize) {
+    const int SLOTS = 64;
+    uint8_t *mem = (uint8_t *)malloc(arena);
+    HeapArena h;
+    h.begin(mem, arena);
+    size_t total = h.totalBytes();
+
+    uint8_t *ptr[SLOTS] = { };
+    size_t len[SLOTS] = { };
+    uint8_t tag[SLOTS] = { };
+    int fails = 0;
+    srand(seed);
+    for (int i = 0; i < ops; i++) {
+        int s = rand() % SLOTS;
+        // Existing contents must be untouched by anything else
+        for (size_t j = 0; j < len[s]; j++) {
+            if (ptr[s][j] != tag[s]) {
+                CHECK(ptr[s][j] == tag[s]);
+                break;
+            }
+        }
+        int op = rand() % 3;
+        size_t size = 1 + rand() % ((rand() & 7) ? maxSize / 16 : maxSize);
+        if (op == 0 && ptr[s]) {
+            h.free(ptr[s]);
+            ptr[s] = nullptr;
+            len[s] = 0;
+        } else if (op == 1 && ptr[s]) {
+            uint8_t *p = (uint8_t *)h.realloc(ptr[s], size);
+            if (p) {
+                // Kept contents up to the smaller size
+                for (size_t j = 0; j < std::min(len[s], size); j++) {
+                    if (p[j] != tag[s]) {
+                        CHECK(p[j] == tag[s]);
+                        break;
+                    }
+                }
+                ptr[s] = p;
+                len[s] = size;
+            } else {
+                fails++;
+            }
+        } else if (!ptr[s]) {
+            ptr[s] = (uint8_t *)h.alloc(size);
+            len[s] = ptr[s] ? size : 0;
+            fails += ptr[s] ? 0 : 1;
+        }
+        if (ptr[s]) {
+            CHECK(h.owns(ptr[s]) && !((uintptr_t)ptr[s] & 7));
+            CHECK(h.usableSize(ptr[s]) >= len[s]);
+            tag[s] = rand();
+            memset(ptr[s], tag[s], len[s]);
+        }
+
+        // Accounting matches the live blocks, and nothing overlaps
+        size_t used = 0;
+        for (int a = 0; a < SLOTS; a++) {
+            if (!ptr[a]) {
+                continue;
+            }
+            used += h.usableSize(ptr[a]) + header;
+            for (int b = a + 1; b < SLOTS; b++) {
+                if (ptr[b]) {
+                    CHECK((ptr[a] + h.usableSize(ptr[a]) + header <= ptr[b]) || (ptr[b] + h.usableSize(ptr[b]) + header <= ptr[a]));
+                }
+            }
+        }
+        CHECK(h.usedBytes() == used);
+        CHECK(h.largestFree() <= h.freeBytes());
+    }
+
+    for (int s = 0; s < SLOTS; s++) {
+        h.free(ptr[s]);
+    }
+    // Everything must have merged back into one block
+    CHECK(h.usedBytes() == 0);
+    CHECK(h.largestFree() == total - header);
+    printf("random arena=%zu max=%zu ops=%d, %d allocation failures\n", arena, maxSize, ops, fails);
+    free(mem);
+}
+
+int main() {
+    testBasics();
+    testRandom(1, 4096, 200000, 512);
+    testRandom(2, 64 * 1024, 200000, 8192);
+    testRandom(3, 1024 * 1024, 100000, 64 * 1024);
+
+    if (failures) {
+        printf("FAILED: %d\n", failures);
+        return 1;
+    }
+    printf("PASSED\n");
+    return 0;
+}
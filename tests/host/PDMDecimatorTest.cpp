@@ -0,0 +1,163 @@
+/*
+    Host test for PDMDecimator, checked bit for bit against OpenPDMFilter
+
+    Interleaved mics are built so that each one carries a different sine.  The
+    reference output comes from running Open_PDM_Filter on each mic's bits
+    pulled back out into their own mono stream.
+
+    Copyright (c) 2024 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <initializer_list>
+#include "utility/PDMDecimator.h"
+#include "rp2040/OpenPDMFilter.h"
+
+static int failures = 0;
+
+#define CHECK(x) do { if (!(x)) { fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #x); failures++; } } while (0)
+
+#define FRAMES 32                           // Output samples per OpenPDMFilter call
+#define BLOCKS 48
+#define BITS (BLOCKS * FRAMES * 128)        // Per mic, enough for decimation 128
+
+static uint8_t mono[PDMDecimator::maxChannels][BITS / 8];
+static uint32_t words[BITS * PDMDecimator::maxChannels / 32];
+static int16_t ref[PDMDecimator::maxChannels][BLOCKS * FRAMES];
+static int16_t out[BLOCKS * FRAMES * PDMDecimator::maxChannels];
+
+// Software sigma-delta of a sine, a different tone and level per mic
+static void makePDM(int mic, uint8_t *dst) {
+    double acc = 0;
+    memset(dst, 0, BITS / 8);
+    for (int i = 0; i < BITS; i++) {
+        double x = (0.03 + 0.2 * mic) * sin(2 * M_PI * i / (3000.0 - 700 * mic) + mic);
+        bool y = acc >= 0;
+        acc += x - (y ? 1 : -1);
+        if (y) {
+            dst[i / 8] |= 0x80 >> (i & 7);
+        }
+    }
+}
+
+// Interleave the mics as pdm.pio pushes them, oldest bit in the MSB
+static void interleave(int mics, int bits) {
+    static const uint8_t quad[4] = { 1, 3, 0, 2 };
+    memset(words, 0, sizeof(words));
+    for (int c = 0; c < mics; c++) {
+        int pos = (mics == 4) ? quad[c] : c;
+        for (int t = 0; t < bits; t++) {
+            if (mono[c][t / 8] & (0x80 >> (t & 7))) {
+                int b = mics * t + pos;
+                words[b / 32] |= 0x80000000 >> (b & 31);
+            }
+        }
+    }
+}
+
+static void reference(int decimation, int channels, int blocks) {
+    for (int c = 0; c < channels; c++) {
+        TPDMFilter_InitStruct f = { };
+        f.Fs = 16000;
+        f.MaxVolume = 1;
+        f.nSamples = FRAMES;
+        f.LP_HZ = 8000;
+        f.HP_HZ = 10;
+        f.In_MicChannels = 1;
+        f.Out_MicChannels = 1;
+        f.Decimation = decimation;
+        f.filterGain = 16;
+        Open_PDM_Filter_Init(&f);
+        for (int b = 0; b < blocks; b++) {
+            uint8_t *in = mono[c] + b * FRAMES * decimation / 8;
+            if (decimation == 128) {
+                Open_PDM_Filter_128(in, ref[c] + b * FRAMES, 1, &f);
+            } else {
+                Open_PDM_Filter_64(in, ref[c] + b * FRAMES, 1, &f);
+            }
+        }
+    }
+}
+
+// chunk is the number of words passed to each process() call, 0 for all at once
+static void compare(int decimation, int mics, int channels, size_t chunk) {
+    int frames = BLOCKS * FRAMES;
+    if (frames * decimation > BITS) {
+        frames = BITS / decimation;
+    }
+    frames -= frames % FRAMES;
+    interleave(mics, frames * decimation);
+    reference(decimation, channels, frames / FRAMES);
+
+    PDMDecimator d;
+    CHECK(d.begin(decimation, mics, channels, 16000, 16));
+    size_t count = d.wordsPerFrames(frames);
+    size_t got = 0;
+    if (!chunk) {
+        got = d.process(words, count, out);
+    } else {
+        for (size_t i = 0; i < count; i += chunk) {
+            size_t n = (count - i < chunk) ? count - i : chunk;
+            got += d.process(words + i, n, out + got * channels);
+        }
+    }
+    CHECK(got == (size_t)frames);
+
+    int bad = 0;
+    int nonzero = 0;
+    for (int i = 0; i < frames; i++) {
+        for (int c = 0; c < channels; c++) {
+            bad += out[i * channels + c] != ref[c][i];
+            nonzero += ref[c][i] != 0;
+        }
+    }
+    CHECK(bad == 0);
+    CHECK(nonzero > frames * channels / 2); // Make sure there was a signal at all
+    printf("decimation %3d, %d of %d mics, chunk %2zu: %d frames, %d mismatches\n", decimation, channels, mics, chunk, frames, bad);
+}
+
+int main() {
+    for (int c = 0; c < PDMDecimator::maxChannels; c++) {
+        makePDM(c, mono[c]);
+    }
+
+    PDMDecimator d;
+    CHECK(!d.begin(4, 1, 1, 16000, 16));
+    CHECK(!d.begin(60, 1, 1, 16000, 16));
+    CHECK(!d.begin(64, 3, 1, 16000, 16));
+    CHECK(!d.begin(64, 2, 3, 16000, 16));
+    CHECK(d.begin(64, 4, 3, 16000, 16));
+
+    for (int dec : { 64, 128 }) {
+        for (size_t chunk : { 0, 1, 7 }) {
+            compare(dec, 1, 1, chunk);
+            compare(dec, 2, 2, chunk);
+            compare(dec, 2, 1, chunk);
+            compare(dec, 4, 4, chunk);
+            compare(dec, 4, 3, chunk);
+        }
+    }
+
+    if (failures) {
+        printf("FAILED: %d\n", failures);
+        return 1;
+    }
+    printf("PASSED\n");
+    return 0;
+}
@@ -0,0 +1,261 @@
+/*
+    Host test for PIOPlanner placement and reference counting
+
+    Copyright (c) 2024 Earle F. Philhower, III <earlephilhower@yahoo.com>
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "PIOPlanner.h"
+
+static int failures = 0;
+
+#define CHECK(x) do { if (!(x)) { fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #x); failures++; } } while (0)
+
+// Distinct addresses to stand in for pio_program_t pointers
+static const char pgmA = 'A', pgmB = 'B', pgmC = 'C';
+
+static uint32_t mask(int length, int offset) {
+    return ((length >= 32) ? 0xffffffff : ((1u << length) - 1)) << offset;
+}
+
+static void testGap() {
+    CHECK(PIOPlanner::largestGap(0) == 32);
+    CHECK(PIOPlanner::largestGap(0xffffffff) == 0);
+    CHECK(PIOPlanner::largestGap(0x0000ff00) == 16);
+    CHECK(PIOPlanner::largestGap(0x80000001) == 30);
+    CHECK(PIOPlanner::largestGap(0xaaaaaaaa) == 1);
+}
+
+static void testArgs() {
+    PIOPlanner p;
+    PIOPlanner::Placement pl;
+    uint32_t used[3] = { 0, 0, 0 };
+    uint8_t sm[3] = { 0xf, 0xf, 0xf };
+    CHECK(!p.plan(&pgmA, 0, -1, 2, used, sm, &pl));
+    CHECK(!p.plan(&pgmA, 33, -1, 2, used, sm, &pl));
+    CHECK(!p.plan(&pgmA, 4, -1, 4, used, sm, &pl));
+    CHECK(p.plan(&pgmA, 32, -1, 2, used, sm, &pl) && (pl.offset == 0) && pl.load);
+    uint8_t none[3] = { 0, 0, 0 };
+    CHECK(!p.plan(&pgmA, 4, -1, 3, used, none, &pl));
+    uint32_t full[3] = { 0xffffffff, 0xfffffff0, 0 };
+    CHECK(!p.plan(&pgmA, 5, -1, 2, full, sm, &pl));
+    CHECK(p.plan(&pgmA, 4, -1, 2, full, sm, &pl) && (pl.pio == 1) && (pl.offset == 0));
+}
+
+static void testBestFit() {
+    PIOPlanner p;
+    PIOPlanner::Placement pl;
+
+    // Empty PIOs load at the top like the SDK, first PIO on a tie
+    uint32_t used[2] = { 0, 0 };
+    uint8_t sm[2] = { 0xf, 0xf };
+    CHECK(p.plan(&pgmA, 10, -1, 2, used, sm, &pl));
+    CHECK((pl.pio == 0) && (pl.offset == 22) && pl.load);
+
+    // Equal gaps go to the PIO with more free SMs
+    uint8_t sm2[2] = { 0x1, 0xf };
+    CHECK(p.plan(&pgmA, 10, -1, 2, used, sm2, &pl) && (pl.pio == 1));
+
+    // Tightest run wins even on a PIO with fewer free SMs
+    uint32_t used3[2] = { 0xffff0000, 0xffffff00 };
+    uint8_t sm3[2] = { 0xf, 0x1 };
+    CHECK(p.plan(&pgmA, 6, -1, 2, used3, sm3, &pl));
+    CHECK((pl.pio == 1) && (pl.offset == 2) && pl.load);
+
+    // Tight hole in the middle of a PIO beats the big one at the top
+    uint32_t used4[1] = { 0x0000f0f0 }; // Holes: 0-3, 8-11, 16-31
+    uint8_t sm4[1] = { 0xf };
+    CHECK(p.plan(&pgmA, 4, -1, 1, used4, sm4, &pl) && (pl.offset == 8));
+    CHECK(p.plan(&pgmA, 5, -1, 1, used4, sm4, &pl) && (pl.offset == 27));
+}
+
+static void testOrigin() {
+    PIOPlanner p;
+    PIOPlanner::Placement pl;
+    uint32_t used[2] = { 0x1, 0 };
+    uint8_t sm[2] = { 0xf, 0x1 };
+    // Offset 0 is taken on PIO 0, so a fixed-origin program must go to PIO 1
+    CHECK(p.plan(&pgmA, 4, 0, 2, used, sm, &pl));
+    CHECK((pl.pio == 1) && (pl.offset == 0) && pl.load);
+    // Origin honored even when a tighter fit exists elsewhere
+    uint32_t used2[1] = { 0x00ffff00 };
+    uint8_t sm2[1] = { 0xf };
+    CHECK(p.plan(&pgmA, 4, 26, 1, used2, sm2, &pl) && (pl.offset == 26));
+    CHECK(!p.plan(&pgmA, 4, 6, 1, used2, sm2, &pl));
+    CHECK(!p.plan(&pgmA, 4, 29, 1, used2, sm2, &pl));
+}
+
+static void testShare() {
+    PIOPlanner p;
+    PIOPlanner::Placement pl;
+    uint32_t used[2] = { mask(5, 20), mask(5, 20) };
+    uint8_t sm[2] = { 0x1, 0x7 };
+
+    CHECK(p.acquire(&pgmA, 0, 20, 5));
+    CHECK(p.find(&pgmA, 0) == 20);
+    CHECK(p.find(&pgmA, 1) == -1);
+    CHECK(p.plan(&pgmA, 5, -1, 2, used, sm, &pl));
+    CHECK((pl.pio == 0) && (pl.offset == 20) && !pl.load);
+
+    // Loaded in both, the one with more free SMs wins
+    CHECK(p.acquire(&pgmA, 1, 20, 5));
+    CHECK(p.plan(&pgmA, 5, -1, 2, used, sm, &pl));
+    CHECK((pl.pio == 1) && (pl.offset == 20) && !pl.load);
+
+    // No free SM where it's loaded means a fresh copy elsewhere
+    uint8_t sm2[3] = { 0, 0, 0xf };
+    uint32_t used2[3] = { mask(5, 20), mask(5, 20), 0 };
+    CHECK(p.plan(&pgmA, 5, -1, 3, used2, sm2, &pl));
+    CHECK((pl.pio == 2) && (pl.offset == 27) && pl.load);
+
+    // A different program is never shared; equal holes, PIO 1 has more SMs
+    CHECK(p.plan(&pgmB, 5, -1, 2, used, sm, &pl) && pl.load);
+    CHECK((pl.pio == 1) && (pl.offset == 27));
+}
+
+static void testRefcount() {
+    PIOPlanner p;
+    int off = -1;
+    CHECK(!p.release(&pgmA, 0, &off));
+    CHECK(p.acquire(&pgmA, 0, 12, 4));
+    CHECK(p.acquire(&pgmA, 0, 12, 4));
+    CHECK(p.acquire(&pgmA, 0, 12, 4));
+    CHECK(p.acquire(&pgmB, 0, 0, 4));
+    CHECK(p.users(&pgmA, 0) == 3);
+    CHECK(p.users(&pgmA, 1) == 0);
+    CHECK(!p.release(&pgmA, 0, &off) && (off == 12));
+    CHECK(!p.release(&pgmA, 0, &off));
+    CHECK(p.users(&pgmA, 0) == 1);
+    off = -1;
+    CHECK(p.release(&pgmA, 0, &off) && (off == 12));
+    CHECK(p.users(&pgmA, 0) == 0);
+    CHECK(p.find(&pgmA, 0) == -1);
+    CHECK(!p.release(&pgmA, 0, &off));
+    // Unrelated entries untouched
+    CHECK(p.find(&pgmB, 0) == 0);
+    CHECK(p.users(&pgmB, 0) == 1);
+
+    // Table capacity, and slots are reused after release
+    PIOPlanner q;
+    static char pgms[PIOPlanner::maxLoaded + 1];
+    for (int i = 0; i < PIOPlanner::maxLoaded; i++) {
+        CHECK(q.acquire(&pgms[i], i % 3, i % 32, 1));
+    }
+    CHECK(!q.acquire(&pgms[PIOPlanner::maxLoaded], 0, 0, 1));
+    CHECK(q.acquire(&pgms[5], 5 % 3, 5, 1)); // Existing entries still count up
+    CHECK(!q.release(&pgms[5], 5 % 3, &off));
+    CHECK(q.release(&pgms[5], 5 % 3, &off) && (off == 5));
+    CHECK(q.acquire(&pgms[PIOPlanner::maxLoaded], 0, 7, 1));
+    CHECK(q.find(&pgms[PIOPlanner::maxLoaded], 0) == 7);
+    CHECK(q.find(&pgms[5], 5 % 3) == -1);
+}
+
+// Random load/unload sequence mirrored against a simple model of the PIOs.
+// Placements must never overlap and must always succeed when a fit exists.
+static void testRandom() {
+    const int pios = 3;
+    const void *progs[] = { &pgmA, &pgmB, &pgmC, "D", "E", "F" };
+    const int lens[] = { 3, 7, 12, 1, 5, 9 };
+    const int nprogs = sizeof(lens) / sizeof(lens[0]);
+    typedef struct {
+        int prog;
+        int pio;
+        int sm;
+    } User;
+    User live[pios * PIOPlanner::stateMachines];
+    int nlive = 0;
+
+    PIOPlanner p;
+    uint32_t used[pios] = { };
+    uint8_t sm[pios] = { 0xf, 0xf, 0xf };
+    srand(1);
+    for (int iter = 0; iter < 200000; iter++) {
+        if (nlive && ((rand() & 1) || (nlive == pios * PIOPlanner::stateMachines))) {
+            int k = rand() % nlive;
+            User u = live[k];
+            live[k] = live[--nlive];
+            int off;
+            bool last = p.release(progs[u.prog], u.pio, &off);
+            int remain = 0;
+            for (int i = 0; i < nlive; i++) {
+                remain += (live[i].prog == u.prog) && (live[i].pio == u.pio);
+            }
+            CHECK(last == (remain == 0));
+            if (last) {
+                CHECK((used[u.pio] & mask(lens[u.prog], off)) == mask(lens[u.prog], off));
+                used[u.pio] &= ~mask(lens[u.prog], off);
+            }
+            sm[u.pio] |= 1 << u.sm;
+            continue;
+        }
+        int pr = rand() % nprogs;
+        int origin = (rand() % 8) ? -1 : (rand() % (32 - lens[pr] + 1));
+        PIOPlanner::Placement pl;
+        bool ok = p.plan(progs[pr], lens[pr], origin, pios, used, sm, &pl);
+
+        // Brute-force whether anything would have worked
+        bool possible = false;
+        for (int q = 0; q < pios; q++) {
+            if (!sm[q]) {
+                continue;
+            }
+            if (p.find(progs[pr], q) >= 0) {
+                possible = true;
+            }
+            for (int o = 0; o <= 32 - lens[pr]; o++) {
+                if (((origin < 0) || (o == origin)) && !(used[q] & mask(lens[pr], o))) {
+                    possible = true;
+                }
+            }
+        }
+        CHECK(ok == possible);
+        if (!ok) {
+            continue;
+        }
+        CHECK((pl.pio >= 0) && (pl.pio < pios) && sm[pl.pio]);
+        if (pl.load) {
+            CHECK(p.find(progs[pr], pl.pio) < 0);
+            CHECK(!(used[pl.pio] & mask(lens[pr], pl.offset)));
+            CHECK((origin < 0) || (pl.offset == origin));
+            used[pl.pio] |= mask(lens[pr], pl.offset);
+        } else {
+            CHECK(p.find(progs[pr], pl.pio) == pl.offset);
+        }
+        CHECK(p.acquire(progs[pr], pl.pio, pl.offset, lens[pr]));
+        int s = __builtin_ctz(sm[pl.pio]);
+        sm[pl.pio] &= ~(1 << s);
+        live[nlive++] = { pr, pl.pio, s };
+    }
+}
+
+int main() {
+    testGap();
+    testArgs();
+    testBestFit();
+    testOrigin();
+    testShare();
+    testRefcount();
+    testRandom();
+
+    if (failures) {
+        printf("FAILED: %d\n", failures);
+        return 1;
+    }
+    printf("PASSED\n");
+    return 0;
+}
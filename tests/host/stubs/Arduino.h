@@ -0,0 +1,6 @@
+// Minimal stand-in for host builds of hardware-independent library code
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
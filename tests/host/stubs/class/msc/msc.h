@@ -0,0 +1,18 @@
+// The one TinyUSB MSC type FatFSUSB uses, for host builds
+#pragma once
+#include <stdint.h>
+
+typedef struct __attribute__((packed)) {
+    uint8_t cmd_code;
+    uint8_t immded : 1;
+    uint8_t : 7;
+    uint8_t TU_RESERVED;
+    uint8_t power_condition_mod : 4;
+    uint8_t : 4;
+    uint8_t start : 1;
+    uint8_t load_eject : 1;
+    uint8_t no_flush : 1;
+    uint8_t : 1;
+    uint8_t power_condition : 4;
+    uint8_t control;
+} scsi_start_stop_unit_t;
@@ -0,0 +1,27 @@
+// Just enough of the SDK DMA API for DMARing, backed by a simulated channel
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+    volatile uint32_t transfer_count;
+} dma_channel_hw_t;
+
+extern dma_channel_hw_t sim_dma;
+extern bool sim_dma_busy;
+
+static inline dma_channel_hw_t *dma_channel_hw_addr(unsigned channel) {
+    (void) channel;
+    return &sim_dma;
+}
+
+static inline bool dma_channel_is_busy(unsigned channel) {
+    (void) channel;
+    return sim_dma_busy;
+}
+
+static inline void dma_channel_set_trans_count(unsigned channel, uint32_t count, bool trigger) {
+    (void) channel;
+    sim_dma.transfer_count = count;
+    sim_dma_busy = trigger;
+}